@@ -19,20 +19,13 @@ public:
     virtual void Do(ActionContext *context, double value) override
     {
         if (MediaTrack *track = context->GetTrack())
-            TrackFX_SetParam(track, context->GetSlotIndex(), context->GetParamIndex(), value);
+            context->GetCSI()->SetFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), value);
     }
     
     virtual void Touch(ActionContext *context, double value) override
     {
         if (MediaTrack *track = context->GetTrack())
-        {
-            double min, max = 0;
-            
-            if (value == 0)
-                TrackFX_EndParamEdit(track, context->GetSlotIndex(), context->GetParamIndex());
-            else
-                TrackFX_SetParam(track, context->GetSlotIndex(), context->GetParamIndex(), TrackFX_GetParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max));
-        }
+            context->GetCSI()->TouchFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), value != 0);
     }
 };
 
@@ -49,7 +42,7 @@ public:
         {
             double min, max = 0.0;
             
-            double value =  TrackFX_GetParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max);
+            double value =  context->GetCSI()->GetFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max);
             
             double range = max - min;
             
@@ -81,7 +74,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             if (context->GetNumberOfSteppedValues() > 0)
-                TrackFX_SetParam(track, context->GetSlotIndex(), context->GetParamIndex(), value);
+                context->GetCSI()->SetFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), value);
 
             else
             {
@@ -91,7 +84,7 @@ public:
                 
                 double range = max - min;
                 
-                TrackFX_SetParam(track, context->GetSlotIndex(), context->GetParamIndex(), value  *range + min);
+                context->GetCSI()->SetFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), value  *range + min);
             }
         }
     }
@@ -99,14 +92,7 @@ public:
     virtual void Touch(ActionContext *context, double value) override
     {
         if (MediaTrack *track = context->GetTrack())
-        {
-            double min, max = 0;
-            
-            if (value == 0)
-                TrackFX_EndParamEdit(track, context->GetSlotIndex(), context->GetParamIndex());
-            else
-                TrackFX_SetParam(track, context->GetSlotIndex(), context->GetParamIndex(), TrackFX_GetParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max));
-        }
+            context->GetCSI()->TouchFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), value != 0);
     }
 };
 
@@ -132,7 +118,7 @@ public:
                 {
                     double min, max = 0.0;
                     
-                    return TrackFX_GetParam(track, fxIndex, paramIndex, &min, &max);
+                    return context->GetCSI()->GetFXParam(track, fxIndex, paramIndex, &min, &max);
                 }
                 else
                     return 0.0;
@@ -156,7 +142,7 @@ public:
                 int paramIndex = 0;
                 
                 if (GetTCPFXParm(NULL, track, index, &fxIndex, &paramIndex))
-                    TrackFX_SetParam(track, fxIndex, paramIndex, value);
+                    context->GetCSI()->SetFXParam(track, fxIndex, paramIndex, value);
             }
         }
     }
@@ -194,7 +180,7 @@ public:
         
         if (GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
             if (MediaTrack *track = DAW::GetTrack(trackNum))
-                return TrackFX_GetParam(track, fxSlotNum, fxParamNum, &min, &max);
+                return context->GetCSI()->GetFXParam(track, fxSlotNum, fxParamNum, &min, &max);
         
         return 0.0;
     }
@@ -209,7 +195,7 @@ public:
 
         if (GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
             if (MediaTrack *track = DAW::GetTrack(trackNum))
-                context->UpdateWidgetValue(TrackFX_GetParam(track, fxSlotNum, fxParamNum, &min, &max));
+                context->UpdateWidgetValue(context->GetCSI()->GetFXParam(track, fxSlotNum, fxParamNum, &min, &max));
     }
     
     virtual void Do(ActionContext *context, double value) override
@@ -220,7 +206,7 @@ public:
 
         if (GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
             if (MediaTrack *track = DAW::GetTrack(trackNum))
-                TrackFX_SetParam(track, fxSlotNum, fxParamNum, value);
+                context->GetCSI()->SetFXParam(track, fxSlotNum, fxParamNum, value);
     }
     
     virtual void Touch(ActionContext *context, double value) override
@@ -233,10 +219,10 @@ public:
         {
             if (MediaTrack *track =  DAW::GetTrack(trackNum))
             {
-                if (value == 0)
-                    TrackFX_EndParamEdit(track, fxSlotNum, fxParamNum);
-                else
-                    TrackFX_SetParam(track, fxSlotNum, fxParamNum, GetCurrentNormalizedValue(context));
+                if (value != 0)
+                    context->GetCSI()->SetFXParam(track, fxSlotNum, fxParamNum, GetCurrentNormalizedValue(context));
+                
+                context->GetCSI()->TouchFXParam(track, fxSlotNum, fxParamNum, value != 0);
             }
         }
     }
@@ -467,6 +453,7 @@ class TrackVolumeDB : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackVolumeDB"; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) override { rangeMinimum = -144.0; rangeMaximum = 24.0; }
     
     virtual double GetCurrentDBValue(ActionContext *context) override
     {
@@ -558,6 +545,7 @@ class TrackPanPercent : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackPanPercent"; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) override { rangeMinimum = -100.0; rangeMaximum = 100.0; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -644,6 +632,7 @@ class TrackPanWidthPercent : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackPanWidthPercent"; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) override { rangeMinimum = -100.0; rangeMaximum = 100.0; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -724,6 +713,7 @@ class TrackPanLPercent : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackPanLPercent"; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) override { rangeMinimum = -100.0; rangeMaximum = 100.0; }
     
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -812,6 +802,7 @@ class TrackPanRPercent : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackPanRPercent"; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) override { rangeMinimum = -100.0; rangeMaximum = 100.0; }
     
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -1359,6 +1350,7 @@ class TrackSendVolumeDB : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackSendVolumeDB"; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) override { rangeMinimum = -144.0; rangeMaximum = 24.0; }
     
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -2194,6 +2186,7 @@ class FXParamNameDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "FXParamNameDisplay"; }
+    virtual ActionParamLayout GetParamLayout() override { return ActionParamLayout_FXParamNameDisplay; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -2232,8 +2225,12 @@ public:
                 int paramIndex = 0;
                 
                 char tmp[MEDBUF];
+                tmp[0] = 0;
                 if (GetTCPFXParm(NULL, track, index, &fxIndex, &paramIndex))
-                    context->UpdateWidgetValue(context->GetCSI()->GetTCPFXParamName(track, fxIndex, paramIndex, tmp, sizeof(tmp)));
+                {
+                    TrackFX_GetParamName(track, fxIndex, paramIndex, tmp, sizeof(tmp));
+                    context->UpdateWidgetValue(tmp);
+                }
                 else
                     context->ClearWidget();
             }
@@ -2256,9 +2253,7 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {
-            char fxParamValue[128];
-            TrackFX_GetFormattedParamValue(track, context->GetSlotIndex(), context->GetParamIndex(), fxParamValue, sizeof(fxParamValue));
-            context->UpdateWidgetValue(fxParamValue);
+            context->UpdateWidgetValue(context->GetCSI()->GetFormattedFXParamValue(track, context->GetSlotIndex(), context->GetParamIndex()));
         }
         else
             context->ClearWidget();
@@ -2285,9 +2280,7 @@ public:
                 
                 if (GetTCPFXParm(NULL, track, index, &fxIndex, &paramIndex))
                 {
-                    char fxParamValue[128];
-                    TrackFX_GetFormattedParamValue(track, fxIndex, paramIndex, fxParamValue, sizeof(fxParamValue));
-                    context->UpdateWidgetValue(fxParamValue);
+                    context->UpdateWidgetValue(context->GetCSI()->GetFormattedFXParamValue(track, fxIndex, paramIndex));
                 }
                 else
                     context->ClearWidget();
@@ -2344,9 +2337,7 @@ public:
         {
             if (MediaTrack *track = DAW::GetTrack(trackNum))
             {
-                char fxParamValue[128];
-                TrackFX_GetFormattedParamValue(track, fxSlotNum, fxParamNum, fxParamValue, sizeof(fxParamValue));
-                context->UpdateWidgetValue(fxParamValue);
+                context->UpdateWidgetValue(context->GetCSI()->GetFormattedFXParamValue(track, fxSlotNum, fxParamNum));
             }
         }
         else
@@ -2652,6 +2643,7 @@ class FixedTextDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "FixedTextDisplay"; }
+    virtual ActionParamLayout GetParamLayout() override { return ActionParamLayout_FixedTextDisplay; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -3560,8 +3552,14 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {           
-            if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+            const TrackMeter &meter = context->GetCSI()->GetTrackMeter(track);
+            
+            if (meter.isSoloGated)
                 context->ClearWidget();
+            else if (context->GetIntParam() == 0)
+                context->UpdateWidgetValue(volToNormalized(meter.peakL));
+            else if (context->GetIntParam() == 1)
+                context->UpdateWidgetValue(volToNormalized(meter.peakR));
             else
                 context->UpdateWidgetValue(volToNormalized(Track_GetPeakInfo(track, context->GetIntParam())));
         }
@@ -3581,9 +3579,11 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {
-            double lrVol = (Track_GetPeakInfo(track, 0) + Track_GetPeakInfo(track, 1)) / 2.0;
+            const TrackMeter &meter = context->GetCSI()->GetTrackMeter(track);
             
-            if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+            double lrVol = (meter.peakL + meter.peakR) / 2.0;
+            
+            if (meter.isSoloGated)
                 context->ClearWidget();
             else
                 context->UpdateWidgetValue(volToNormalized(lrVol));
@@ -3627,9 +3627,11 @@ public:
         {
             if (MediaTrack *track = context->GetTrack())
             {
-                double lrVol = (Track_GetPeakInfo(track, 0) + Track_GetPeakInfo(track, 1)) / 2.0;
+                const TrackMeter &meter = context->GetCSI()->GetTrackMeter(track);
+                
+                double lrVol = (meter.peakL + meter.peakR) / 2.0;
                 
-                if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+                if (meter.isSoloGated)
                     context->ClearWidget();
                 else
                     context->UpdateWidgetValue(volToNormalized(lrVol));
@@ -3664,12 +3666,11 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {
-            double lVol = Track_GetPeakInfo(track, 0);
-            double rVol = Track_GetPeakInfo(track, 1);
+            const TrackMeter &meter = context->GetCSI()->GetTrackMeter(track);
             
-            double lrVol =  lVol > rVol ? lVol : rVol;
+            double lrVol =  meter.peakL > meter.peakR ? meter.peakL : meter.peakR;
             
-            if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+            if (meter.isSoloGated)
                 context->ClearWidget();
             else
                 context->UpdateWidgetValue(volToNormalized(lrVol));
@@ -3713,12 +3714,11 @@ public:
         {
             if (MediaTrack *track = context->GetTrack())
             {
-                double lVol = Track_GetPeakInfo(track, 0);
-                double rVol = Track_GetPeakInfo(track, 1);
+                const TrackMeter &meter = context->GetCSI()->GetTrackMeter(track);
                 
-                double lrVol =  lVol > rVol ? lVol : rVol;
+                double lrVol =  meter.peakL > meter.peakR ? meter.peakL : meter.peakR;
                 
-                if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+                if (meter.isSoloGated)
                     context->ClearWidget();
                 else
                     context->UpdateWidgetValue(volToNormalized(lrVol));
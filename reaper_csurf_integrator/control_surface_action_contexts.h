@@ -27,10 +27,11 @@ class ReaperAction : public Action
 {
 public:
     virtual const char *GetName() override { return "ReaperAction"; }
+    virtual ActionParamLayout GetParamLayout() override { return ActionParamLayout_CommandId; }
    
     virtual void RequestUpdate(ActionContext *context) override
     {
-        int state = GetToggleCommandState(context->GetCommandId());
+        int state = context->GetCSI()->GetToggleState(context->GetCommandId());
         
         if (state == -1) // this Action does not report state
             state = 0;
@@ -65,7 +66,7 @@ public:
         {
             double min, max = 0.0;
             
-            return TrackFX_GetParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max);
+            return context->GetCSI()->GetFXParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max);
         }
         else
             return 0.0;
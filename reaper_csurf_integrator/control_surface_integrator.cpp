@@ -14,6 +14,11 @@
 #include "../WDL/dirscan.h"
 #include "resource.h"
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 extern WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 extern reaper_plugin_info_t *g_reaper_plugin_info;
@@ -26,6 +31,9 @@ bool g_surfaceRawInDisplay;
 bool g_surfaceInDisplay;
 bool g_surfaceOutDisplay;
 bool g_fxParamsWrite;
+bool g_timingDisplay;
+bool g_fxParamsThinWhileTouched;
+bool g_recordSurfaceTraffic;
 
 void GetPropertiesFromTokens(int start, int finish, const string_list &tokens, PropertyList &properties)
 {
@@ -572,6 +580,368 @@ static void listFilesOfType(const string &path, string_list &results, const char
     }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Midi widget types
+//////////////////////////////////////////////////////////////////////////////
+struct MidiWidgetLine
+{
+    CSurfIntegrator *csi;
+    Midi_ControlSurface *surface;
+    Widget *widget;
+    const string_list *tokens;
+    int size;
+    bool isRotaryWidgetClass;
+    MIDI_event_ex_t *message1;
+    MIDI_event_ex_t *message2;
+    int oneByteKey;
+    int twoByteKey;
+    int threeByteKey;
+    int threeByteKeyMsg2;
+    
+    int IntToken(int index) const { return atoi((*tokens)[index]); }
+};
+
+typedef void (*MidiWidgetFactory)(const MidiWidgetLine &line, const int *args);
+
+struct MidiWidgetType
+{
+    const char *name;
+    int numTokens; // the line must have exactly this many tokens, 0 if the factory checks for itself
+    MidiWidgetFactory factory;
+    int args[5];
+};
+
+// Control Signal Generators
+static void AnyPress_Factory(const MidiWidgetLine &l, const int *args)
+{
+    if ((l.size == 4 || l.size == 7) && l.message1)
+        l.surface->AddCSIMessageGenerator(l.twoByteKey, new AnyPress_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1));
+}
+
+static void Press_Factory(const MidiWidgetLine &l, const int *args)
+{
+    if (l.size == 4 && l.message1)
+        l.surface->AddCSIMessageGenerator(l.threeByteKey, new PressRelease_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1));
+    else if (l.size == 7 && l.message1 && l.message2)
+    {
+        l.surface->AddCSIMessageGenerator(l.threeByteKey, new PressRelease_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1, l.message2));
+        l.surface->AddCSIMessageGenerator(l.threeByteKeyMsg2, new PressRelease_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1, l.message2));
+    }
+}
+
+static void Fader14Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.surface->AddCSIMessageGenerator(l.oneByteKey, new Fader14Bit_Midi_CSIMessageGenerator(l.csi, l.widget));
+}
+
+static void FaderportClassicFader14Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.surface->AddCSIMessageGenerator(l.oneByteKey, new FaderportClassicFader14Bit_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1, l.message2));
+}
+
+static void Fader7Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.surface->AddCSIMessageGenerator(l.twoByteKey, new Fader7Bit_Midi_CSIMessageGenerator(l.csi, l.widget));
+}
+
+static void Encoder_Factory(const MidiWidgetLine &l, const int *args)
+{
+    if (l.isRotaryWidgetClass)
+        l.surface->AddCSIMessageGenerator(l.twoByteKey, new AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator(l.csi, l.widget));
+    else if (l.size == 4)
+        l.surface->AddCSIMessageGenerator(l.twoByteKey, new Encoder_Midi_CSIMessageGenerator(l.csi, l.widget));
+}
+
+static void MFTEncoder_Factory(const MidiWidgetLine &l, const int *args)
+{
+    if (l.size > 4)
+        l.surface->AddCSIMessageGenerator(l.twoByteKey, new MFT_AcceleratedEncoder_Midi_CSIMessageGenerator(l.csi, l.widget, *l.tokens));
+}
+
+static void EncoderPlain_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.surface->AddCSIMessageGenerator(l.twoByteKey, new EncoderPlain_Midi_CSIMessageGenerator(l.csi, l.widget));
+}
+
+static void Encoder7Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.surface->AddCSIMessageGenerator(l.twoByteKey, new Encoder7Bit_Midi_CSIMessageGenerator(l.csi, l.widget));
+}
+
+static void Touch_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.surface->AddCSIMessageGenerator(l.threeByteKey, new Touch_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1, l.message2));
+    l.surface->AddCSIMessageGenerator(l.threeByteKeyMsg2, new Touch_Midi_CSIMessageGenerator(l.csi, l.widget, l.message1, l.message2));
+}
+
+// Feedback Processors
+static void FB_TwoState_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new TwoState_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1, l.message2));
+}
+
+static void FB_NovationLaunchpadMiniRGB7Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_MFT_RGB_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new MFT_RGB_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_AsparionRGB_Factory(const MidiWidgetLine &l, const int *args)
+{
+    FeedbackProcessor *feedbackProcessor = new AsparionRGB_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1);
+    l.surface->AddTrackColorFeedbackProcessor(feedbackProcessor);
+    l.widget->AddFeedbackProcessor(feedbackProcessor);
+}
+
+static void FB_FaderportRGB_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FaderportRGB_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_FaderportTwoStateRGB_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FPTwoStateRGB_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_FaderportValueBar_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FPValueBar_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.IntToken(1)));
+}
+
+static void FB_FPVUMeter_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FPVUMeter_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.IntToken(1)));
+}
+
+static void FB_Fader14Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new Fader14Bit_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_FaderportClassicFader14Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FaderportClassicFader14Bit_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1, l.message2));
+}
+
+static void FB_Fader7Bit_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new Fader7Bit_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_Encoder_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new Encoder_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_AsparionEncoder_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new AsparionEncoder_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_ConsoleOneVUMeter_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new ConsoleOneVUMeter_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_ConsoleOneGainReductionMeter_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new ConsoleOneGainReductionMeter_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_MCUTimeDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new MCU_TimeDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget));
+}
+
+static void FB_MCUAssignmentDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FB_MCU_AssignmentDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget));
+}
+
+static void FB_QConProXMasterVUMeter_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new QConProXMasterVUMeter_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.IntToken(1)));
+}
+
+// args: displayType
+static void FB_MCUVUMeter_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new MCUVUMeter_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], l.IntToken(1)));
+    l.surface->SetHasMCUMeters(args[0]);
+}
+
+// args: isRight
+static void FB_AsparionVUMeter_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new AsparionVUMeter_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, 0x14, l.IntToken(1), args[0] != 0));
+    l.surface->SetHasMCUMeters(0x14);
+}
+
+static void FB_SCE24LEDButton_Factory(const MidiWidgetLine &l, const int *args)
+{
+    const string_list &tokens = *l.tokens;
+    l.widget->AddFeedbackProcessor(new SCE24TwoStateLED_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, new MIDI_event_ex_t(strToHex(tokens[1]), strToHex(tokens[2]) + 0x60, strToHex(tokens[3]))));
+}
+
+static void FB_SCE24OLEDButton_Factory(const MidiWidgetLine &l, const int *args)
+{
+    const string_list &tokens = *l.tokens;
+    l.widget->AddFeedbackProcessor(new SCE24OLED_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, new MIDI_event_ex_t(strToHex(tokens[1]), strToHex(tokens[2]) + 0x60, strToHex(tokens[3])), l.IntToken(4), l.IntToken(5), l.IntToken(6)));
+}
+
+static void FB_SCE24Encoder_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new SCE24Encoder_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1));
+}
+
+static void FB_SCE24EncoderText_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new SCE24Text_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, l.message1, l.IntToken(4), l.IntToken(5), l.IntToken(6)));
+}
+
+// args: displayUpperLower, displayType, displayRow
+static void FB_MCUDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new MCUDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], args[1], args[2], l.IntToken(1)));
+}
+
+// args: displayUpperLower, displayType, displayRow, sysExByte1, sysExByte2
+static void FB_IconDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new IconDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], args[1], args[2], l.IntToken(1), args[3], args[4]));
+}
+
+// args: displayUpperLower, displayType, displayRow
+static void FB_AsparionDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new AsparionDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], args[1], args[2], l.IntToken(1)));
+}
+
+// args: displayUpperLower, displayType, displayRow
+static void FB_XTouchDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    FeedbackProcessor *feedbackProcessor = new XTouchDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], args[1], args[2], l.IntToken(1));
+    l.surface->AddTrackColorFeedbackProcessor(feedbackProcessor);
+    l.widget->AddFeedbackProcessor(feedbackProcessor);
+}
+
+// args: displayUpperLower
+static void FB_C4Display_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new MCUDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], 0x17, l.IntToken(1) + 0x30, l.IntToken(2)));
+}
+
+// args: displayType, displayRow
+static void FB_FPScribbleLine_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FPDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], l.IntToken(1), args[1]));
+}
+
+// args: displayType
+static void FB_FPScribbleStripMode_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new FPScribbleStripMode_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], l.IntToken(1)));
+}
+
+// args: displayUpperLower
+static void FB_QConLiteDisplay_Factory(const MidiWidgetLine &l, const int *args)
+{
+    l.widget->AddFeedbackProcessor(new QConLiteDisplay_Midi_FeedbackProcessor(l.csi, l.surface, l.widget, args[0], 0x14, 0x12, l.IntToken(1)));
+}
+
+static const MidiWidgetType s_midiWidgetTypes[] =
+{
+    // Control Signal Generators
+    { "AnyPress",                           0, AnyPress_Factory },
+    { "Press",                              0, Press_Factory },
+    { "Fader14Bit",                         4, Fader14Bit_Factory },
+    { "FaderportClassicFader14Bit",         7, FaderportClassicFader14Bit_Factory },
+    { "Fader7Bit",                          4, Fader7Bit_Factory },
+    { "Encoder",                            0, Encoder_Factory },
+    { "MFTEncoder",                         0, MFTEncoder_Factory },
+    { "EncoderPlain",                       4, EncoderPlain_Factory },
+    { "Encoder7Bit",                        4, Encoder7Bit_Factory },
+    { "Touch",                              7, Touch_Factory },
+
+    // Feedback Processors
+    { "FB_TwoState",                        7, FB_TwoState_Factory },
+    { "FB_NovationLaunchpadMiniRGB7Bit",    4, FB_NovationLaunchpadMiniRGB7Bit_Factory },
+    { "FB_MFT_RGB",                         4, FB_MFT_RGB_Factory },
+    { "FB_AsparionRGB",                     4, FB_AsparionRGB_Factory },
+    { "FB_FaderportRGB",                    4, FB_FaderportRGB_Factory },
+    { "FB_FaderportTwoStateRGB",            4, FB_FaderportTwoStateRGB_Factory },
+    { "FB_FaderportValueBar",               2, FB_FaderportValueBar_Factory },
+    { "FB_FPVUMeter",                       2, FB_FPVUMeter_Factory },
+    { "FB_Fader14Bit",                      4, FB_Fader14Bit_Factory },
+    { "FB_FaderportClassicFader14Bit",      7, FB_FaderportClassicFader14Bit_Factory },
+    { "FB_Fader7Bit",                       4, FB_Fader7Bit_Factory },
+    { "FB_Encoder",                         4, FB_Encoder_Factory },
+    { "FB_AsparionEncoder",                 4, FB_AsparionEncoder_Factory },
+    { "FB_ConsoleOneVUMeter",               4, FB_ConsoleOneVUMeter_Factory },
+    { "FB_ConsoleOneGainReductionMeter",    4, FB_ConsoleOneGainReductionMeter_Factory },
+    { "FB_MCUTimeDisplay",                  1, FB_MCUTimeDisplay_Factory },
+    { "FB_MCUAssignmentDisplay",            1, FB_MCUAssignmentDisplay_Factory },
+    { "FB_QConProXMasterVUMeter",           2, FB_QConProXMasterVUMeter_Factory },
+    { "FB_MCUVUMeter",                      2, FB_MCUVUMeter_Factory,               { 0x14 } },
+    { "FB_MCUXTVUMeter",                    2, FB_MCUVUMeter_Factory,               { 0x15 } },
+    { "FB_AsparionVUMeterL",                2, FB_AsparionVUMeter_Factory,          { 0 } },
+    { "FB_AsparionVUMeterR",                2, FB_AsparionVUMeter_Factory,          { 1 } },
+    { "FB_SCE24LEDButton",                  4, FB_SCE24LEDButton_Factory },
+    { "FB_SCE24OLEDButton",                 7, FB_SCE24OLEDButton_Factory },
+    { "FB_SCE24Encoder",                    4, FB_SCE24Encoder_Factory },
+    { "FB_SCE24EncoderText",                7, FB_SCE24EncoderText_Factory },
+    { "FB_MCUDisplayUpper",                 2, FB_MCUDisplay_Factory,               { 0, 0x14, 0x12 } },
+    { "FB_MCUDisplayLower",                 2, FB_MCUDisplay_Factory,               { 1, 0x14, 0x12 } },
+    { "FB_MCUXTDisplayUpper",               2, FB_MCUDisplay_Factory,               { 0, 0x15, 0x12 } },
+    { "FB_MCUXTDisplayLower",               2, FB_MCUDisplay_Factory,               { 1, 0x15, 0x12 } },
+    { "FB_IconDisplay1Upper",               2, FB_IconDisplay_Factory,              { 0, 0x14, 0x12, 0x00, 0x66 } },
+    { "FB_IconDisplay1Lower",               2, FB_IconDisplay_Factory,              { 1, 0x14, 0x12, 0x00, 0x66 } },
+    { "FB_IconDisplay2Upper",               2, FB_IconDisplay_Factory,              { 0, 0x15, 0x13, 0x02, 0x4e } },
+    { "FB_IconDisplay2Lower",               2, FB_IconDisplay_Factory,              { 1, 0x15, 0x13, 0x02, 0x4e } },
+    { "FB_AsparionDisplayUpper",            2, FB_AsparionDisplay_Factory,          { 0x01, 0x14, 0x1A } },
+    { "FB_AsparionDisplayLower",            2, FB_AsparionDisplay_Factory,          { 0x02, 0x14, 0x1A } },
+    { "FB_AsparionDisplayEncoder",          2, FB_AsparionDisplay_Factory,          { 0x03, 0x14, 0x19 } },
+    { "FB_XTouchDisplayUpper",              2, FB_XTouchDisplay_Factory,            { 0, 0x14, 0x12 } },
+    { "FB_XTouchDisplayLower",              2, FB_XTouchDisplay_Factory,            { 1, 0x14, 0x12 } },
+    { "FB_XTouchXTDisplayUpper",            2, FB_XTouchDisplay_Factory,            { 0, 0x15, 0x12 } },
+    { "FB_XTouchXTDisplayLower",            2, FB_XTouchDisplay_Factory,            { 1, 0x15, 0x12 } },
+    { "FB_C4DisplayUpper",                  3, FB_C4Display_Factory,                { 0 } },
+    { "FB_C4DisplayLower",                  3, FB_C4Display_Factory,                { 1 } },
+    { "FB_FP8ScribbleLine1",                2, FB_FPScribbleLine_Factory,           { 0x02, 0x00 } },
+    { "FB_FP8ScribbleLine2",                2, FB_FPScribbleLine_Factory,           { 0x02, 0x01 } },
+    { "FB_FP8ScribbleLine3",                2, FB_FPScribbleLine_Factory,           { 0x02, 0x02 } },
+    { "FB_FP8ScribbleLine4",                2, FB_FPScribbleLine_Factory,           { 0x02, 0x03 } },
+    { "FB_FP16ScribbleLine1",               2, FB_FPScribbleLine_Factory,           { 0x16, 0x00 } },
+    { "FB_FP16ScribbleLine2",               2, FB_FPScribbleLine_Factory,           { 0x16, 0x01 } },
+    { "FB_FP16ScribbleLine3",               2, FB_FPScribbleLine_Factory,           { 0x16, 0x02 } },
+    { "FB_FP16ScribbleLine4",               2, FB_FPScribbleLine_Factory,           { 0x16, 0x03 } },
+    { "FB_FP8ScribbleStripMode",            2, FB_FPScribbleStripMode_Factory,      { 0x02 } },
+    { "FB_FP16ScribbleStripMode",           2, FB_FPScribbleStripMode_Factory,      { 0x16 } },
+    { "FB_QConLiteDisplayUpper",            2, FB_QConLiteDisplay_Factory,          { 0 } },
+    { "FB_QConLiteDisplayUpperMid",         2, FB_QConLiteDisplay_Factory,          { 1 } },
+    { "FB_QConLiteDisplayLowerMid",         2, FB_QConLiteDisplay_Factory,          { 2 } },
+    { "FB_QConLiteDisplayLower",            2, FB_QConLiteDisplay_Factory,          { 3 } },
+};
+
+static const MidiWidgetType *GetMidiWidgetType(const char *name)
+{
+    static WDL_StringKeyedArray<const MidiWidgetType*> s_midiWidgetTypesByName;
+    
+    if (s_midiWidgetTypesByName.GetSize() == 0)
+    {
+        for (int i = 0; i < NUM_ELEM(s_midiWidgetTypes); ++i)
+            s_midiWidgetTypesByName.AddUnsorted(s_midiWidgetTypes[i].name, &s_midiWidgetTypes[i]);
+        
+        s_midiWidgetTypesByName.Resort();
+    }
+    
+    return s_midiWidgetTypesByName.Get(name);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Midi_ControlSurface
 //////////////////////////////////////////////////////////////////////////////
@@ -646,246 +1016,117 @@ void Midi_ControlSurface::ProcessMidiWidget(int &lineNumber, fpistream &surfaceT
             if (message2)
                 threeByteKeyMsg2 = message2->midi_message[0] * 0x10000 + message2->midi_message[1] * 0x100 + message2->midi_message[2];
         }
-        // Control Signal Generators
         
-        if (widgetType == "AnyPress" && (size == 4 || size == 7) && message1)
-            AddCSIMessageGenerator(twoByteKey, new AnyPress_Midi_CSIMessageGenerator(csi_, widget, message1));
-        else if (widgetType == "Press" && size == 4 && message1)
-            AddCSIMessageGenerator(threeByteKey, new PressRelease_Midi_CSIMessageGenerator(csi_, widget, message1));
-        else if (widgetType == "Press" && size == 7 && message1 && message2)
-        {
-            AddCSIMessageGenerator(threeByteKey, new PressRelease_Midi_CSIMessageGenerator(csi_, widget, message1, message2));
-            AddCSIMessageGenerator(threeByteKeyMsg2, new PressRelease_Midi_CSIMessageGenerator(csi_, widget, message1, message2));
-        }
-        else if (widgetType == "Fader14Bit" && size == 4)
-            AddCSIMessageGenerator(oneByteKey, new Fader14Bit_Midi_CSIMessageGenerator(csi_, widget));
-        else if (widgetType == "FaderportClassicFader14Bit" && size == 7 && message1 && message2)
-            AddCSIMessageGenerator(oneByteKey, new FaderportClassicFader14Bit_Midi_CSIMessageGenerator(csi_, widget, message1, message2));
-        else if (widgetType == "Fader7Bit" && size== 4)
-            AddCSIMessageGenerator(twoByteKey, new Fader7Bit_Midi_CSIMessageGenerator(csi_, widget));
-        else if (widgetType == "Encoder" && widgetClass == "RotaryWidgetClass")
-            AddCSIMessageGenerator(twoByteKey, new AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator(csi_, widget));
-        else if (widgetType == "Encoder" && size == 4)
-            AddCSIMessageGenerator(twoByteKey, new Encoder_Midi_CSIMessageGenerator(csi_, widget));
-        else if (widgetType == "MFTEncoder" && size > 4)
-            AddCSIMessageGenerator(twoByteKey, new MFT_AcceleratedEncoder_Midi_CSIMessageGenerator(csi_, widget, tokenLines[i]));
-        else if (widgetType == "EncoderPlain" && size == 4)
-            AddCSIMessageGenerator(twoByteKey, new EncoderPlain_Midi_CSIMessageGenerator(csi_, widget));
-        else if (widgetType == "Encoder7Bit" && size == 4)
-            AddCSIMessageGenerator(twoByteKey, new Encoder7Bit_Midi_CSIMessageGenerator(csi_, widget));
-        else if (widgetType == "Touch" && size == 7 && message1  && message2)
-        {
-            AddCSIMessageGenerator(threeByteKey, new Touch_Midi_CSIMessageGenerator(csi_, widget, message1, message2));
-            AddCSIMessageGenerator(threeByteKeyMsg2, new Touch_Midi_CSIMessageGenerator(csi_, widget, message1, message2));
-        }
+        const MidiWidgetType *type = GetMidiWidgetType(widgetType);
         
-        // Feedback Processors
-        FeedbackProcessor *feedbackProcessor = NULL;
-
-        if (widgetType == "FB_TwoState" && size == 7 && message1 && message2)
-        {
-            feedbackProcessor = new TwoState_Midi_FeedbackProcessor(csi_, this, widget, message1, message2);
-        }
-        else if (widgetType == "FB_NovationLaunchpadMiniRGB7Bit" && size == 4 && message1)
-        {
-            feedbackProcessor = new NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_MFT_RGB" && size == 4 && message1)
-        {
-            feedbackProcessor = new MFT_RGB_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_AsparionRGB" && size == 4 && message1)
-        {
-            feedbackProcessor = new AsparionRGB_Midi_FeedbackProcessor(csi_, this, widget, message1);
-            
-            if (feedbackProcessor)
-                AddTrackColorFeedbackProcessor(feedbackProcessor);
-        }
-        else if (widgetType == "FB_FaderportRGB" && size == 4 && message1)
-        {
-            feedbackProcessor = new FaderportRGB_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_FaderportTwoStateRGB" && size == 4 && message1)
-        {
-            feedbackProcessor = new FPTwoStateRGB_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_FaderportValueBar"  && size == 2)
-        {
-            feedbackProcessor = new FPValueBar_Midi_FeedbackProcessor(csi_, this, widget, atoi(tokenLines[i][1].c_str()));
-        }
-        else if ((widgetType == "FB_FPVUMeter") && size == 2)
-        {
-            feedbackProcessor = new FPVUMeter_Midi_FeedbackProcessor(csi_, this, widget, atoi(tokenLines[i][1].c_str()));
-        }
-        else if (widgetType == "FB_Fader14Bit" && size == 4 && message1)
-        {
-            feedbackProcessor = new Fader14Bit_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_FaderportClassicFader14Bit" && size == 7 && message1 && message2)
-        {
-            feedbackProcessor = new FaderportClassicFader14Bit_Midi_FeedbackProcessor(csi_, this, widget, message1, message2);
-        }
-        else if (widgetType == "FB_Fader7Bit" && size == 4 && message1)
-        {
-            feedbackProcessor = new Fader7Bit_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_Encoder" && size == 4 && message1)
-        {
-            feedbackProcessor = new Encoder_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_AsparionEncoder" && size == 4 && message1)
-        {
-            feedbackProcessor = new AsparionEncoder_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_ConsoleOneVUMeter" && size == 4 && message1)
-        {
-            feedbackProcessor = new ConsoleOneVUMeter_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_ConsoleOneGainReductionMeter" && size == 4 && message1)
-        {
-            feedbackProcessor = new ConsoleOneGainReductionMeter_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_MCUTimeDisplay" && size == 1)
-        {
-            feedbackProcessor = new MCU_TimeDisplay_Midi_FeedbackProcessor(csi_, this, widget);
-        }
-        else if (widgetType == "FB_MCUAssignmentDisplay" && size == 1)
+        if (type != NULL && (type->numTokens == 0 || type->numTokens == size))
         {
-            feedbackProcessor = new FB_MCU_AssignmentDisplay_Midi_FeedbackProcessor(csi_, this, widget);
-        }
-        else if (widgetType == "FB_QConProXMasterVUMeter" && size == 2)
-        {
-            feedbackProcessor = new QConProXMasterVUMeter_Midi_FeedbackProcessor(csi_, this, widget, atoi(tokenLines[i][1].c_str()));
-        }
-        else if ((widgetType == "FB_MCUVUMeter" || widgetType == "FB_MCUXTVUMeter") && size == 2)
-        {
-            int displayType = widgetType == "FB_MCUVUMeter" ? 0x14 : 0x15;
-            
-            feedbackProcessor = new MCUVUMeter_Midi_FeedbackProcessor(csi_, this, widget, displayType, atoi(tokenLines[i][1].c_str()));
-            
-            SetHasMCUMeters(displayType);
-        }
-        else if ((widgetType == "FB_AsparionVUMeterL" || widgetType == "FB_AsparionVUMeterR") && size == 2)
-        {
-            bool isRight = widgetType == "FB_AsparionVUMeterR" ? true : false;
-            
-            feedbackProcessor = new AsparionVUMeter_Midi_FeedbackProcessor(csi_, this, widget, 0x14, atoi(tokenLines[i][1].c_str()), isRight);
+            MidiWidgetLine line = { csi_, this, widget, &tokenLines[i], size, widgetClass == "RotaryWidgetClass", message1, message2, oneByteKey, twoByteKey, threeByteKey, threeByteKeyMsg2 };
             
-            SetHasMCUMeters(0x14);
-        }
-        else if (widgetType == "FB_SCE24LEDButton" && size == 4)
-        {
-            feedbackProcessor = new SCE24TwoStateLED_Midi_FeedbackProcessor(csi_, this, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]) + 0x60, strToHex(tokenLines[i][3])));
-        }
-        else if (widgetType == "FB_SCE24OLEDButton" && size == 7)
-        {
-            feedbackProcessor = new SCE24OLED_Midi_FeedbackProcessor(csi_, this, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]) + 0x60, strToHex(tokenLines[i][3])), atoi(tokenLines[i][4]), atoi(tokenLines[i][5]), atoi(tokenLines[i][6]));
-        }
-        else if (widgetType == "FB_SCE24Encoder" && size == 4 && message1)
-        {
-            feedbackProcessor = new SCE24Encoder_Midi_FeedbackProcessor(csi_, this, widget, message1);
-        }
-        else if (widgetType == "FB_SCE24EncoderText" && size == 7 && message1)
-        {
-            feedbackProcessor = new SCE24Text_Midi_FeedbackProcessor(csi_, this, widget, message1, atoi(tokenLines[i][4]), atoi(tokenLines[i][5]), atoi(tokenLines[i][6]));
-        }
-        else if ((widgetType == "FB_MCUDisplayUpper" || widgetType == "FB_MCUDisplayLower" || widgetType == "FB_MCUXTDisplayUpper" || widgetType == "FB_MCUXTDisplayLower") && size == 2)
-        {
-            if (widgetType == "FB_MCUDisplayUpper")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_MCUDisplayLower")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_MCUXTDisplayUpper")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x15, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_MCUXTDisplayLower")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x15, 0x12, atoi(tokenLines[i][1].c_str()));
-        }
-        else if ((widgetType == "FB_IconDisplay1Upper" || widgetType == "FB_IconDisplay1Lower" || widgetType == "FB_IconDisplay2Upper" || widgetType == "FB_IconDisplay2Lower") && size == 2)
-        {
-            if (widgetType == "FB_IconDisplay1Upper")
-                feedbackProcessor = new IconDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x14, 0x12, atoi(tokenLines[i][1].c_str()), 0x00, 0x66);
-            else if (widgetType == "FB_IconDisplay1Lower")
-                feedbackProcessor = new IconDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x14, 0x12, atoi(tokenLines[i][1].c_str()), 0x00, 0x66);
-            else if (widgetType == "FB_IconDisplay2Upper")
-                feedbackProcessor = new IconDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x15, 0x13, atoi(tokenLines[i][1].c_str()), 0x02, 0x4e);
-            else if (widgetType == "FB_IconDisplay2Lower")
-                feedbackProcessor = new IconDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x15, 0x13, atoi(tokenLines[i][1].c_str()), 0x02, 0x4e);
-        }
-        else if ((widgetType == "FB_AsparionDisplayUpper" || widgetType == "FB_AsparionDisplayLower" || widgetType == "FB_AsparionDisplayEncoder") && size == 2)
-        {
-            if (widgetType == "FB_AsparionDisplayUpper")
-                feedbackProcessor = new AsparionDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x01, 0x14, 0x1A, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_AsparionDisplayLower")
-                feedbackProcessor = new AsparionDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x02, 0x14, 0x1A, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_AsparionDisplayEncoder")
-                feedbackProcessor = new AsparionDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x03, 0x14, 0x19, atoi(tokenLines[i][1].c_str()));
-        }
-        else if ((widgetType == "FB_XTouchDisplayUpper" || widgetType == "FB_XTouchDisplayLower" || widgetType == "FB_XTouchXTDisplayUpper" || widgetType == "FB_XTouchXTDisplayLower") && size == 2)
-        {
-            if (widgetType == "FB_XTouchDisplayUpper")
-                feedbackProcessor = new XTouchDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_XTouchDisplayLower")
-                feedbackProcessor = new XTouchDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_XTouchXTDisplayUpper")
-                feedbackProcessor = new XTouchDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x15, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_XTouchXTDisplayLower")
-                feedbackProcessor = new XTouchDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x15, 0x12, atoi(tokenLines[i][1].c_str()));
-            
-            if (feedbackProcessor)
-                AddTrackColorFeedbackProcessor(feedbackProcessor);
-        }
-        else if ((widgetType == "FB_C4DisplayUpper" || widgetType == "FB_C4DisplayLower") && size == 3)
-        {
-            if (widgetType == "FB_C4DisplayUpper")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x17, atoi(tokenLines[i][1].c_str()) + 0x30, atoi(tokenLines[i][2].c_str()));
-            else if (widgetType == "FB_C4DisplayLower")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x17, atoi(tokenLines[i][1].c_str()) + 0x30, atoi(tokenLines[i][2].c_str()));
-        }
-        else if ((widgetType == "FB_FP8ScribbleLine1" || widgetType == "FB_FP16ScribbleLine1"
-                 || widgetType == "FB_FP8ScribbleLine2" || widgetType == "FB_FP16ScribbleLine2"
-                 || widgetType == "FB_FP8ScribbleLine3" || widgetType == "FB_FP16ScribbleLine3"
-                 || widgetType == "FB_FP8ScribbleLine4" || widgetType == "FB_FP16ScribbleLine4") && size == 2)
-        {
-            if (widgetType == "FB_FP8ScribbleLine1")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x02, atoi(tokenLines[i][1].c_str()), 0x00);
-            else if (widgetType == "FB_FP8ScribbleLine2")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x02, atoi(tokenLines[i][1].c_str()), 0x01);
-            else if (widgetType == "FB_FP8ScribbleLine3")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x02, atoi(tokenLines[i][1].c_str()), 0x02);
-            else if (widgetType == "FB_FP8ScribbleLine4")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x02, atoi(tokenLines[i][1].c_str()), 0x03);
-
-            else if (widgetType == "FB_FP16ScribbleLine1")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x16, atoi(tokenLines[i][1].c_str()), 0x00);
-            else if (widgetType == "FB_FP16ScribbleLine2")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x16, atoi(tokenLines[i][1].c_str()), 0x01);
-            else if (widgetType == "FB_FP16ScribbleLine3")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x16, atoi(tokenLines[i][1].c_str()), 0x02);
-            else if (widgetType == "FB_FP16ScribbleLine4")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0x16, atoi(tokenLines[i][1].c_str()), 0x03);
-        }
-        else if ((widgetType == "FB_FP8ScribbleStripMode" || widgetType == "FB_FP16ScribbleStripMode") && size == 2)
-        {
-            if (widgetType == "FB_FP8ScribbleStripMode")
-                feedbackProcessor = new FPScribbleStripMode_Midi_FeedbackProcessor(csi_, this, widget, 0x02, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_FP16ScribbleStripMode")
-                feedbackProcessor = new FPScribbleStripMode_Midi_FeedbackProcessor(csi_, this, widget, 0x16, atoi(tokenLines[i][1].c_str()));
-        }
-        else if ((widgetType == "FB_QConLiteDisplayUpper" || widgetType == "FB_QConLiteDisplayUpperMid" || widgetType == "FB_QConLiteDisplayLowerMid" || widgetType == "FB_QConLiteDisplayLower") && size == 2)
-        {
-            if (widgetType == "FB_QConLiteDisplayUpper")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(csi_, this, widget, 0, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_QConLiteDisplayUpperMid")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(csi_, this, widget, 1, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_QConLiteDisplayLowerMid")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(csi_, this, widget, 2, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
-            else if (widgetType == "FB_QConLiteDisplayLower")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(csi_, this, widget, 3, 0x14, 0x12, atoi(tokenLines[i][1].c_str()));
+            type->factory(line, type->args);
         }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// OSC widget types
+//////////////////////////////////////////////////////////////////////////////
+typedef void (*OSCWidgetFactory)(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress);
+
+struct OSCWidgetType
+{
+    const char *name;
+    OSCWidgetFactory factory;
+};
 
-        if (feedbackProcessor != NULL)
-            widget->AddFeedbackProcessor(feedbackProcessor);
+// Control Signal Generators
+static void Control_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    surface->AddCSIMessageGenerator(oscAddress, new CSIMessageGenerator(csi, widget));
+}
+
+static void OSC_AnyPress_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    surface->AddCSIMessageGenerator(oscAddress, new AnyPress_CSIMessageGenerator(csi, widget));
+}
+
+static void OSC_Touch_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    surface->AddCSIMessageGenerator(oscAddress, new Touch_CSIMessageGenerator(csi, widget));
+}
+
+static void X32Fader_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    surface->AddCSIMessageGenerator(oscAddress, new X32_Fader_OSC_MessageGenerator(csi, widget));
+}
+
+static void X32RotaryToEncoder_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    surface->AddCSIMessageGenerator(oscAddress, new X32_RotaryToEncoder_OSC_MessageGenerator(csi, widget));
+}
+
+// Feedback Processors
+static void FB_Processor_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    widget->AddFeedbackProcessor(new OSC_FeedbackProcessor(csi, surface, widget, oscAddress));
+}
+
+static void FB_IntProcessor_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    widget->AddFeedbackProcessor(new OSC_IntFeedbackProcessor(csi, surface, widget, oscAddress));
+}
+
+static void FB_X32Processor_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    widget->AddFeedbackProcessor(new OSC_X32FeedbackProcessor(csi, surface, widget, oscAddress));
+}
+
+static void FB_X32IntProcessor_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    widget->AddFeedbackProcessor(new OSC_X32IntFeedbackProcessor(csi, surface, widget, oscAddress));
+}
+
+static void FB_X32FaderProcessor_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    widget->AddFeedbackProcessor(new OSC_X32FaderFeedbackProcessor(csi, surface, widget, oscAddress));
+}
+
+static void FB_X32RotaryToEncoder_Factory(CSurfIntegrator *csi, OSC_ControlSurface *surface, Widget *widget, const char *oscAddress)
+{
+    widget->AddFeedbackProcessor(new OSC_X32_RotaryToEncoderFeedbackProcessor(csi, surface, widget, oscAddress));
+}
+
+static const OSCWidgetType s_oscWidgetTypes[] =
+{
+    // Control Signal Generators
+    { "Control",                    Control_Factory },
+    { "AnyPress",                   OSC_AnyPress_Factory },
+    { "Touch",                      OSC_Touch_Factory },
+    { "X32Fader",                   X32Fader_Factory },
+    { "X32RotaryToEncoder",         X32RotaryToEncoder_Factory },
+
+    // Feedback Processors
+    { "FB_Processor",               FB_Processor_Factory },
+    { "FB_IntProcessor",            FB_IntProcessor_Factory },
+    { "FB_X32Processor",            FB_X32Processor_Factory },
+    { "FB_X32IntProcessor",         FB_X32IntProcessor_Factory },
+    { "FB_X32FaderProcessor",       FB_X32FaderProcessor_Factory },
+    { "FB_X32RotaryToEncoder",      FB_X32RotaryToEncoder_Factory },
+};
+
+static const OSCWidgetType *GetOSCWidgetType(const char *name)
+{
+    static WDL_StringKeyedArray<const OSCWidgetType*> s_oscWidgetTypesByName;
+    
+    if (s_oscWidgetTypesByName.GetSize() == 0)
+    {
+        for (int i = 0; i < NUM_ELEM(s_oscWidgetTypes); ++i)
+            s_oscWidgetTypesByName.AddUnsorted(s_oscWidgetTypes[i].name, &s_oscWidgetTypes[i]);
+        
+        s_oscWidgetTypesByName.Resort();
     }
+    
+    return s_oscWidgetTypesByName.Get(name);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -920,28 +1161,13 @@ void OSC_ControlSurface::ProcessOSCWidget(int &lineNumber, fpistream &surfaceTem
 
     for (int i = 0; i < (int)tokenLines.size(); ++i)
     {
-        if (tokenLines[i].size() > 1 && tokenLines[i][0] == "Control")
-            AddCSIMessageGenerator(tokenLines[i][1], new CSIMessageGenerator(csi_, widget));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "AnyPress")
-            AddCSIMessageGenerator(tokenLines[i][1], new AnyPress_CSIMessageGenerator(csi_, widget));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "Touch")
-            AddCSIMessageGenerator(tokenLines[i][1], new Touch_CSIMessageGenerator(csi_, widget));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "X32Fader")
-            AddCSIMessageGenerator(tokenLines[i][1], new X32_Fader_OSC_MessageGenerator(csi_, widget));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "X32RotaryToEncoder")
-            AddCSIMessageGenerator(tokenLines[i][1], new X32_RotaryToEncoder_OSC_MessageGenerator(csi_, widget));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_Processor")
-            widget->AddFeedbackProcessor(new OSC_FeedbackProcessor(csi_, this, widget, tokenLines[i][1]));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_IntProcessor")
-            widget->AddFeedbackProcessor(new OSC_IntFeedbackProcessor(csi_, this, widget, tokenLines[i][1]));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_X32Processor")
-            widget->AddFeedbackProcessor(new OSC_X32FeedbackProcessor(csi_, this, widget, tokenLines[i][1]));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_X32IntProcessor")
-            widget->AddFeedbackProcessor(new OSC_X32IntFeedbackProcessor(csi_, this, widget, tokenLines[i][1]));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_X32FaderProcessor")
-            widget->AddFeedbackProcessor(new OSC_X32FaderFeedbackProcessor(csi_, this, widget, tokenLines[i][1]));
-        else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_X32RotaryToEncoder")
-            widget->AddFeedbackProcessor(new OSC_X32_RotaryToEncoderFeedbackProcessor(csi_, this, widget, tokenLines[i][1]));
+        if (tokenLines[i].size() < 2)
+            continue;
+        
+        const OSCWidgetType *type = GetOSCWidgetType(tokenLines[i][0]);
+        
+        if (type != NULL)
+            type->factory(csi_, this, widget, tokenLines[i][1]);
     }
 }
 
@@ -1284,8 +1510,19 @@ void CSurfIntegrator::InitActionsDictionary()
 
 void CSurfIntegrator::Init()
 {
+    const double initStartTime = time_precise();
+    
+    for (int i = 0; i < InitPhase_Count; ++i)
+        initPhaseTimes_[i] = 0.0;
+    
     pages_.Empty(true);
     
+    // the surfaces are gone with their pages, and CSI.ini is about to declare the IO again
+    midiSurfacesIO_.Empty(true);
+    oscSurfacesIO_.Empty(true);
+    
+    zoneDefinitions_.DeleteAll(); // a reset always rereads the Zone folders
+    
     string currentBroadcaster;
     
     Page *currentPage = NULL;
@@ -1386,7 +1623,9 @@ void CSurfIntegrator::Init()
                                     int surfaceRefreshRate = atoi(pList.get_prop(PropertyType_MIDISurfaceRefreshRate));
                                     int maxMIDIMesssagesPerRun = atoi(pList.get_prop(PropertyType_MaxMIDIMesssagesPerRun));
                                     
+                                    const double startTime = time_precise();
                                     midiSurfacesIO_.Add(new Midi_ControlSurfaceIO(this, nameProp, channelCount, GetMidiInputForPort(midiIn), GetMidiOutputForPort(midiOut), surfaceRefreshRate, maxMIDIMesssagesPerRun));
+                                    AddInitPhaseTime(InitPhase_Ports, startTime);
                                 }
                             }
                             else if (( ! strcmp(typeProp, s_OSCSurfaceToken) || ! strcmp(typeProp, s_OSCX32SurfaceToken)) && tokens.size() == 7)
@@ -1401,10 +1640,14 @@ void CSurfIntegrator::Init()
                                     const char *transmitToIPAddress = pList.get_prop(PropertyType_TransmitToIPAddress);
                                     int maxPacketsPerRun = atoi(pList.get_prop(PropertyType_MaxPacketsPerRun));
                                     
+                                    const double startTime = time_precise();
+                                    
                                     if ( ! strcmp(typeProp, s_OSCSurfaceToken))
                                         oscSurfacesIO_.Add(new OSC_ControlSurfaceIO(this, nameProp, channelCount, receiveOnPort, transmitToPort, transmitToIPAddress, maxPacketsPerRun));
                                     else if ( ! strcmp(typeProp, s_OSCX32SurfaceToken))
                                         oscSurfacesIO_.Add(new OSC_X32ControlSurfaceIO(this, nameProp, channelCount, receiveOnPort, transmitToPort, transmitToIPAddress, maxPacketsPerRun));
+                                    
+                                    AddInitPhaseTime(InitPhase_Ports, startTime);
                                 }
                             }
                         }
@@ -1534,24 +1777,580 @@ void CSurfIntegrator::Init()
             lineNumber++;
         }
     }
-    catch (exception)
+    catch (exception)
+    {
+        char buffer[250];
+        snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", iniFilePath.c_str(), lineNumber);
+        ShowConsoleMsg(buffer);
+    }
+    
+    if (pages_.GetSize() == 0)
+        pages_.Add(new Page(this, "Home", false, false, false, false));
+    
+    for (int i = 0; i < pages_.GetSize(); ++i)
+    {
+        for (int j = 0; j < pages_.Get(i)->GetSurfaces().GetSize(); ++j)
+            pages_.Get(i)->GetSurfaces().Get(j)->ForceClear();
+
+        pages_.Get(i)->OnInitialization();
+    }
+    
+    InitZoneFileWatch();
+    
+    if (g_timingDisplay)
+    {
+        int numSurfaces = 0;
+        for (int i = 0; i < pages_.GetSize(); ++i)
+            numSurfaces += pages_.Get(i)->GetSurfaces().GetSize();
+        
+        char buffer[MEDBUF];
+        snprintf(buffer, sizeof(buffer), "CSI Init: %d pages, %d surfaces -- ports %.1f ms, surface files %.1f ms, zone preprocessing %.1f ms, zone loading %.1f ms, total %.1f ms\n",
+                 pages_.GetSize(),
+                 numSurfaces,
+                 initPhaseTimes_[InitPhase_Ports] * 1000.0,
+                 initPhaseTimes_[InitPhase_SurfaceFiles] * 1000.0,
+                 initPhaseTimes_[InitPhase_PreProcessZones] * 1000.0,
+                 initPhaseTimes_[InitPhase_LoadZones] * 1000.0,
+                 (time_precise() - initStartTime) * 1000.0);
+        ShowConsoleMsg(buffer);
+    }
+}
+
+static int s_commandCount = 0;      // bumped after every main-section action, so cached toggle states know to refresh
+static int s_commandHookUsers = 0;
+
+static void OnPostCommand(int command, int flag)
+{
+    s_commandCount++;
+}
+
+static WDL_PtrList<CSurfIntegrator> s_integrators; // live instances, targets of the CSI_* script functions
+
+bool CSurfIntegrator::InjectMidiMessage(const char *surfaceName, const unsigned char *message, int size)
+{
+    bool found = false;
+    
+    for (int i = 0; i < midiSurfacesIO_.GetSize(); ++i)
+    {
+        if ( ! strcmp(midiSurfacesIO_.Get(i)->GetName(), surfaceName))
+        {
+            midiSurfacesIO_.Get(i)->InjectMidiMessage(message, size);
+            found = true;
+        }
+    }
+    
+    return found;
+}
+
+bool CSurfIntegrator::ReplaySurfaceTraffic(const char *surfaceName, const char *filePath, bool isRealTime)
+{
+    bool found = false;
+    
+    for (int i = 0; i < midiSurfacesIO_.GetSize(); ++i)
+        if ( ! strcmp(midiSurfacesIO_.Get(i)->GetName(), surfaceName) && midiSurfacesIO_.Get(i)->StartReplay(filePath, isRealTime))
+            found = true;
+    
+    for (int i = 0; i < oscSurfacesIO_.GetSize(); ++i)
+        if ( ! strcmp(oscSurfacesIO_.Get(i)->GetName(), surfaceName) && oscSurfacesIO_.Get(i)->StartReplay(filePath, isRealTime))
+            found = true;
+    
+    return found;
+}
+
+bool CSurfIntegrator::InjectOSCPacket(const char *surfaceName, const void *packet, int size)
+{
+    bool found = false;
+    
+    for (int i = 0; i < oscSurfacesIO_.GetSize(); ++i)
+    {
+        if ( ! strcmp(oscSurfacesIO_.Get(i)->GetName(), surfaceName))
+        {
+            oscSurfacesIO_.Get(i)->InjectPacket(packet, size);
+            found = true;
+        }
+    }
+    
+    return found;
+}
+
+// Script entry points: feed a surface as if its hardware had sent the message, so zones and actions can be driven without a device attached
+static bool CSI_InjectMidiMessage(const char *surfaceName, int status, int data1, int data2)
+{
+    if (WDL_NOT_NORMALLY(!surfaceName)) return false;
+    
+    const unsigned char message[3] = { (unsigned char)status, (unsigned char)data1, (unsigned char)data2 };
+    
+    bool found = false;
+    for (int i = 0; i < s_integrators.GetSize(); ++i)
+        if (s_integrators.Get(i)->InjectMidiMessage(surfaceName, message, sizeof(message)))
+            found = true;
+    
+    return found;
+}
+
+static bool CSI_InjectOSCMessage(const char *surfaceName, const char *oscAddress, double value)
+{
+    if (WDL_NOT_NORMALLY(!surfaceName || !oscAddress)) return false;
+    
+    oscpkt::Message message;
+    message.init(oscAddress).pushFloat((float)value);
+    
+    oscpkt::PacketWriter writer;
+    writer.addMessage(message);
+    
+    bool found = false;
+    for (int i = 0; i < s_integrators.GetSize(); ++i)
+        if (s_integrators.Get(i)->InjectOSCPacket(surfaceName, writer.packetData(), writer.packetSize()))
+            found = true;
+    
+    return found;
+}
+
+static bool CSI_ReplaySurfaceTraffic(const char *surfaceName, const char *filePath, bool realTime)
+{
+    if (WDL_NOT_NORMALLY(!surfaceName)) return false;
+    
+    bool found = false;
+    for (int i = 0; i < s_integrators.GetSize(); ++i)
+        if (s_integrators.Get(i)->ReplaySurfaceTraffic(surfaceName, filePath, realTime))
+            found = true;
+    
+    return found;
+}
+
+static void CSI_SetTimingDisplay(bool isTimingDisplayed)
+{
+    g_timingDisplay = isTimingDisplayed;
+}
+
+static void CSI_SetThinTouchedFXWrites(bool isThinned)
+{
+    g_fxParamsThinWhileTouched = isThinned;
+}
+
+static void *CSI_InjectMidiMessage_vararg(void **arglist, int numparms)
+{
+    if (numparms < 4) return NULL;
+    return (void *)(INT_PTR)CSI_InjectMidiMessage((const char *)arglist[0], (int)(INT_PTR)arglist[1], (int)(INT_PTR)arglist[2], (int)(INT_PTR)arglist[3]);
+}
+
+static void *CSI_InjectOSCMessage_vararg(void **arglist, int numparms)
+{
+    if (numparms < 3 || !arglist[2]) return NULL;
+    return (void *)(INT_PTR)CSI_InjectOSCMessage((const char *)arglist[0], (const char *)arglist[1], *(double *)arglist[2]);
+}
+
+static void *CSI_ReplaySurfaceTraffic_vararg(void **arglist, int numparms)
+{
+    if (numparms < 3) return NULL;
+    return (void *)(INT_PTR)CSI_ReplaySurfaceTraffic((const char *)arglist[0], (const char *)arglist[1], arglist[2] != NULL);
+}
+
+static void *CSI_SetTimingDisplay_vararg(void **arglist, int numparms)
+{
+    if (numparms < 1) return NULL;
+    CSI_SetTimingDisplay(arglist[0] != NULL);
+    return NULL;
+}
+
+static void *CSI_SetThinTouchedFXWrites_vararg(void **arglist, int numparms)
+{
+    if (numparms < 1) return NULL;
+    CSI_SetThinTouchedFXWrites(arglist[0] != NULL);
+    return NULL;
+}
+
+static void RegisterScriptFunctions(bool isRegistering)
+{
+    if ( ! g_reaper_plugin_info)
+        return;
+    
+    const char *prefix = isRegistering ? "" : "-";
+    char name[MEDBUF];
+    
+    snprintf(name, sizeof(name), "%sAPI_CSI_InjectMidiMessage", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_InjectMidiMessage);
+    snprintf(name, sizeof(name), "%sAPIvararg_CSI_InjectMidiMessage", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_InjectMidiMessage_vararg);
+    snprintf(name, sizeof(name), "%sAPIdef_CSI_InjectMidiMessage", prefix);
+    g_reaper_plugin_info->Register(name, (void *)"bool\0const char*,int,int,int\0surfaceName,status,data1,data2\0"
+                                   "Feeds a three byte MIDI message to the named CSI MIDI surface as if its input had received it. Returns false if no such surface exists.");
+    
+    snprintf(name, sizeof(name), "%sAPI_CSI_InjectOSCMessage", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_InjectOSCMessage);
+    snprintf(name, sizeof(name), "%sAPIvararg_CSI_InjectOSCMessage", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_InjectOSCMessage_vararg);
+    snprintf(name, sizeof(name), "%sAPIdef_CSI_InjectOSCMessage", prefix);
+    g_reaper_plugin_info->Register(name, (void *)"bool\0const char*,const char*,double\0surfaceName,oscAddress,value\0"
+                                   "Feeds a float OSC message to the named CSI OSC surface as if its receive port had received it. Returns false if no such surface exists.");
+    
+    snprintf(name, sizeof(name), "%sAPI_CSI_ReplaySurfaceTraffic", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_ReplaySurfaceTraffic);
+    snprintf(name, sizeof(name), "%sAPIvararg_CSI_ReplaySurfaceTraffic", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_ReplaySurfaceTraffic_vararg);
+    snprintf(name, sizeof(name), "%sAPIdef_CSI_ReplaySurfaceTraffic", prefix);
+    g_reaper_plugin_info->Register(name, (void *)"bool\0const char*,const char*,bool\0surfaceName,filePath,realTime\0"
+                                   "Feeds the input recorded in a CSI traffic file to the named surface, with the original timing if realTime is set, otherwise all at once. "
+                                   "An empty filePath replays the surface's own recording from /CSI/Traffic. Returns false if no such surface or recording exists.");
+    
+    snprintf(name, sizeof(name), "%sAPI_CSI_SetTimingDisplay", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_SetTimingDisplay);
+    snprintf(name, sizeof(name), "%sAPIvararg_CSI_SetTimingDisplay", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_SetTimingDisplay_vararg);
+    snprintf(name, sizeof(name), "%sAPIdef_CSI_SetTimingDisplay", prefix);
+    g_reaper_plugin_info->Register(name, (void *)"void\0bool\0isTimingDisplayed\0"
+                                   "Turns CSI's \"Show timing\" reports on or off, as the checkbox in the CSI preferences does.");
+    
+    snprintf(name, sizeof(name), "%sAPI_CSI_SetThinTouchedFXWrites", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_SetThinTouchedFXWrites);
+    snprintf(name, sizeof(name), "%sAPIvararg_CSI_SetThinTouchedFXWrites", prefix);
+    g_reaper_plugin_info->Register(name, (void *)CSI_SetThinTouchedFXWrites_vararg);
+    snprintf(name, sizeof(name), "%sAPIdef_CSI_SetThinTouchedFXWrites", prefix);
+    g_reaper_plugin_info->Register(name, (void *)"void\0bool\0isThinned\0"
+                                   "Turns CSI's \"Thin FX param writes while touched\" on or off, as the checkbox in the CSI preferences does.");
+}
+
+static const double s_toggleStatePollInterval = 0.25; // catches state changed outside main-section actions
+
+void CSurfIntegrator::RefreshToggleStates()
+{
+    if (toggleStates_.GetSize() == 0)
+        return;
+    
+    double now = time_precise();
+    
+    if (toggleStatesCommandCount_ != s_commandCount || now - toggleStatesTime_ >= s_toggleStatePollInterval)
+        toggleStates_.DeleteAll();
+}
+
+int CSurfIntegrator::GetToggleState(int commandId)
+{
+    int *state = toggleStates_.GetPtr(commandId);
+    
+    if (state != NULL)
+        return *state;
+    
+    if (toggleStates_.GetSize() == 0)
+    {
+        toggleStatesCommandCount_ = s_commandCount;
+        toggleStatesTime_ = time_precise();
+    }
+    
+    int newState = GetToggleCommandState(commandId);
+    toggleStates_.Insert(commandId, newState);
+    
+    return newState;
+}
+
+const TrackMeter &CSurfIntegrator::GetTrackMeter(MediaTrack *track)
+{
+    if (anyTrackSoloTick_ != meterTick_)
+    {
+        anyTrackSoloTick_ = meterTick_;
+        anyTrackSolo_ = AnyTrackSolo(NULL) != 0;
+    }
+    
+    TrackMeter *meter = trackMeters_.GetPtr(track);
+    
+    if (meter == NULL)
+    {
+        TrackMeter newMeter;
+        newMeter.tick = meterTick_ - 1;
+        newMeter.peakL = newMeter.peakR = 0.0;
+        newMeter.isSoloGated = false;
+        trackMeters_.Insert(track, newMeter);
+        meter = trackMeters_.GetPtr(track);
+    }
+    
+    if (meter->tick != meterTick_)
+    {
+        meter->tick = meterTick_;
+        meter->peakL = Track_GetPeakInfo(track, 0);
+        meter->peakR = Track_GetPeakInfo(track, 1);
+        meter->isSoloGated = anyTrackSolo_ && ! GetMediaTrackInfo_Value(track, "I_SOLO");
+    }
+    
+    return *meter;
+}
+
+static const double s_fxParamFormatMinInterval = 0.1; // while a value is moving, reformat at most this often
+static const double s_fxParamFormatMaxAge = 1.0;      // reformat an unchanged value this often, for plugins that display time-varying text
+
+const char *CSurfIntegrator::GetFormattedFXParamValue(MediaTrack *track, int fxIndex, int paramIndex)
+{
+    FXParamKey key;
+    key.track = track;
+    key.fxIndex = fxIndex;
+    key.paramIndex = paramIndex;
+    
+    double value = TrackFX_GetParamNormalized(track, fxIndex, paramIndex);
+    double now = time_precise();
+    
+    FormattedFXParam *param = formattedFXParams_.GetPtr(key);
+    
+    if (param == NULL)
+    {
+        if (formattedFXParams_.GetSize() >= 4096)
+            formattedFXParams_.DeleteAll();
+        
+        FormattedFXParam newParam;
+        newParam.text[0] = 0;
+        TrackFX_GetFormattedParamValue(track, fxIndex, paramIndex, newParam.text, sizeof(newParam.text));
+        newParam.normalizedValue = value;
+        newParam.formatTime = now;
+        formattedFXParams_.Insert(key, newParam);
+        
+        param = formattedFXParams_.GetPtr(key);
+    }
+    else if ((value != param->normalizedValue && now - param->formatTime >= s_fxParamFormatMinInterval) || now - param->formatTime >= s_fxParamFormatMaxAge)
+    {
+        TrackFX_GetFormattedParamValue(track, fxIndex, paramIndex, param->text, sizeof(param->text));
+        param->normalizedValue = value;
+        param->formatTime = now;
+    }
+    
+    return param->text;
+}
+
+static const double s_touchedFXParamWriteInterval = 0.1; // "Thin FX param writes while touched" -- at most this often until release
+
+PendingFXParamWrite *CSurfIntegrator::GetFXParamWrite(MediaTrack *track, int fxIndex, int paramIndex)
+{
+    FXParamKey key;
+    key.track = track;
+    key.fxIndex = fxIndex;
+    key.paramIndex = paramIndex;
+    
+    PendingFXParamWrite *write = fxParamWrites_.GetPtr(key);
+    
+    if (write == NULL)
+    {
+        PendingFXParamWrite newWrite;
+        newWrite.value = 0.0;
+        newWrite.writeTime = 0.0;
+        newWrite.isPending = false;
+        newWrite.isTouched = false;
+        fxParamWrites_.Insert(key, newWrite);
+        
+        write = fxParamWrites_.GetPtr(key);
+    }
+    
+    return write;
+}
+
+// Reads through the write queue so relative encoders accumulate on the value they last queued, not on the one REAPER still holds
+double CSurfIntegrator::GetFXParam(MediaTrack *track, int fxIndex, int paramIndex, double *min, double *max)
+{
+    double value = TrackFX_GetParam(track, fxIndex, paramIndex, min, max);
+    
+    FXParamKey key;
+    key.track = track;
+    key.fxIndex = fxIndex;
+    key.paramIndex = paramIndex;
+    
+    PendingFXParamWrite *write = fxParamWrites_.GetPtr(key);
+    
+    if (write != NULL && write->isPending)
+        return write->value;
+    else
+        return value;
+}
+
+void CSurfIntegrator::SetFXParam(MediaTrack *track, int fxIndex, int paramIndex, double value)
+{
+    PendingFXParamWrite *write = GetFXParamWrite(track, fxIndex, paramIndex);
+    
+    write->value = value;
+    write->isPending = true;
+}
+
+void CSurfIntegrator::TouchFXParam(MediaTrack *track, int fxIndex, int paramIndex, bool isTouched)
+{
+    PendingFXParamWrite *write = GetFXParamWrite(track, fxIndex, paramIndex);
+    
+    write->isTouched = isTouched;
+    
+    if (isTouched)
+    {
+        double min, max = 0.0;
+        TrackFX_SetParam(track, fxIndex, paramIndex, GetFXParam(track, fxIndex, paramIndex, &min, &max));
+        write->isPending = false;
+        write->writeTime = 0.0; // so the first move of the gesture goes out at once, and only those after it are thinned
+    }
+    else
+    {
+        if (write->isPending)
+        {
+            TrackFX_SetParam(track, fxIndex, paramIndex, write->value);
+            write->isPending = false;
+        }
+        
+        TrackFX_EndParamEdit(track, fxIndex, paramIndex);
+    }
+}
+
+void CSurfIntegrator::FlushFXParamWrites()
+{
+    if (fxParamWrites_.GetSize() == 0)
+        return;
+    
+    double now = time_precise();
+    
+    for (int i = fxParamWrites_.GetSize() - 1; i >= 0; --i)
+    {
+        FXParamKey key = { NULL, 0, 0 };
+        PendingFXParamWrite *write = fxParamWrites_.EnumeratePtr(i, &key);
+        
+        if ( ! DAW::ValidateTrackPtr(key.track)) // track deleted since the write was queued
+        {
+            fxParamWrites_.DeleteByIndex(i);
+            continue;
+        }
+        
+        if (write->isPending && ( ! write->isTouched || ! g_fxParamsThinWhileTouched || now - write->writeTime >= s_touchedFXParamWriteInterval))
+        {
+            TrackFX_SetParam(key.track, key.fxIndex, key.paramIndex, write->value);
+            write->isPending = false;
+            write->writeTime = now;
+        }
+        
+        if ( ! write->isPending && ! write->isTouched)
+            fxParamWrites_.DeleteByIndex(i);
+    }
+}
+
+#ifdef __linux__
+void CSurfIntegrator::AddZoneFileWatch(const char *folder)
+{
+    int wd = inotify_add_watch(zoneFileWatch_, folder, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    
+    if (wd < 0 || zoneFileWatchFolderIndices_.Exists(wd))
+        return;
+    
+    zoneFileWatchFolderIndices_.Insert(wd, zoneFileWatchFolders_.size());
+    zoneFileWatchFolders_.push_back(folder);
+}
+
+void CSurfIntegrator::InitZoneFileWatch()
+{
+    // Closing an inotify descriptor waits out a kernel grace period, several ms on every reset, so keep it.
+    // Watching a folder again hands back its existing watch, leaving only the folders that went away to remove.
+    WDL_TypedBuf<int> previousWatches;
+    
+    if (zoneFileWatch_ < 0)
+        zoneFileWatch_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    else
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", iniFilePath.c_str(), lineNumber);
-        ShowConsoleMsg(buffer);
+        char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        while (read(zoneFileWatch_, buf, sizeof(buf)) > 0) // Init has just reread everything these are about
+            ;
+        
+        int wd = 0;
+        for (int i = 0; zoneFileWatchFolderIndices_.EnumeratePtr(i, &wd) != NULL; ++i)
+            previousWatches.Add(wd);
     }
     
-    if (pages_.GetSize() == 0)
-        pages_.Add(new Page(this, "Home", false, false, false, false));
+    zoneFileWatchFolders_.clear();
+    zoneFileWatchFolderIndices_.DeleteAll();
     
-    for (int i = 0; i < pages_.GetSize(); ++i)
+    if (zoneFileWatch_ < 0)
+        return;
+    
+    WDL_PtrList<char> stack;
+    WDL_FastString tmp;
+    stack.Add(strdup((string(GetResourcePath()) + "/CSI/Surfaces").c_str()));
+    
+    while (stack.GetSize() > 0)
     {
-        for (int j = 0; j < pages_.Get(i)->GetSurfaces().GetSize(); ++j)
-            pages_.Get(i)->GetSurfaces().Get(j)->ForceClear();
+        const char *curpath = stack.Get(0);
+        AddZoneFileWatch(curpath);
+        
+        WDL_DirScan ds;
+        if (!ds.First(curpath))
+        {
+            do
+            {
+                if (ds.GetCurrentFN()[0] != '.' && ds.GetCurrentIsDirectory())
+                {
+                    ds.GetCurrentFullFN(&tmp);
+                    stack.Add(strdup(tmp.Get()));
+                }
+            } while (!ds.Next());
+        }
+        stack.Delete(0, true, free);
+    }
+    
+    for (int i = 0; i < previousWatches.GetSize(); ++i)
+        if ( ! zoneFileWatchFolderIndices_.Exists(previousWatches.Get()[i]))
+            inotify_rm_watch(zoneFileWatch_, previousWatches.Get()[i]);
+}
 
-        pages_.Get(i)->OnInitialization();
+static int s_zoneFileReloadSerial = 0; // one per changed file, see CSIZoneDefinitions::reloadSerial
+
+void CSurfIntegrator::CheckZoneFileWatch()
+{
+    if (zoneFileWatch_ < 0)
+        return;
+    
+    string_list changedFiles;
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    
+    for (;;)
+    {
+        ssize_t len = read(zoneFileWatch_, buf, sizeof(buf));
+        
+        if (len <= 0) // EAGAIN, nothing pending
+            break;
+        
+        for (char *p = buf; p < buf + len; )
+        {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + event->len;
+            
+            if (event->len == 0 || event->name[0] == '.' || ! zoneFileWatchFolderIndices_.Exists(event->wd))
+                continue;
+            
+            WDL_FastString path;
+            path.Set(zoneFileWatchFolders_.get(zoneFileWatchFolderIndices_.Get(event->wd)));
+            path.Append("/");
+            path.Append(event->name);
+            
+            if (event->mask & IN_ISDIR)
+                AddZoneFileWatch(path.Get());
+            else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                bool isDuplicate = false;
+                for (int i = 0; i < changedFiles.size(); ++i)
+                    if (changedFiles[i] == path.Get())
+                        isDuplicate = true;
+                
+                if ( ! isDuplicate)
+                    changedFiles.push_back(path.Get());
+            }
+        }
+    }
+    
+    for (int i = 0; i < changedFiles.size(); ++i)
+    {
+        if ( ! stricmp(".zon", WDL_get_fileext(changedFiles[i])))
+        {
+            s_zoneFileReloadSerial++;
+            
+            for (int j = 0; j < pages_.GetSize(); ++j)
+                pages_.Get(j)->ReloadZoneFile(changedFiles[i], s_zoneFileReloadSerial);
+        }
+        else if ( ! stricmp(".txt", WDL_get_fileext(changedFiles[i])) || ! stricmp(".mst", WDL_get_fileext(changedFiles[i])) || ! stricmp(".ost", WDL_get_fileext(changedFiles[i])))
+        {
+            char buffer[BUFSIZ];
+            snprintf(buffer, sizeof(buffer), "%s changed, reset CSI to apply surface definition changes\n", changedFiles[i].c_str());
+            ShowConsoleMsg(buffer);
+        }
     }
 }
+#else
+void CSurfIntegrator::InitZoneFileWatch() {}
+void CSurfIntegrator::CheckZoneFileWatch() {}
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // TrackNavigator
@@ -1605,18 +2404,79 @@ MediaTrack *FocusedFXNavigator::GetTrack()
         return NULL;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ActionContextConfig
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void disposeActionContextConfig(ActionContextConfig *config) { delete config; }
+
+static WDL_StringKeyedArray<ActionContextConfig*> &ActionContextConfigs()
+{
+    static WDL_StringKeyedArray<ActionContextConfig*> s_configs(true, disposeActionContextConfig);
+    return s_configs;
+}
+
+static void GetActionContextConfigKey(const ActionContextConfig &config, WDL_FastString &key)
+{
+    key.Append(config.stringParam.c_str());
+    key.Append("\t");
+    key.Append(config.fxParamDisplayName.c_str());
+    key.Append("\t");
+    for (int i = 0; i < (int)config.steppedValues.size(); ++i)
+        key.AppendFormatted(32, "%.17g,", config.steppedValues[i]);
+    key.Append("\t");
+    for (int i = 0; i < (int)config.acceleratedDeltaValues.size(); ++i)
+        key.AppendFormatted(32, "%.17g,", config.acceleratedDeltaValues[i]);
+    key.Append("\t");
+    for (int i = 0; i < (int)config.acceleratedTickValues.size(); ++i)
+        key.AppendFormatted(16, "%d,", config.acceleratedTickValues[i]);
+    key.Append("\t");
+    for (int i = 0; i < (int)config.colorValues.size(); ++i)
+        key.AppendFormatted(48, "%d %d %d %d,", config.colorValues[i].r, config.colorValues[i].g, config.colorValues[i].b, config.colorValues[i].a);
+}
+
+const ActionContextConfig *ActionContextConfig::Intern(const ActionContextConfig &config)
+{
+    WDL_FastString key;
+    GetActionContextConfigKey(config, key);
+    
+    ActionContextConfig *interned = ActionContextConfigs().Get(key.Get());
+    
+    if (interned == NULL)
+    {
+        interned = new ActionContextConfig(config);
+        interned->refCount = 0;
+        ActionContextConfigs().Insert(key.Get(), interned);
+    }
+    
+    interned->refCount++;
+    
+    return interned;
+}
+
+void ActionContextConfig::Release(const ActionContextConfig *config)
+{
+    if (config == NULL || --config->refCount > 0)
+        return;
+    
+    WDL_FastString key;
+    GetActionContextConfigKey(*config, key);
+    ActionContextConfigs().Delete(key.Get());
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ActionContext
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ActionContext::ActionContext(CSurfIntegrator *const csi, Action *action, Widget *widget, Zone *zone, int paramIndex, const string_list *paramsAndProperties, const string *stringParam): csi_(csi), action_(action), widget_(widget), zone_(zone)
 {
+    ActionContextConfig config;
+    
     intParam_ = 0;
     supportsColor_ = false;
     supportsTrackColor_ = false;
     provideFeedback_ = true;
     
     if (stringParam != NULL)
-        stringParam_ = *stringParam;
+        config.stringParam = *stringParam;
     
     paramIndex_ = paramIndex;
     
@@ -1664,10 +2524,7 @@ ActionContext::ActionContext(CSurfIntegrator *const csi, Action *action, Widget
         if (!strcmp((*paramsAndProperties)[i], "NoFeedback"))
             provideFeedback_ = false;
 
-    const char *actionName = "";
-    
-    if (params.size() > 0)
-        actionName = params[0];
+    const ActionParamLayout paramLayout = action_->GetParamLayout();
     
     // Action with int param, could include leading minus sign
     if (params.size() > 1 && (isdigit(params[1][0]) ||  params[1][0] == '-'))  // C++ 2003 says empty strings can be queried without catastrophe :)
@@ -1675,9 +2532,9 @@ ActionContext::ActionContext(CSurfIntegrator *const csi, Action *action, Widget
         intParam_= atol(params[1].c_str());
     }
     
-    if (!strcmp(actionName, "Bank") && (params.size() > 2 && (isdigit(params[2][0]) ||  params[2][0] == '-')))  // C++ 2003 says empty strings can be queried without catastrophe :)
+    if (paramLayout == ActionParamLayout_Bank && (params.size() > 2 && (isdigit(params[2][0]) ||  params[2][0] == '-')))  // C++ 2003 says empty strings can be queried without catastrophe :)
     {
-        stringParam_ = params[1];
+        config.stringParam = params[1];
         intParam_= atol(params[2].c_str());
     }
         
@@ -1689,26 +2546,11 @@ ActionContext::ActionContext(CSurfIntegrator *const csi, Action *action, Widget
     
     // Action with string param
     if (params.size() > 1)
-        stringParam_ = params[1];
+        config.stringParam = params[1];
     
-    if (!strcmp(actionName, "TrackVolumeDB") || !strcmp(actionName, "TrackSendVolumeDB"))
-    {
-        rangeMinimum_ = -144.0;
-        rangeMaximum_ = 24.0;
-    }
-    
-    if (!strcmp(actionName, "TrackPanPercent") ||
-        !strcmp(actionName, "TrackPanWidthPercent") ||
-        !strcmp(actionName, "TrackPanLPercent") ||
-        !strcmp(actionName, "TrackPanRPercent"))
-    {
-        rangeMinimum_ = -100.0;
-        rangeMaximum_ = 100.0;
-    }
+    action_->GetDefaultRange(rangeMinimum_, rangeMaximum_);
    
-    if ((!strcmp(actionName, "Reaper") ||
-         !strcmp(actionName, "ReaperDec") ||
-         !strcmp(actionName, "ReaperInc")) && params.size() > 1)
+    if (paramLayout == ActionParamLayout_CommandId && params.size() > 1)
     {
         if (isdigit(params[1][0]))
         {
@@ -1722,39 +2564,25 @@ ActionContext::ActionContext(CSurfIntegrator *const csi, Action *action, Widget
                 commandId_ = 65535; // no-op
         }
     }
-        
-    if ((!strcmp(actionName, "FXParam") || !strcmp(actionName, "JSFXParam")) &&
-          params.size() > 1 && isdigit(params[1][0]))
-    {
-        paramIndex_ = atol(params[1].c_str());
-    }
-    
-    if (!strcmp(actionName, "FXParamValueDisplay") && params.size() > 1 && isdigit(params[1][0]))
-    {
-        paramIndex_ = atol(params[1].c_str());
-    }
     
-    if (!strcmp(actionName, "FXParamNameDisplay") && params.size() > 1 && isdigit(params[1][0]))
-    {
-        paramIndex_ = atol(params[1].c_str());
-        
-        if (params.size() > 2 && params[2] != "{" && params[2] != "[")
-               fxParamDisplayName_ = params[2];
-    }
+    if (paramLayout == ActionParamLayout_FXParamNameDisplay && params.size() > 2 && isdigit(params[1][0]) && params[2] != "{" && params[2] != "[")
+        config.fxParamDisplayName = params[2];
     
-    if (!strcmp(actionName, "FixedTextDisplay") && (params.size() > 2 && (isdigit(params[2][0]))))  // C++ 2003 says empty strings can be queried without catastrophe :)
+    if (paramLayout == ActionParamLayout_FixedTextDisplay && (params.size() > 2 && (isdigit(params[2][0]))))  // C++ 2003 says empty strings can be queried without catastrophe :)
     {
-        stringParam_ = params[1];
+        config.stringParam = params[1];
         paramIndex_= atol(params[2].c_str());
     }
     
     if (params.size() > 0)
-        SetColor(params, supportsColor_, supportsTrackColor_, colorValues_);
+        SetColor(params, supportsColor_, supportsTrackColor_, config.colorValues);
     
-    GetSteppedValues(widget, action_, zone_, paramIndex_, params, widgetProperties_, deltaValue_, acceleratedDeltaValues_, rangeMinimum_, rangeMaximum_, steppedValues_, acceleratedTickValues_);
+    GetSteppedValues(widget, action_, zone_, paramIndex_, params, widgetProperties_, deltaValue_, config.acceleratedDeltaValues, rangeMinimum_, rangeMaximum_, config.steppedValues, config.acceleratedTickValues);
 
-    if (acceleratedTickValues_.size() < 1)
-        acceleratedTickValues_.push_back(0);
+    if (config.acceleratedTickValues.size() < 1)
+        config.acceleratedTickValues.push_back(0);
+    
+    config_ = ActionContextConfig::Intern(config);
 }
 
 Page *ActionContext::GetPage()
@@ -1786,19 +2614,19 @@ void ActionContext::RunDeferredActions()
 {
     if (holdDelayAmount_ != 0 && delayStartTimeValid_ && (GetTickCount() - delayStartTime_) > holdDelayAmount_)
     {
-        if (steppedValues_.size() > 0)
+        if (config_->steppedValues.size() > 0)
         {
             if (deferredValue_ != 0.0) // ignore release messages
             {
-                if (steppedValuesIndex_ == steppedValues_.size() - 1)
+                if (steppedValuesIndex_ == config_->steppedValues.size() - 1)
                 {
-                    if (steppedValues_[0] < steppedValues_[steppedValuesIndex_]) // GAW -- only wrap if 1st value is lower
+                    if (config_->steppedValues[0] < config_->steppedValues[steppedValuesIndex_]) // GAW -- only wrap if 1st value is lower
                         steppedValuesIndex_ = 0;
                 }
                 else
                     steppedValuesIndex_++;
                 
-                DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+                DoRangeBoundAction(config_->steppedValues[steppedValuesIndex_]);
             }
         }
         else
@@ -1826,14 +2654,14 @@ void ActionContext::UpdateColorValue(double value)
     if (supportsColor_)
     {
         currentColorIndex_ = value == 0 ? 0 : 1;
-        if (colorValues_.size() > currentColorIndex_)
-            widget_->UpdateColorValue(colorValues_[currentColorIndex_]);
+        if (config_->colorValues.size() > currentColorIndex_)
+            widget_->UpdateColorValue(config_->colorValues[currentColorIndex_]);
     }
 }
 
 void ActionContext::UpdateWidgetValue(double value)
 {
-    if (steppedValues_.size() > 0)
+    if (config_->steppedValues.size() > 0)
         SetSteppedValueIndex(value);
 
     value = isFeedbackInverted_ == false ? value : 1.0 - value;
@@ -1848,7 +2676,7 @@ void ActionContext::UpdateWidgetValue(double value)
 
 void ActionContext::UpdateJSFXWidgetSteppedValue(double value)
 {
-    if (steppedValues_.size() > 0)
+    if (config_->steppedValues.size() > 0)
         SetSteppedValueIndex(value);
 }
 
@@ -1889,19 +2717,19 @@ void ActionContext::DoAction(double value)
     }
     else
     {
-        if (steppedValues_.size() > 0)
+        if (config_->steppedValues.size() > 0)
         {
             if (value != 0.0) // ignore release messages
             {
-                if (steppedValuesIndex_ == steppedValues_.size() - 1)
+                if (steppedValuesIndex_ == config_->steppedValues.size() - 1)
                 {
-                    if (steppedValues_[0] < steppedValues_[steppedValuesIndex_]) // GAW -- only wrap if 1st value is lower
+                    if (config_->steppedValues[0] < config_->steppedValues[steppedValuesIndex_]) // GAW -- only wrap if 1st value is lower
                         steppedValuesIndex_ = 0;
                 }
                 else
                     steppedValuesIndex_++;
                 
-                DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+                DoRangeBoundAction(config_->steppedValues[steppedValuesIndex_]);
             }
         }
         else
@@ -1911,7 +2739,7 @@ void ActionContext::DoAction(double value)
 
 void ActionContext::DoRelativeAction(double delta)
 {
-    if (steppedValues_.size() > 0)
+    if (config_->steppedValues.size() > 0)
         DoSteppedValueAction(delta);
     else
         DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) + (deltaValue_ != 0.0 ? (delta > 0 ? deltaValue_ : -deltaValue_) : delta));
@@ -1919,9 +2747,9 @@ void ActionContext::DoRelativeAction(double delta)
 
 void ActionContext::DoRelativeAction(int accelerationIndex, double delta)
 {
-    if (steppedValues_.size() > 0)
+    if (config_->steppedValues.size() > 0)
         DoAcceleratedSteppedValueAction(accelerationIndex, delta);
-    else if (acceleratedDeltaValues_.size() > 0)
+    else if (config_->acceleratedDeltaValues.size() > 0)
         DoAcceleratedDeltaValueAction(accelerationIndex, delta);
     else
         DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) +  (deltaValue_ != 0.0 ? (delta > 0 ? deltaValue_ : -deltaValue_) : delta));
@@ -1947,10 +2775,10 @@ void ActionContext::DoSteppedValueAction(double delta)
     {
         steppedValuesIndex_++;
         
-        if (steppedValuesIndex_ > (int)steppedValues_.size() - 1)
-            steppedValuesIndex_ = (int)steppedValues_.size() - 1;
+        if (steppedValuesIndex_ > (int)config_->steppedValues.size() - 1)
+            steppedValuesIndex_ = (int)config_->steppedValues.size() - 1;
         
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        DoRangeBoundAction(config_->steppedValues[steppedValuesIndex_]);
     }
     else
     {
@@ -1959,7 +2787,7 @@ void ActionContext::DoSteppedValueAction(double delta)
         if (steppedValuesIndex_ < 0 )
             steppedValuesIndex_ = 0;
         
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        DoRangeBoundAction(config_->steppedValues[steppedValuesIndex_]);
     }
 }
 
@@ -1976,22 +2804,22 @@ void ActionContext::DoAcceleratedSteppedValueAction(int accelerationIndex, doubl
         accumulatedIncTicks_ = accumulatedIncTicks_ - 1 < 0 ? 0 : accumulatedIncTicks_ - 1;
     }
     
-    accelerationIndex = accelerationIndex > (int)acceleratedTickValues_.size() - 1 ? (int)acceleratedTickValues_.size() - 1 : accelerationIndex;
+    accelerationIndex = accelerationIndex > (int)config_->acceleratedTickValues.size() - 1 ? (int)config_->acceleratedTickValues.size() - 1 : accelerationIndex;
     accelerationIndex = accelerationIndex < 0 ? 0 : accelerationIndex;
     
-    if (delta > 0 && accumulatedIncTicks_ >= acceleratedTickValues_[accelerationIndex])
+    if (delta > 0 && accumulatedIncTicks_ >= config_->acceleratedTickValues[accelerationIndex])
     {
         accumulatedIncTicks_ = 0;
         accumulatedDecTicks_ = 0;
         
         steppedValuesIndex_++;
         
-        if (steppedValuesIndex_ > (int)steppedValues_.size() - 1)
-            steppedValuesIndex_ = (int)steppedValues_.size() - 1;
+        if (steppedValuesIndex_ > (int)config_->steppedValues.size() - 1)
+            steppedValuesIndex_ = (int)config_->steppedValues.size() - 1;
         
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        DoRangeBoundAction(config_->steppedValues[steppedValuesIndex_]);
     }
-    else if (delta < 0 && accumulatedDecTicks_ >= acceleratedTickValues_[accelerationIndex])
+    else if (delta < 0 && accumulatedDecTicks_ >= config_->acceleratedTickValues[accelerationIndex])
     {
         accumulatedIncTicks_ = 0;
         accumulatedDecTicks_ = 0;
@@ -2001,19 +2829,19 @@ void ActionContext::DoAcceleratedSteppedValueAction(int accelerationIndex, doubl
         if (steppedValuesIndex_ < 0 )
             steppedValuesIndex_ = 0;
         
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        DoRangeBoundAction(config_->steppedValues[steppedValuesIndex_]);
     }
 }
 
 void ActionContext::DoAcceleratedDeltaValueAction(int accelerationIndex, double delta)
 {
-    accelerationIndex = accelerationIndex > (int)acceleratedDeltaValues_.size() - 1 ? (int)acceleratedDeltaValues_.size() - 1 : accelerationIndex;
+    accelerationIndex = accelerationIndex > (int)config_->acceleratedDeltaValues.size() - 1 ? (int)config_->acceleratedDeltaValues.size() - 1 : accelerationIndex;
     accelerationIndex = accelerationIndex < 0 ? 0 : accelerationIndex;
     
     if (delta > 0.0)
-        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) + acceleratedDeltaValues_[accelerationIndex]);
+        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) + config_->acceleratedDeltaValues[accelerationIndex]);
     else
-        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) - acceleratedDeltaValues_[accelerationIndex]);
+        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) - config_->acceleratedDeltaValues[accelerationIndex]);
 }
 
 void ActionContext::GetColorValues(vector<rgba_color> &colorValues, const string_list &colors)
@@ -2138,28 +2966,59 @@ void Zone::InitSubZones(const string_list &subZones, const char *widgetSuffix)
             zoneManager_->LoadZoneFile(subZone, widgetSuffix);
             subZones_.push_back(subZone);
         }
+        else
+            zoneManager_->AddUnresolvedZoneName(subZones[i]);
     }
 }
 
+bool Zone::UsesSourceFile(const char *filePath)
+{
+    if ( ! strcmp(sourceFilePath_.c_str(), filePath))
+        return true;
+    
+    for (int i = 0; i < includedZones_.size(); ++i)
+        if (includedZones_[i]->UsesSourceFile(filePath))
+            return true;
+    
+    for (int i = 0; i < subZones_.size(); ++i)
+        if (subZones_[i]->UsesSourceFile(filePath))
+            return true;
+    
+    return false;
+}
+
+ZoneSlotKind Zone::SlotKindFromName(const string &name)
+{
+    if (name == "TrackSend")
+        return ZoneSlotKind_TrackSend;
+    if (name == "TrackReceive")
+        return ZoneSlotKind_TrackReceive;
+    if (name == "TrackFXMenu")
+        return ZoneSlotKind_TrackFXMenu;
+    if (name == "SelectedTrackSend")
+        return ZoneSlotKind_SelectedTrackSend;
+    if (name == "SelectedTrackReceive")
+        return ZoneSlotKind_SelectedTrackReceive;
+    if (name == "SelectedTrackFXMenu")
+        return ZoneSlotKind_SelectedTrackFXMenu;
+    if (name == "MasterTrackFXMenu")
+        return ZoneSlotKind_MasterTrackFXMenu;
+    else return ZoneSlotKind_Default;
+}
+
 int Zone::GetSlotIndex()
 {
-    if (name_ == "TrackSend")
-        return zoneManager_->GetTrackSendOffset();
-    if (name_ == "TrackReceive")
-        return zoneManager_->GetTrackReceiveOffset();
-    if (name_ == "TrackFXMenu")
-        return zoneManager_->GetTrackFXMenuOffset();
-    if (name_ == "SelectedTrack")
-        return slotIndex_;
-    if (name_ == "SelectedTrackSend")
-        return slotIndex_ + zoneManager_->GetSelectedTrackSendOffset();
-    if (name_ == "SelectedTrackReceive")
-        return slotIndex_ + zoneManager_->GetSelectedTrackReceiveOffset();
-    if (name_ == "SelectedTrackFXMenu")
-        return slotIndex_ + zoneManager_->GetSelectedTrackFXMenuOffset();
-    if (name_ == "MasterTrackFXMenu")
-        return slotIndex_ + zoneManager_->GetMasterTrackFXMenuOffset();
-    else return slotIndex_;
+    switch (slotKind_)
+    {
+        case ZoneSlotKind_TrackSend:            return zoneManager_->GetTrackSendOffset();
+        case ZoneSlotKind_TrackReceive:         return zoneManager_->GetTrackReceiveOffset();
+        case ZoneSlotKind_TrackFXMenu:          return zoneManager_->GetTrackFXMenuOffset();
+        case ZoneSlotKind_SelectedTrackSend:    return slotIndex_ + zoneManager_->GetSelectedTrackSendOffset();
+        case ZoneSlotKind_SelectedTrackReceive: return slotIndex_ + zoneManager_->GetSelectedTrackReceiveOffset();
+        case ZoneSlotKind_SelectedTrackFXMenu:  return slotIndex_ + zoneManager_->GetSelectedTrackFXMenuOffset();
+        case ZoneSlotKind_MasterTrackFXMenu:    return slotIndex_ + zoneManager_->GetMasterTrackFXMenuOffset();
+        default:                                return slotIndex_;
+    }
 }
 
 void Zone::AddWidget(Widget *widget)
@@ -2407,26 +3266,58 @@ void Zone::UpdateCurrentActionContextModifiers()
     }
 }
 
-void Zone::UpdateCurrentActionContextModifier(Widget *widget)
+bool Zone::ResolveCurrentActionContextModifiers()
 {
-    const WDL_TypedBuf<int> &mods = widget->GetSurface()->GetModifiers();
+    bool changed = false;
+    
+    for (int i = 0; i < widgets_.GetSize(); ++i)
+        if (UpdateCurrentActionContextModifier(widgets_.Get(i)))
+            changed = true;
     
+    for (int i = 0; i < includedZones_.size(); ++i)
+        if (includedZones_[i]->ResolveCurrentActionContextModifiers())
+            changed = true;
+
+    for (int i = 0; i < subZones_.size(); ++i)
+        if (subZones_[i]->ResolveCurrentActionContextModifiers())
+            changed = true;
+    
+    return changed;
+}
+
+bool Zone::UpdateCurrentActionContextModifier(Widget *widget)
+{
     WDL_IntKeyedArray<WDL_PtrList<ActionContext> *> *wl = actionContextDictionary_.Get(widget);
-    if (wl != NULL) for (int i = 0; i < mods.GetSize(); ++i)
+    
+    if (wl == NULL)
+        return false;
+    
+    const int engaged = widget->GetSurface()->GetEngagedModifiers();
+    
+    // The widget's own modifier keys, walked from the top, give the largest engaged subset first --
+    // the same pick as trying every combination of the engaged modifiers, without enumerating them
+    for (int i = wl->GetSize() - 1; i >= 0; --i)
     {
-        if (wl->Get(mods.Get()[i]))
+        int modifier = 0;
+        wl->Enumerate(i, &modifier);
+        
+        if ((modifier & 3) != 0 || (modifier & ~engaged) != 0) // touch/toggle variants, or needs a modifier that isn't held
+            continue;
+        
+        if (int *current = currentActionContextModifiers_.GetPtr(widget))
         {
-            if (currentActionContextModifiers_.Exists(widget))
-            {
-                if (currentActionContextModifiers_.GetPtr(widget))
-                    *currentActionContextModifiers_.GetPtr(widget) = mods.Get()[i];
-            }
-            else
-                currentActionContextModifiers_.Insert(widget, mods.Get()[i]);
+            if (*current == modifier)
+                return false;
             
-            break;
+            *current = modifier;
         }
+        else
+            currentActionContextModifiers_.Insert(widget, modifier);
+        
+        return true;
     }
+    
+    return false;
 }
 
 const WDL_PtrList<ActionContext> &Zone::GetActionContexts(Widget *widget)
@@ -2524,6 +3415,9 @@ void  Widget::ForceClear()
 
 void Widget::LogInput(double value)
 {
+    if (g_timingDisplay)
+        traceInputTime_ = surface_->GetInputTime();
+    
     if (g_surfaceInDisplay)
     {
         char buffer[250];
@@ -2532,12 +3426,27 @@ void Widget::LogInput(double value)
     }
 }
 
+static const double s_maxTracedLatency = 1.0; // an input with no feedback by then most likely caused none
+
+void Widget::TraceFeedback(FeedbackProcessor *feedbackProcessor)
+{
+    if (traceInputTime_ == 0.0)
+        return;
+    
+    double latency = time_precise() - traceInputTime_;
+    traceInputTime_ = 0.0;
+    
+    if (g_timingDisplay && latency < s_maxTracedLatency)
+        csi_->AddFeedbackLatency(surface_->GetName(), type_.c_str(), feedbackProcessor->GetName(), latency);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Midi_FeedbackProcessor
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void Midi_FeedbackProcessor::SendMidiSysExMessage(MIDI_event_ex_t *midiMessage)
 {
     surface_->SendMidiSysExMessage(midiMessage);
+    widget_->TraceFeedback(this);
 }
 
 void Midi_FeedbackProcessor::SendMidiMessage(int first, int second, int third)
@@ -2552,6 +3461,7 @@ void Midi_FeedbackProcessor::ForceMidiMessage(int first, int second, int third)
     lastMessageSent_->midi_message[1] = second;
     lastMessageSent_->midi_message[2] = third;
     surface_->SendMidiMessage(first, second, third);
+    widget_->TraceFeedback(this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2608,72 +3518,230 @@ void OSC_IntFeedbackProcessor::ForceValue(const PropertyList &properties, double
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ZoneManager
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-ZoneManager::ZoneManager(CSurfIntegrator *const csi, ControlSurface *surface, const string &zoneFolder, const string &fxZoneFolder) : csi_(csi), surface_(surface), zoneFolder_(zoneFolder), fxZoneFolder_(fxZoneFolder == "" ? zoneFolder : fxZoneFolder), zoneInfo_(true, disposeAction)
+ZoneManager::ZoneManager(CSurfIntegrator *const csi, ControlSurface *surface, const string &zoneFolder, const string &fxZoneFolder) : csi_(csi), surface_(surface), zoneFolder_(zoneFolder), fxZoneFolder_(fxZoneFolder == "" ? zoneFolder : fxZoneFolder), zoneDefinitions_(csi->GetZoneDefinitions(zoneFolder_, fxZoneFolder_)), zoneInfo_(zoneDefinitions_->zoneInfo), zoneTemplates_(zoneDefinitions_->zoneTemplates)
 {
+    zoneDefinitions_->zoneManagers.Add(this);
+    
     holdDelayAmount_ = 1.0;
     
-    homeZone_ = NULL;
-
-    focusedFXZone_ = NULL;
-    fxSlotZone_ = NULL;
-    learnFocusedFXZone_ = NULL;
-    focusedFXParamZone_ = NULL;
+    homeZone_ = NULL;
+
+    focusedFXZone_ = NULL;
+    fxSlotZone_ = NULL;
+    learnFocusedFXZone_ = NULL;
+    focusedFXParamZone_ = NULL;
+    
+    listenerCategories_ = 0;
+    subscribersGeneration_ = -1;
+
+    isFocusedFXParamMappingEnabled_ = false;
+    
+    isFocusedFXMappingEnabled_ = true;
+    
+    trackSendOffset_ = 0;
+    trackReceiveOffset_ = 0;
+    trackFXMenuOffset_ = 0;
+    selectedTrackSendOffset_ = 0;
+    selectedTrackReceiveOffset_ = 0;
+    selectedTrackFXMenuOffset_ = 0;
+    masterTrackFXMenuOffset_ = 0;
+}
+
+Navigator *ZoneManager::GetNavigatorForTrack(MediaTrack *track) { return surface_->GetPage()->GetNavigatorForTrack(track); }
+void ZoneManager::ReclaimFixedTrackNavigators() { surface_->GetPage()->ReclaimFixedTrackNavigators(); }
+Navigator *ZoneManager::GetMasterTrackNavigator() { return surface_->GetPage()->GetMasterTrackNavigator(); }
+Navigator *ZoneManager::GetSelectedTrackNavigator() { return surface_->GetPage()->GetSelectedTrackNavigator(); }
+Navigator *ZoneManager::GetFocusedFXNavigator() { return surface_->GetPage()->GetFocusedFXNavigator(); }
+int ZoneManager::GetNumChannels() { return surface_->GetNumChannels(); }
+
+void ZoneManager::Initialize()
+{
+    double startTime = time_precise();
+    
+    if ( ! zoneDefinitions_->isPreProcessed)
+    {
+        zoneDefinitions_->isPreProcessed = true;
+        PreProcessZones();
+    }
+    
+    csi_->AddInitPhaseTime(InitPhase_PreProcessZones, startTime);
+
+    if ( ! zoneInfo_.Exists("Home"))
+    {
+        char tmp[MEDBUF];
+        snprintf(tmp, sizeof(tmp), __LOCALIZE_VERFMT("%s needs a Home Zone to operate, please recheck your installation", "csi_mbox"), surface_->GetName());
+        MessageBox(g_hwnd, tmp, __LOCALIZE("CSI Missing Home Zone", "csi_mbox"), MB_OK);
+        return;
+    }
+            
+    startTime = time_precise();
+    
+    LoadHomeAndGoZones();
+        
+    homeZone_->Activate();
+    
+    csi_->AddInitPhaseTime(InitPhase_LoadZones, startTime);
+}
+
+void ZoneManager::LoadHomeAndGoZones()
+{
+    unresolvedZoneNames_.DeleteAll();
+    
+    if (zoneInfo_.Exists("Home"))
+    {
+        homeZone_ = new Zone(csi_, this, GetSelectedTrackNavigator(), 0, "Home", "Home", zoneInfo_.Get("Home")->filePath);
+        LoadZoneFile(homeZone_, "");
+    }
+    
+    string_list zoneList;
+    if (zoneInfo_.Exists("GoZones"))
+        LoadZoneMetadata(zoneInfo_.Get("GoZones")->filePath.c_str(), zoneList);
+    LoadZones(goZones_, zoneList);
+    
+    if (zoneInfo_.Exists("FocusedFXParam"))
+    {
+        focusedFXParamZone_ = new Zone(csi_, this, GetFocusedFXNavigator(), 0, "FocusedFXParam", "FocusedFXParam", zoneInfo_.Get("FocusedFXParam")->filePath);
+        LoadZoneFile(focusedFXParamZone_, "");
+    }
+}
+
+void ZoneManager::ReloadHomeAndGoZones()
+{
+    // Included Zones and SubZones are owned by these, so an edit to any non FX .zon file lands here
+    bool isHomeActive = homeZone_ != NULL && homeZone_->GetIsActive();
+    bool isFocusedFXParamActive = focusedFXParamZone_ != NULL && focusedFXParamZone_->GetIsActive();
+    
+    string_list activeGoZones;
+    for (int i = 0; i < goZones_.size(); ++i)
+        if (goZones_[i]->GetIsActive())
+            activeGoZones.push_back(goZones_[i]->GetName());
+    
+    if (homeZone_ != NULL)
+    {
+        homeZone_->Deactivate();
+        zonesToBeDeleted_.Add(homeZone_);
+        homeZone_ = NULL;
+    }
+    
+    if (focusedFXParamZone_ != NULL)
+    {
+        focusedFXParamZone_->Deactivate();
+        zonesToBeDeleted_.Add(focusedFXParamZone_);
+        focusedFXParamZone_ = NULL;
+    }
+    
+    for (int i = 0; i < goZones_.size(); ++i)
+    {
+        goZones_[i]->Deactivate();
+        zonesToBeDeleted_.Add(goZones_[i]);
+    }
+    
+    goZones_.clear();
+    
+    LoadHomeAndGoZones();
     
-    listensToGoHome_ = false;
-    listensToSends_ = false;
-    listensToReceives_ = false;
-    listensToFocusedFX_ = false;
-    listensToFocusedFXParam_ = false;
-    listensToFXMenu_ = false;
-    listensToLocalFXSlot_ = false;
-    listensToSelectedTrackFX_ = false;
-
-    isFocusedFXParamMappingEnabled_ = false;
+    if (homeZone_ != NULL && isHomeActive)
+        homeZone_->Activate();
     
-    isFocusedFXMappingEnabled_ = true;
+    if (focusedFXParamZone_ != NULL && isFocusedFXParamActive)
+        focusedFXParamZone_->Activate();
     
-    trackSendOffset_ = 0;
-    trackReceiveOffset_ = 0;
-    trackFXMenuOffset_ = 0;
-    selectedTrackSendOffset_ = 0;
-    selectedTrackReceiveOffset_ = 0;
-    selectedTrackFXMenuOffset_ = 0;
-    masterTrackFXMenuOffset_ = 0;
+    for (int i = 0; i < goZones_.size(); ++i)
+        for (int j = 0; j < activeGoZones.size(); ++j)
+            if (!strcmp(goZones_[i]->GetName(), activeGoZones[j]))
+                goZones_[i]->Activate();
 }
 
-Navigator *ZoneManager::GetNavigatorForTrack(MediaTrack *track) { return surface_->GetPage()->GetNavigatorForTrack(track); }
-Navigator *ZoneManager::GetMasterTrackNavigator() { return surface_->GetPage()->GetMasterTrackNavigator(); }
-Navigator *ZoneManager::GetSelectedTrackNavigator() { return surface_->GetPage()->GetSelectedTrackNavigator(); }
-Navigator *ZoneManager::GetFocusedFXNavigator() { return surface_->GetPage()->GetFocusedFXNavigator(); }
-int ZoneManager::GetNumChannels() { return surface_->GetNumChannels(); }
-
-void ZoneManager::Initialize()
+static bool IsInFolder(const char *filePath, const string &folder)
 {
-    PreProcessZones();
+    return folder.size() > 0 && ! strncmp(filePath, folder.c_str(), folder.size()) && filePath[folder.size()] == '/';
+}
 
-    if ( ! zoneInfo_.Exists("Home"))
-    {
-        char tmp[MEDBUF];
-        snprintf(tmp, sizeof(tmp), __LOCALIZE_VERFMT("%s needs a Home Zone to operate, please recheck your installation", "csi_mbox"), surface_->GetName());
-        MessageBox(g_hwnd, tmp, __LOCALIZE("CSI Missing Home Zone", "csi_mbox"), MB_OK);
+void ZoneManager::ReloadZoneFile(const char *filePath, int reloadSerial)
+{
+    if ( ! IsInFolder(filePath, zoneFolder_) && ! IsInFolder(filePath, fxZoneFolder_))
         return;
+    
+    // Retire live FX Zones built from this file before the pool is purged, then rebuild them from the new definition
+    bool isFXZone = false;
+    
+    if (focusedFXZone_ != NULL && ! strcmp(focusedFXZone_->GetSourceFilePath(), filePath))
+    {
+        isFXZone = true;
+        ClearFocusedFX(); // CheckFocusedFXState brings it back on the next update
     }
-            
-    homeZone_ = new Zone(csi_, this, GetSelectedTrackNavigator(), 0, "Home", "Home", zoneInfo_.Get("Home")->filePath);
-    LoadZoneFile(homeZone_, "");
     
-    string_list zoneList;
-    if (zoneInfo_.Exists("GoZones"))
-        LoadZoneMetadata(zoneInfo_.Get("GoZones")->filePath.c_str(), zoneList);
-    LoadZones(goZones_, zoneList);
+    bool reloadSelectedTrackFX = false;
+    for (int i = 0; i < selectedTrackFXZones_.size(); ++i)
+        if ( ! strcmp(selectedTrackFXZones_[i]->GetSourceFilePath(), filePath))
+            reloadSelectedTrackFX = true;
     
-    if (zoneInfo_.Exists("FocusedFXParam"))
+    if (reloadSelectedTrackFX)
+        ClearSelectedTrackFX();
+    
+    Navigator *fxSlotNavigator = NULL;
+    int fxSlot = 0;
+    
+    if (fxSlotZone_ != NULL && ! strcmp(fxSlotZone_->GetSourceFilePath(), filePath))
     {
-        focusedFXParamZone_ = new Zone(csi_, this, GetFocusedFXNavigator(), 0, "FocusedFXParam", "FocusedFXParam", zoneInfo_.Get("FocusedFXParam")->filePath);
-        LoadZoneFile(focusedFXParamZone_, "");
+        fxSlotNavigator = fxSlotZone_->GetNavigator();
+        fxSlot = fxSlotZone_->GetSlotIndex();
+        RetireZone(fxSlotZone_);
+        fxSlotZone_ = NULL;
+    }
+    
+    if (zoneDefinitions_->reloadSerial != reloadSerial)
+    {
+        zoneDefinitions_->reloadSerial = reloadSerial;
+        InvalidateZoneFile(filePath);
+        PreProcessZoneFile(filePath);
+    }
+    else
+        DiscardPooledZones(filePath); // the shared definitions were already re-read for this change
+    
+    if (reloadSelectedTrackFX)
+    {
+        isFXZone = true;
+        GoSelectedTrackFX();
+    }
+    
+    if (fxSlotNavigator != NULL)
+    {
+        isFXZone = true;
+        if (MediaTrack *track = fxSlotNavigator->GetTrack())
+            GoFXSlot(track, fxSlotNavigator, fxSlot);
     }
+    
+    if ( ! isFXZone && IsInFolder(filePath, zoneFolder_) && IsHomeOrGoZoneFile(filePath))
+        ReloadHomeAndGoZones();
+}
+
+bool ZoneManager::IsHomeOrGoZoneFile(const char *filePath)
+{
+    // a file none of these load, directly or as an Included Zone or SubZone, cannot change them -- unless it now defines one they asked for
+    if (homeZone_ != NULL && homeZone_->UsesSourceFile(filePath))
+        return true;
+    
+    if (focusedFXParamZone_ != NULL && focusedFXParamZone_->UsesSourceFile(filePath))
+        return true;
+    
+    for (int i = 0; i < goZones_.size(); ++i)
+        if (goZones_[i]->UsesSourceFile(filePath))
+            return true;
+    
+    int index = 0;
+    const char *zoneName = NULL;
+    
+    while (CSIZoneInfo *info = zoneInfo_.Enumerate(index++, &zoneName))
+    {
+        if (strcmp(info->filePath.c_str(), filePath))
+            continue;
         
-    homeZone_->Activate();
+        if ( ! strcmp(zoneName, "Home") || ! strcmp(zoneName, "GoZones") || ! strcmp(zoneName, "FocusedFXParam") || unresolvedZoneNames_.Exists(zoneName))
+            return true;
+    }
+    
+    return false;
 }
 
 void ZoneManager::PreProcessZoneFile(const char *filePath)
@@ -2714,7 +3782,7 @@ void ZoneManager::PreProcessZoneFile(const char *filePath)
 
 static ModifierManager s_modifierManager(NULL);
 
-void ZoneManager::GetWidgetNameAndModifiers(const char *line, string &baseWidgetName, int &modifier, bool &isValueInverted, bool &isFeedbackInverted, double &holdDelayAmount, bool &isDecrease, bool &isIncrease)
+void ZoneManager::GetWidgetNameAndModifiers(const char *line, string &baseWidgetName, int &modifier, bool &isValueInverted, bool &isFeedbackInverted, bool &isHold, bool &isDecrease, bool &isIncrease)
 {
     string_list tokens;
     GetSubTokens(tokens, line, '+');
@@ -2735,7 +3803,7 @@ void ZoneManager::GetWidgetNameAndModifiers(const char *line, string &baseWidget
             else if (tokens[i] == "InvertFB")
                 isFeedbackInverted = true;
             else if (tokens[i] == "Hold")
-                holdDelayAmount = holdDelayAmount_;
+                isHold = true;
             else if (tokens[i] == "Decrease")
                 isDecrease = true;
             else if (tokens[i] == "Increase")
@@ -2827,6 +3895,8 @@ void ZoneManager::LoadZones(ptrvector<Zone *> &zones, string_list &zoneList)
                 }
             }
         }
+        else
+            unresolvedZoneNames_.Insert(zoneName, true);
     }
 }
 
@@ -2835,18 +3905,23 @@ void ZoneManager::LoadZoneFile(Zone *zone, const char *widgetSuffix)
     LoadZoneFile(zone, zone->GetSourceFilePath(), widgetSuffix);
 }
 
-void ZoneManager::LoadZoneFile(Zone *zone, const char *filePath, const char *widgetSuffix)
+CSIZoneTemplate *ZoneManager::GetZoneTemplate(const char *filePath)
 {
+    if (CSIZoneTemplate *zoneTemplate = zoneTemplates_.Get(filePath))
+        return zoneTemplate;
+    
     int lineNumber = 0;
-    bool isInIncludedZonesSection = false;
-    string_list includedZonesList;
-    bool isInSubZonesSection = false;
-    string_list subZonesList;
-
+    CSIZoneTemplate *zoneTemplate = NULL;
+    
     try
     {
         fpistream file(filePath);
         
+        if (file.handle == NULL)
+            return NULL;
+        
+        zoneTemplate = new CSIZoneTemplate();
+        
         for (string line; getline(file, line) ; )
         {
             TrimLine(line);
@@ -2859,11 +3934,87 @@ void ZoneManager::LoadZoneFile(Zone *zone, const char *filePath, const char *wid
             if (line == s_BeginAutoSection || line == s_EndAutoSection)
                 continue;
             
-            ReplaceAllWith(line, "|", widgetSuffix);
+            CSIZoneTemplateLine *templateLine = new CSIZoneTemplateLine();
+            zoneTemplate->lines.Add(templateLine);
             
-            string_list tokens;
+            string_list &tokens = templateLine->tokens;
             GetTokens(tokens, line.c_str());
             
+            templateLine->lineNumber = lineNumber;
+            templateLine->hasSuffix = line.find('|') != string::npos;
+            
+            if (tokens.size() > 1 && tokens[0] != "Zone")
+            {
+                GetWidgetNameAndModifiers(tokens[0], templateLine->widgetName, templateLine->modifier, templateLine->isValueInverted, templateLine->isFeedbackInverted,
+                                          templateLine->isHold, templateLine->isDecrease, templateLine->isIncrease);
+                
+                if (tokens[1].find("|") == string::npos)
+                    templateLine->action = csi_->GetAction(tokens[1]);
+                
+                for (int i = 1; i < tokens.size(); ++i)
+                    templateLine->memberParams.push_back(tokens[i]);
+            }
+        }
+        
+        zoneTemplates_.Insert(filePath, zoneTemplate);
+        
+        return zoneTemplate;
+    }
+    catch (const exception &)
+    {
+        delete zoneTemplate;
+        
+        char buffer[250];
+        snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", filePath, lineNumber);
+        ShowConsoleMsg(buffer);
+    }
+    
+    return NULL;
+}
+
+void ZoneManager::LoadZoneFile(Zone *zone, const char *filePath, const char *widgetSuffix)
+{
+    int lineNumber = 0;
+    bool isInIncludedZonesSection = false;
+    string_list includedZonesList;
+    bool isInSubZonesSection = false;
+    string_list subZonesList;
+
+    CSIZoneTemplate *zoneTemplate = GetZoneTemplate(filePath);
+    
+    if (zoneTemplate == NULL)
+        return;
+    
+    try
+    {
+        for (int l = 0; l < zoneTemplate->lines.GetSize(); ++l)
+        {
+            const CSIZoneTemplateLine *templateLine = zoneTemplate->lines.Get(l);
+            
+            lineNumber = templateLine->lineNumber;
+            
+            string_list suffixedTokens;
+            string_list suffixedMemberParams;
+            string suffixedWidgetName;
+            
+            if (templateLine->hasSuffix)
+            {
+                for (int i = 0; i < templateLine->tokens.size(); ++i)
+                {
+                    string token = templateLine->tokens[i].c_str();
+                    ReplaceAllWith(token, "|", widgetSuffix);
+                    suffixedTokens.push_back(token);
+                    
+                    if (i > 0)
+                        suffixedMemberParams.push_back(token);
+                }
+                
+                suffixedWidgetName = templateLine->widgetName;
+                ReplaceAllWith(suffixedWidgetName, "|", widgetSuffix);
+            }
+            
+            const string_list &tokens = templateLine->hasSuffix ? suffixedTokens : templateLine->tokens;
+            
             if (tokens[0] == "Zone" || tokens[0] == "ZoneEnd")
                 continue;
             
@@ -2889,15 +4040,7 @@ void ZoneManager::LoadZoneFile(Zone *zone, const char *filePath, const char *wid
             
             else if (tokens.size() > 1)
             {
-                string widgetName;
-                int modifier = 0;
-                bool isValueInverted = false;
-                bool isFeedbackInverted = false;
-                double holdDelayAmount = 0.0;
-                bool isDecrease = false;
-                bool isIncrease = false;
-                
-                GetWidgetNameAndModifiers(tokens[0], widgetName, modifier, isValueInverted, isFeedbackInverted, holdDelayAmount,isDecrease, isIncrease);
+                const string &widgetName = templateLine->hasSuffix ? suffixedWidgetName : templateLine->widgetName;
                 
                 Widget *widget = GetSurface()->GetWidgetByName(widgetName.c_str());
                                             
@@ -2906,42 +4049,40 @@ void ZoneManager::LoadZoneFile(Zone *zone, const char *filePath, const char *wid
 
                 zone->AddWidget(widget);
 
-                string_list memberParams;
-
-                for (int i = 1; i < tokens.size(); ++i)
-                    memberParams.push_back(tokens[i]);
-                
                 // For legacy .zon definitions
                 if (!strcmp(tokens[1], "NullDisplay"))
                     continue;
                 
-                ActionContext *context = csi_->GetActionContext(tokens[1], widget, zone, memberParams);
+                Action *action = templateLine->action != NULL ? templateLine->action : csi_->GetAction(tokens[1]);
+                const string_list &memberParams = templateLine->hasSuffix ? suffixedMemberParams : templateLine->memberParams;
+                
+                ActionContext *context = new ActionContext(csi_, action, widget, zone, 0, &memberParams, NULL);
                 
-                if (isValueInverted)
+                if (templateLine->isValueInverted)
                     context->SetIsValueInverted();
                 
-                if (isFeedbackInverted)
+                if (templateLine->isFeedbackInverted)
                     context->SetIsFeedbackInverted();
                 
-                if (holdDelayAmount != 0.0)
-                    context->SetHoldDelayAmount(holdDelayAmount);
+                if (templateLine->isHold && holdDelayAmount_ != 0.0)
+                    context->SetHoldDelayAmount(holdDelayAmount_);
                 
                 vector<double> range;
                 
-                if (isDecrease)
+                if (templateLine->isDecrease)
                 {
                     range.push_back(-2.0);
                     range.push_back(1.0);
                     context->SetRange(range);
                 }
-                else if (isIncrease)
+                else if (templateLine->isIncrease)
                 {
                     range.push_back(0.0);
                     range.push_back(2.0);
                     context->SetRange(range);
                 }
                 
-                zone->AddActionContext(widget, modifier, context);
+                zone->AddActionContext(widget, templateLine->modifier, context);
             }
         }
     }
@@ -2953,51 +4094,75 @@ void ZoneManager::LoadZoneFile(Zone *zone, const char *filePath, const char *wid
     }
 }
 
+static int s_listenerGeneration = 0; // bumped whenever a Broadcaster/Listener relationship changes, so broadcasters rebuild their subscriber lists
+
 void ZoneManager::AddListener(ControlSurface *surface)
 {
     if (WDL_NOT_NORMALLY(!surface)) { return; }
     listeners_.push_back(surface->GetZoneManager());
+    s_listenerGeneration++;
 }
 
 void ZoneManager::SetListenerCategories(PropertyList &pList)
 {
-    if (const char *property =  pList.get_prop(PropertyType_GoHome))
-        if (! strcmp(property, "Yes"))
-            listensToGoHome_ = true;
-    
-    if (const char *property =  pList.get_prop(PropertyType_SelectedTrackSends))
-        if (! strcmp(property, "Yes"))
-            listensToSends_ = true;
-    
-    if (const char *property =  pList.get_prop(PropertyType_SelectedTrackReceives))
-        if (! strcmp(property, "Yes"))
-            listensToReceives_ = true;
-    
-    if (const char *property =  pList.get_prop(PropertyType_FocusedFX))
-        if (! strcmp(property, "Yes"))
-            listensToFocusedFX_ = true;
-    
-    if (const char *property =  pList.get_prop(PropertyType_FocusedFXParam))
-        if (! strcmp(property, "Yes"))
-            listensToFocusedFXParam_ = true;
-    
-    if (const char *property =  pList.get_prop(PropertyType_FXMenu))
-        if (! strcmp(property, "Yes"))
-            listensToFXMenu_ = true;
+    static const struct { PropertyType property; ListenerCategory category; } s_categoryProperties[] =
+    {
+        { PropertyType_GoHome, ListenerCategory_GoHome },
+        { PropertyType_SelectedTrackSends, ListenerCategory_Sends },
+        { PropertyType_SelectedTrackReceives, ListenerCategory_Receives },
+        { PropertyType_FocusedFX, ListenerCategory_FocusedFX },
+        { PropertyType_FocusedFXParam, ListenerCategory_FocusedFXParam },
+        { PropertyType_FXMenu, ListenerCategory_FXMenu },
+        { PropertyType_LocalFXSlot, ListenerCategory_LocalFXSlot },
+        { PropertyType_SelectedTrackFX, ListenerCategory_SelectedTrackFX },
+    };
     
-    if (const char *property =  pList.get_prop(PropertyType_LocalFXSlot))
-        if (! strcmp(property, "Yes"))
-            listensToLocalFXSlot_ = true;
+    for (int i = 0; i < (int)(sizeof(s_categoryProperties) / sizeof(s_categoryProperties[0])); ++i)
+        if (const char *property =  pList.get_prop(s_categoryProperties[i].property))
+            if (! strcmp(property, "Yes"))
+                listenerCategories_ |= 1 << s_categoryProperties[i].category;
     
-    if (const char *property =  pList.get_prop(PropertyType_SelectedTrackFX))
-        if (! strcmp(property, "Yes"))
-            listensToSelectedTrackFX_ = true;
+    s_listenerGeneration++;
     
     if (const char *property =  pList.get_prop(PropertyType_Modifiers))
         if (! strcmp(property, "Yes"))
             surface_->SetListensToModifiers();;
 }
 
+void ZoneManager::RefreshSubscribers()
+{
+    if (subscribersGeneration_ == s_listenerGeneration)
+        return;
+    
+    subscribersGeneration_ = s_listenerGeneration;
+    
+    for (int c = 0; c < NumListenerCategories; ++c)
+    {
+        subscribers_[c].Empty();
+        goZoneTargets_[c].Empty();
+        clearFXZoneTargets_[c].Empty();
+        
+        for (int i = 0; i < listeners_.size(); ++i)
+        {
+            ZoneManager *listener = listeners_[i];
+            
+            if (listener->GetListensTo((ListenerCategory)c))
+            {
+                subscribers_[c].Add(listener);
+                
+                // a listener in the category relays GoZone and ClearFXZone on to its own listeners
+                for (int j = 0; j < listener->listeners_.size(); ++j)
+                {
+                    goZoneTargets_[c].Add(listener->listeners_[j]);
+                    clearFXZoneTargets_[c].Add(listener->listeners_[j]);
+                }
+            }
+            else
+                goZoneTargets_[c].Add(listener);
+        }
+    }
+}
+
 void ZoneManager::CheckFocusedFXState()
 {
     int trackNumber = 0;
@@ -3046,16 +4211,28 @@ void ZoneManager::CheckFocusedFXState()
         
         if (zoneInfo_.Exists(fxName))
         {
-            focusedFXZone_ = new Zone(csi_, this, GetFocusedFXNavigator(), fxSlot, fxName, zoneInfo_.Get(fxName)->alias, zoneInfo_.Get(fxName)->filePath.c_str());
-            LoadZoneFile(focusedFXZone_, "");
+            focusedFXZone_ = GetFXZone(fxName, GetFocusedFXNavigator(), fxSlot);
             focusedFXZone_->Activate();
         }            
     }
 }
 
+Zone *ZoneManager::GetFXZone(const char *fxName, Navigator *navigator, int fxSlot)
+{
+    Zone *zone = GetPooledZone(fxName, navigator, fxSlot);
+    
+    if (zone == NULL)
+    {
+        zone = new Zone(csi_, this, navigator, fxSlot, fxName, zoneInfo_.Get(fxName)->alias, zoneInfo_.Get(fxName)->filePath);
+        LoadZoneFile(zone, "");
+    }
+    
+    return zone;
+}
+
 void ZoneManager::GoSelectedTrackFX()
 {
-    selectedTrackFXZones_.clear();
+    ClearSelectedTrackFX();
     
     if (MediaTrack *selectedTrack = surface_->GetPage()->GetSelectedTrack())
     {
@@ -3067,8 +4244,7 @@ void ZoneManager::GoSelectedTrackFX()
             
             if (zoneInfo_.Exists(fxName))
             {
-                Zone *zone = new Zone(csi_, this, GetSelectedTrackNavigator(), i, fxName, zoneInfo_.Get(fxName)->alias, zoneInfo_.Get(fxName)->filePath);
-                LoadZoneFile(zone, "");
+                Zone *zone = GetFXZone(fxName, GetSelectedTrackNavigator(), i);
                 selectedTrackFXZones_.push_back(zone);
                 zone->Activate();
             }
@@ -3088,8 +4264,7 @@ void ZoneManager::GoFXSlot(MediaTrack *track, Navigator *navigator, int fxSlot)
     if (zoneInfo_.Exists(fxName))
     {
         ClearFXSlot();        
-        fxSlotZone_ = new Zone(csi_, this, navigator, fxSlot, fxName, zoneInfo_.Get(fxName)->alias, zoneInfo_.Get(fxName)->filePath);
-        LoadZoneFile(fxSlotZone_, "");
+        fxSlotZone_ = GetFXZone(fxName, navigator, fxSlot);
         fxSlotZone_->Activate();
     }
     else
@@ -3097,7 +4272,32 @@ void ZoneManager::GoFXSlot(MediaTrack *track, Navigator *navigator, int fxSlot)
 }
 
 void ZoneManager::UpdateCurrentActionContextModifiers()
-{  
+{
+    // Only reconfigure when some widget actually resolves to a different modifier -- holding a modifier no Zone maps costs nothing
+    bool changed = false;
+    
+    if (learnFocusedFXZone_ != NULL && learnFocusedFXZone_->ResolveCurrentActionContextModifiers())
+        changed = true;
+
+    if (focusedFXParamZone_ != NULL && focusedFXParamZone_->ResolveCurrentActionContextModifiers())
+        changed = true;
+    
+    if (focusedFXZone_ != NULL && focusedFXZone_->ResolveCurrentActionContextModifiers())
+        changed = true;
+    
+    for (int i = 0; i < selectedTrackFXZones_.size(); ++i)
+        if (selectedTrackFXZones_[i]->ResolveCurrentActionContextModifiers())
+            changed = true;
+    
+    if (fxSlotZone_ != NULL && fxSlotZone_->ResolveCurrentActionContextModifiers())
+        changed = true;
+    
+    if (homeZone_ != NULL && homeZone_->ResolveCurrentActionContextModifiers())
+        changed = true;
+    
+    if ( ! changed)
+        return;
+    
     if (learnFocusedFXZone_ != NULL)
         learnFocusedFXZone_->UpdateCurrentActionContextModifiers();
 
@@ -3155,13 +4355,12 @@ void ZoneManager::DoAction(Widget *widget, double value)
     
     DoAction(widget, value, isUsed);
     
-    zonesToBeDeleted_.Empty(true);
+    ReclaimZones();
 }
     
 void ZoneManager::DoAction(Widget *widget, double value, bool &isUsed)
 {
-    if (surface_->GetModifiers().GetSize() > 0)
-        WidgetMoved(this, widget, surface_->GetModifiers().Get()[0]);
+    WidgetMoved(this, widget, surface_->GetEngagedModifiers());
     
     if (learnFocusedFXZone_ != NULL)
         learnFocusedFXZone_->DoAction(widget, isUsed, value);
@@ -3212,13 +4411,12 @@ void ZoneManager::DoRelativeAction(Widget *widget, double delta)
     
     DoRelativeAction(widget, delta, isUsed);
     
-    zonesToBeDeleted_.Empty(true);
+    ReclaimZones();
 }
 
 void ZoneManager::DoRelativeAction(Widget *widget, double delta, bool &isUsed)
 {
-    if (surface_->GetModifiers().GetSize() > 0)
-        WidgetMoved(this, widget, surface_->GetModifiers().Get()[0]);
+    WidgetMoved(this, widget, surface_->GetEngagedModifiers());
 
     if (learnFocusedFXZone_ != NULL)
         learnFocusedFXZone_->DoRelativeAction(widget, isUsed, delta);
@@ -3269,13 +4467,12 @@ void ZoneManager::DoRelativeAction(Widget *widget, int accelerationIndex, double
     
     DoRelativeAction(widget, accelerationIndex, delta, isUsed);
     
-    zonesToBeDeleted_.Empty(true);
+    ReclaimZones();
 }
 
 void ZoneManager::DoRelativeAction(Widget *widget, int accelerationIndex, double delta, bool &isUsed)
 {
-    if (surface_->GetModifiers().GetSize() > 0)
-        WidgetMoved(this, widget, surface_->GetModifiers().Get()[0]);
+    WidgetMoved(this, widget, surface_->GetEngagedModifiers());
 
     if (learnFocusedFXZone_ != NULL)
         learnFocusedFXZone_->DoRelativeAction(widget, isUsed, accelerationIndex, delta);
@@ -3326,7 +4523,7 @@ void ZoneManager::DoTouch(Widget *widget, double value)
     
     DoTouch(widget, value, isUsed);
     
-    zonesToBeDeleted_.Empty(true);
+    ReclaimZones();
 }
 
 void ZoneManager::DoTouch(Widget *widget, double value, bool &isUsed)
@@ -3334,8 +4531,8 @@ void ZoneManager::DoTouch(Widget *widget, double value, bool &isUsed)
     surface_->TouchChannel(widget->GetChannelNumber(), value != 0);
        
     // GAW -- temporary
-    //if (surface_->GetModifiers().GetSize() > 0 && value != 0.0) // ignore touch releases for Learn mode
-        //WidgetMoved(this, widget, surface_->GetModifiers().Get()[0]);
+    //if (value != 0.0) // ignore touch releases for Learn mode
+        //WidgetMoved(this, widget, surface_->GetEngagedModifiers());
 
     //if (learnFocusedFXZone_ != NULL)
         //learnFocusedFXZone_->DoTouch(widget, widget->GetName(), isUsed, value);
@@ -3385,21 +4582,13 @@ void ModifierManager::RecalculateModifiers()
     if (surface_ == NULL && page_ == NULL)
         return;
     
-    if (modifierCombinations_.ResizeOK(1,false))
-      modifierCombinations_.Get()[0] =0 ;
-           
-    Modifiers activeModifierIndices[MaxModifiers];
-    int activeModifierIndices_cnt = 0;
+    engagedModifiers_ = 0;
     
     for (int i = 0; i < MaxModifiers; ++i)
         if (modifiers_[i].isEngaged)
-            activeModifierIndices[activeModifierIndices_cnt++] = (Modifiers)i;
+            engagedModifiers_ |= maskFromModifier((Modifiers)i);
     
-    if (activeModifierIndices_cnt>0)
-    {
-        GetCombinations(activeModifierIndices,activeModifierIndices_cnt, modifierCombinations_);
-        qsort(modifierCombinations_.Get(), modifierCombinations_.GetSize(), sizeof(modifierCombinations_.Get()[0]), intcmp_rev);
-    }
+    modifierCombinationsDirty_ = true;
     
     if (surface_ != NULL)
         surface_->GetZoneManager()->UpdateCurrentActionContextModifiers();
@@ -3407,6 +4596,32 @@ void ModifierManager::RecalculateModifiers()
         page_->UpdateCurrentActionContextModifiers();
 }
 
+const WDL_TypedBuf<int> &ModifierManager::GetModifiers()
+{
+    if (modifierCombinationsDirty_)
+    {
+        modifierCombinationsDirty_ = false;
+        
+        if (modifierCombinations_.ResizeOK(1,false))
+          modifierCombinations_.Get()[0] =0 ;
+               
+        Modifiers activeModifierIndices[MaxModifiers];
+        int activeModifierIndices_cnt = 0;
+        
+        for (int i = 0; i < MaxModifiers; ++i)
+            if (engagedModifiers_ & maskFromModifier((Modifiers)i))
+                activeModifierIndices[activeModifierIndices_cnt++] = (Modifiers)i;
+        
+        if (activeModifierIndices_cnt>0)
+        {
+            GetCombinations(activeModifierIndices,activeModifierIndices_cnt, modifierCombinations_);
+            qsort(modifierCombinations_.Get(), modifierCombinations_.GetSize(), sizeof(modifierCombinations_.Get()[0]), intcmp_rev);
+        }
+    }
+    
+    return modifierCombinations_;
+}
+
 void ModifierManager::SetLatchModifier(bool value, Modifiers modifier, int latchTime)
 {
     if (value && modifiers_[modifier].isEngaged == false)
@@ -3427,17 +4642,168 @@ void ModifierManager::SetLatchModifier(bool value, Modifiers modifier, int latch
                 csi_->Speak(tmp);
             }
 
-            modifiers_[modifier].isEngaged = value;
-        }
-        else
-        {
-            char tmp[256];
-            snprintf(tmp, sizeof(tmp), "%s Lock", stringFromModifier(modifier));
-            csi_->Speak(tmp);
-        }
+            modifiers_[modifier].isEngaged = value;
+        }
+        else
+        {
+            char tmp[256];
+            snprintf(tmp, sizeof(tmp), "%s Lock", stringFromModifier(modifier));
+            csi_->Speak(tmp);
+        }
+    }
+    
+    RecalculateModifiers();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Page
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+void Page::ResetRunTimes()
+{
+    for (int i = 0; i < RunPhase_Count; ++i)
+        runPhaseTimes_[i] = 0.0;
+    
+    runMaxTickTime_ = 0.0;
+    runWindowStartTime_ = 0.0;
+    runTicks_ = 0;
+}
+
+void Page::Run()
+{
+    if (g_timingDisplay != isRunTimed_)
+    {
+        isRunTimed_ = g_timingDisplay;
+        ResetRunTimes(); // nothing from an earlier timed stretch leaks into the first report
+        csi_->ClearFeedbackLatencies();
+    }
+    
+    double tickStartTime = g_timingDisplay ? time_precise() : 0.0;
+    double startTime = tickStartTime;
+    
+    trackNavigationManager_->RebuildTracks();
+    AddRunPhaseTime(RunPhase_RebuildTracks, startTime);
+    
+    trackNavigationManager_->RebuildVCASpill();
+    AddRunPhaseTime(RunPhase_VCASpill, startTime);
+    
+    trackNavigationManager_->RebuildFolderTracks();
+    AddRunPhaseTime(RunPhase_FolderTracks, startTime);
+    
+    trackNavigationManager_->RebuildSelectedTracks();
+    AddRunPhaseTime(RunPhase_SelectedTracks, startTime);
+    
+    for (int i = 0; i < surfaces_.GetSize(); ++i)
+        surfaces_.Get(i)->HandleExternalInput();
+    
+    csi_->FlushFXParamWrites();
+    AddRunPhaseTime(RunPhase_HandleExternalInput, startTime);
+    
+    for (int i = 0; i < surfaces_.GetSize(); ++i)
+        surfaces_.Get(i)->RequestUpdate();
+    AddRunPhaseTime(RunPhase_RequestUpdate, startTime);
+    
+    if (g_timingDisplay)
+        EndRunTick(tickStartTime);
+}
+
+void Page::EndRunTick(double tickStartTime)
+{
+    double now = time_precise();
+    
+    if (runTicks_ == 0)
+        runWindowStartTime_ = tickStartTime;
+    
+    if (now - tickStartTime > runMaxTickTime_)
+        runMaxTickTime_ = now - tickStartTime;
+    
+    runTicks_++;
+    
+    if (now - runWindowStartTime_ < 5.0)
+        return;
+    
+    double total = 0.0;
+    for (int i = 0; i < RunPhase_Count; ++i)
+        total += runPhaseTimes_[i];
+    
+    double msPerTick = 1000.0 / runTicks_;
+    
+    char buffer[MEDBUF];
+    snprintf(buffer, sizeof(buffer), "CSI Run \"%s\": %d tracks (%d visible, %d selected), %d channels, %d ticks -- tracks %.3f ms, VCA %.3f ms, folders %.3f ms, selected %.3f ms, input %.3f ms, update %.3f ms, avg %.3f ms, max %.3f ms per tick\n",
+             name_.c_str(),
+             trackNavigationManager_->GetNumTracks(),
+             trackNavigationManager_->GetNumVisibleTracks(),
+             CountSelectedTracks2(NULL, false),
+             trackNavigationManager_->GetNumTrackNavigators(),
+             runTicks_,
+             runPhaseTimes_[RunPhase_RebuildTracks] * msPerTick,
+             runPhaseTimes_[RunPhase_VCASpill] * msPerTick,
+             runPhaseTimes_[RunPhase_FolderTracks] * msPerTick,
+             runPhaseTimes_[RunPhase_SelectedTracks] * msPerTick,
+             runPhaseTimes_[RunPhase_HandleExternalInput] * msPerTick,
+             runPhaseTimes_[RunPhase_RequestUpdate] * msPerTick,
+             total * msPerTick,
+             runMaxTickTime_ * 1000.0);
+    ShowConsoleMsg(buffer);
+    
+    csi_->ReportFeedbackLatencies();
+    
+    ResetRunTimes();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Feedback latency tracing
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const int s_maxLatencySamples = 4096; // per surface, widget type and feedback processor, per report window
+
+void CSurfIntegrator::AddFeedbackLatency(const char *surfaceName, const char *widgetType, const char *feedbackProcessorName, double latency)
+{
+    char key[MEDBUF];
+    snprintf(key, sizeof(key), "%s %s via %s", surfaceName, widgetType, feedbackProcessorName);
+    
+    WDL_TypedBuf<double> *latencies = feedbackLatencies_.Get(key);
+    
+    if (latencies == NULL)
+    {
+        latencies = new WDL_TypedBuf<double>;
+        feedbackLatencies_.Insert(key, latencies);
+    }
+    
+    if (latencies->GetSize() < s_maxLatencySamples)
+        latencies->Add(latency);
+}
+
+static int compareLatencies(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+void CSurfIntegrator::ReportFeedbackLatencies()
+{
+    for (int i = 0; i < feedbackLatencies_.GetSize(); ++i)
+    {
+        const char *key = NULL;
+        WDL_TypedBuf<double> *latencies = feedbackLatencies_.Enumerate(i, &key);
+        
+        if (latencies == NULL || latencies->GetSize() == 0)
+            continue;
+        
+        double *samples = latencies->Get();
+        int count = latencies->GetSize();
+        qsort(samples, count, sizeof(double), compareLatencies);
+        
+        char buffer[MEDBUF];
+        snprintf(buffer, sizeof(buffer), "CSI feedback latency %s: %d inputs -- min %.3f ms, median %.3f ms, 95%% %.3f ms, max %.3f ms\n",
+                 key,
+                 count,
+                 samples[0] * 1000.0,
+                 samples[count / 2] * 1000.0,
+                 samples[(count * 95) / 100] * 1000.0,
+                 samples[count - 1] * 1000.0);
+        ShowConsoleMsg(buffer);
     }
     
-    RecalculateModifiers();
+    feedbackLatencies_.DeleteAll();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3445,13 +4811,31 @@ void ModifierManager::SetLatchModifier(bool value, Modifiers modifier, int latch
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void TrackNavigationManager::RebuildTracks()
 {
+    InvalidateChannelTracks();
+    
     int oldTracksSize = tracks_.GetSize();
     
     tracks_.Empty();
     
-    for (int i = 1; i <= GetNumTracks(); ++i)
+    int numTracks = GetNumTracks();
+    
+    if (allTracks_.GetSize() != numTracks)
+    {
+        allTracks_.Resize(numTracks, false);
+        trackIdsValid_ = false;
+    }
+    
+    for (int i = 1; i <= numTracks; ++i)
     {
-        if (MediaTrack *track = CSurf_TrackFromID(i, followMCP_))
+        MediaTrack *track = CSurf_TrackFromID(i, followMCP_);
+        
+        if (allTracks_.GetSize() == numTracks && allTracks_.Get()[i - 1] != track)
+        {
+            allTracks_.Get()[i - 1] = track;
+            trackIdsValid_ = false;
+        }
+        
+        if (track != NULL)
             if (IsTrackVisible(track, followMCP_))
                 tracks_.Add(track);
     }
@@ -3466,17 +4850,49 @@ void TrackNavigationManager::RebuildTracks()
         page_->ForceUpdateTrackColors();
 }
 
+bool TrackNavigationManager::RefreshSelectedTracks()
+{
+    // Rebuilds in place, reusing the list's storage, and reports whether the selection actually changed
+    int numSelected = CountSelectedTracks2(NULL, false);
+    
+    bool changed = numSelected != selectedTracks_.GetSize();
+    
+    for (int i = 0; i < numSelected; ++i)
+    {
+        MediaTrack *track = DAW::GetSelectedTrack(i);
+        
+        if (i < selectedTracks_.GetSize())
+        {
+            if (selectedTracks_.Get(i) != track)
+            {
+                selectedTracks_.Set(i, track);
+                changed = true;
+            }
+        }
+        else
+            selectedTracks_.Add(track);
+    }
+    
+    while (selectedTracks_.GetSize() > numSelected)
+        selectedTracks_.Delete(selectedTracks_.GetSize() - 1);
+    
+    selectedTracksValid_ = true;
+    
+    return changed;
+}
+
 void TrackNavigationManager::RebuildSelectedTracks()
 {
+    // Once per tick -- GetSelectedTracks() callers during the tick share this snapshot
+    selectedTracksValid_ = false;
+    
     if (currentTrackVCAFolderMode_ != 3)
         return;
 
     int oldTracksSize = selectedTracks_.GetSize();
     
-    selectedTracks_.Empty();
-    
-    for (int i = 0; i < CountSelectedTracks2(NULL, false); ++i)
-        selectedTracks_.Add(DAW::GetSelectedTrack(i));
+    if (RefreshSelectedTracks())
+        InvalidateChannelTracks();
 
     if (selectedTracks_.GetSize() < oldTracksSize)
     {
@@ -3488,6 +4904,75 @@ void TrackNavigationManager::RebuildSelectedTracks()
         page_->ForceUpdateTrackColors();
 }
 
+MediaTrack *TrackNavigationManager::ResolveTrackFromChannel(int channelNumber)
+{
+    if (currentTrackVCAFolderMode_ == 0)
+    {
+        if (channelNumber + trackOffset_ < GetNumTracks() && channelNumber + trackOffset_ < tracks_.GetSize())
+            return tracks_.Get(channelNumber + trackOffset_);
+        else
+            return NULL;
+    }
+    else if (currentTrackVCAFolderMode_ == 1)
+    {
+        // RebuildVCASpill has already validated these, see there
+        if (vcaLeadTrack_ == NULL)
+        {
+            if (channelNumber < vcaTopLeadTracks_.GetSize())
+                return vcaTopLeadTracks_.Get(channelNumber);
+            else
+                return NULL;
+        }
+        else
+        {
+            if (channelNumber == 0 && vcaSpillTracks_.GetSize() > 0)
+                return vcaSpillTracks_.Get(channelNumber);
+            else if (vcaTrackOffset_ == 0 && channelNumber < vcaSpillTracks_.GetSize())
+                return vcaSpillTracks_.Get(channelNumber);
+            else
+            {
+                channelNumber += vcaTrackOffset_;
+                
+                if (channelNumber < vcaSpillTracks_.GetSize())
+                    return vcaSpillTracks_.Get(channelNumber);
+            }
+        }
+    }
+    else if (currentTrackVCAFolderMode_ == 2)
+    {
+        if (folderParentTrack_ == NULL)
+        {
+            if (channelNumber < folderTopParentTracks_.GetSize() && DAW::ValidateTrackPtr(folderTopParentTracks_.Get(channelNumber)))
+                return folderTopParentTracks_.Get(channelNumber);
+            else
+                return NULL;
+        }
+        else
+        {
+            if (channelNumber == 0 && folderSpillTracks_.GetSize() > 0 && DAW::ValidateTrackPtr(folderSpillTracks_.Get(channelNumber)))
+                return folderSpillTracks_.Get(channelNumber);
+            else if (folderTrackOffset_ == 0 && channelNumber < folderSpillTracks_.GetSize() && DAW::ValidateTrackPtr(folderSpillTracks_.Get(channelNumber)))
+                return folderSpillTracks_.Get(channelNumber);
+            else
+            {
+                channelNumber += folderTrackOffset_;
+                
+                if (channelNumber < folderSpillTracks_.GetSize() && DAW::ValidateTrackPtr(folderSpillTracks_.Get(channelNumber)))
+                    return folderSpillTracks_.Get(channelNumber);
+            }
+        }
+    }
+    else if (currentTrackVCAFolderMode_ == 3)
+    {
+        if (channelNumber + selectedTracksOffset_ >= selectedTracks_.GetSize())
+            return NULL;
+        else
+            return selectedTracks_.Get(channelNumber + selectedTracksOffset_);
+    }
+    
+    return NULL;
+}
+
 void TrackNavigationManager::AdjustSelectedTrackBank(int amount)
 {
     if (MediaTrack *selectedTrack = GetSelectedTrack())
@@ -3561,8 +5046,74 @@ void ControlSurface::ForceClearTrack(int trackNum)
             widgets_.Get(i)->ForceClear();
 }
 
+bool ControlSurface::RefreshTrackColors()
+{
+    bool changed = false;
+    
+    if (trackColors_.GetSize() != numChannels_)
+    {
+        colorTracks_.Resize(numChannels_, false);
+        nativeTrackColors_.Resize(numChannels_, false);
+        trackColors_.Resize(numChannels_, false);
+        
+        if (trackColors_.GetSize() != numChannels_)
+            return true;
+        
+        for (int i = 0; i < numChannels_; ++i)
+        {
+            colorTracks_.Get()[i] = NULL;
+            nativeTrackColors_.Get()[i] = 0;
+            trackColors_.Get()[i] = DAW::GetTrackColorFromNative(0);
+        }
+        
+        changed = true;
+    }
+    
+    for (int i = 0; i < numChannels_; ++i)
+    {
+        MediaTrack *track = page_->GetNavigatorForChannel(i + channelOffset_)->GetTrack();
+        
+        if (track != colorTracks_.Get()[i])
+        {
+            colorTracks_.Get()[i] = track;
+            
+            if (track == NULL)
+            {
+                nativeTrackColors_.Get()[i] = 0;
+                trackColors_.Get()[i].r = trackColors_.Get()[i].g = trackColors_.Get()[i].b = 255;
+            }
+            else
+            {
+                nativeTrackColors_.Get()[i] = DAW::GetNativeTrackColor(track);
+                trackColors_.Get()[i] = DAW::GetTrackColorFromNative(nativeTrackColors_.Get()[i]);
+            }
+            
+            changed = true;
+        }
+        else if (track != NULL)
+        {
+            // validated when the channel first showed this track, and the navigator would have moved off it had it been deleted
+            int nativeColor = ::GetTrackColor(track);
+            
+            if (nativeColor != nativeTrackColors_.Get()[i])
+            {
+                nativeTrackColors_.Get()[i] = nativeColor;
+                trackColors_.Get()[i] = DAW::GetTrackColorFromNative(nativeColor);
+                changed = true;
+            }
+        }
+    }
+    
+    return changed;
+}
+
 void ControlSurface::ForceUpdateTrackColors()
 {
+    if (trackColorFeedbackProcessors_.GetSize() == 0)
+        return;
+    
+    RefreshTrackColors();
+    
     for (int i = 0; i < trackColorFeedbackProcessors_.GetSize(); ++i)
         trackColorFeedbackProcessors_.Get(i)->ForceUpdateTrackColors();
 }
@@ -3577,6 +5128,9 @@ rgba_color ControlSurface::GetTrackColorForChannel(int channel)
     if (channel < 0 || channel >= numChannels_)
         return white;
     
+    if (trackColors_.GetSize() == numChannels_)
+        return trackColors_.Get()[channel];
+    
     if (MediaTrack *track = page_->GetNavigatorForChannel(channel + channelOffset_)->GetTrack())
         return DAW::GetTrackColor(track);
     else
@@ -3585,8 +5139,9 @@ rgba_color ControlSurface::GetTrackColorForChannel(int channel)
 
 void ControlSurface::RequestUpdate()
 {
-    for (int i = 0; i < trackColorFeedbackProcessors_.GetSize(); ++i)
-        trackColorFeedbackProcessors_.Get(i)->UpdateTrackColors();
+    if (trackColorFeedbackProcessors_.GetSize() > 0 && RefreshTrackColors())
+        for (int i = 0; i < trackColorFeedbackProcessors_.GetSize(); ++i)
+            trackColorFeedbackProcessors_.Get(i)->UpdateTrackColors();
     
     for (int i = 0; i < widgets_.GetSize(); ++i)
         widgets_.Get(i)->ClearHasBeenUsedByUpdate();
@@ -3912,6 +5467,14 @@ const WDL_TypedBuf<int> &ControlSurface::GetModifiers()
         return page_->GetModifierManager()->GetModifiers();
 }
 
+int ControlSurface::GetEngagedModifiers()
+{
+    if (usesLocalModifiers_ || listensToModifiers_)
+        return modifierManager_->GetEngagedModifiers();
+    else
+        return page_->GetModifierManager()->GetEngagedModifiers();
+}
+
 void ControlSurface::ClearModifier(const char *modifier)
 {
     if (zoneManager_->GetIsBroadcaster() && usesLocalModifiers_)
@@ -3951,13 +5514,200 @@ void Midi_ControlSurfaceIO::HandleExternalInput(Midi_ControlSurface *surface)
 {
     if (midiInput_)
     {
-        midiInput_->SwapBufsPrecise(GetTickCount(), GetTickCount());
+        const double swapTime = time_precise();
+        midiInput_->SwapBufsPrecise(GetTickCount(), swapTime);
         MIDI_eventlist *list = midiInput_->GetReadBuf();
         int bpos = 0;
         MIDI_event_t *evt;
         while ((evt = list->EnumItems(&bpos)))
+        {
+            // frame offsets are 1/1024000 s since the previous swap, not sample frames
+            double arrivalTime = lastSwapTime_ > 0.0 ? lastSwapTime_ + evt->frame_offset / 1024000.0 : swapTime;
+            if (arrivalTime > swapTime)
+                arrivalTime = swapTime;
+            
+            trafficLog_.Record(false, evt->midi_message, evt->size, arrivalTime);
+            
+            if (g_timingDisplay)
+                surface->SetInputTime(arrivalTime);
+            
             surface->ProcessMidiMessage((MIDI_event_ex_t*)evt);
+        }
+        
+        lastSwapTime_ = swapTime;
+    }
+    
+    const unsigned char *replayed;
+    int replayedSize;
+    while (trafficLog_.GetNextReplayed(replayed, replayedSize))
+        InjectMidiMessage(replayed, replayedSize);
+    
+    while (injectedMessages_.Available() >= (int)sizeof(int))
+    {
+        int msg_len;
+        memcpy(&msg_len, injectedMessages_.Get(), sizeof(int));
+        if (WDL_NOT_NORMALLY(injectedMessages_.Available() < (int)sizeof(int) + msg_len)) // not enough data in queue, should not happen
+            break;
+        
+        MIDI_event_ex_t *evt = (MIDI_event_ex_t *)injectedMessage_.ResizeOK(sizeof(MIDI_event_ex_t) + msg_len, false);
+        if (evt == NULL)
+        {
+            injectedMessages_.Advance(sizeof(int) + msg_len);
+            continue;
+        }
+        
+        evt->frame_offset = 0;
+        evt->size = msg_len;
+        memset(evt->midi_message, 0, 3);
+        memcpy(evt->midi_message, (const unsigned char *)injectedMessages_.Get() + sizeof(int), msg_len);
+        injectedMessages_.Advance(sizeof(int) + msg_len);
+        
+        if (g_timingDisplay)
+            surface->SetInputTime(time_precise());
+        
+        surface->ProcessMidiMessage(evt);
+    }
+    
+    injectedMessages_.Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CSITrafficLog
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const char s_trafficLogTag[4] = { 'C', 'S', 'I', 'T' };
+static const int s_trafficLogVersion = 1;
+
+static string GetTrafficLogPath(const string &name)
+{
+    string fileName(name);
+    ReplaceAllWith(fileName, s_BadFileChars, "_");
+    
+    return string(GetResourcePath()) + "/CSI/Traffic/" + fileName + ".csitraffic";
+}
+
+void CSITrafficLog::Write(bool isOutput, const void *data, int size, double eventTime)
+{
+    if ( ! g_recordSurfaceTraffic)
+    {
+        Stop();
+        return;
+    }
+    
+    if (file_ == NULL)
+    {
+        RecursiveCreateDirectory((string(GetResourcePath()) + "/CSI/Traffic").c_str(), 0);
+        
+        file_ = fopenUTF8(GetTrafficLogPath(name_).c_str(), "wb");
+        
+        if (file_ == NULL)
+            return;
+        
+        fwrite(s_trafficLogTag, 1, sizeof(s_trafficLogTag), file_);
+        fwrite(&s_trafficLogVersion, sizeof(int), 1, file_);
+        startTime_ = eventTime;
+    }
+    
+    double time = eventTime > startTime_ ? eventTime - startTime_ : 0.0;
+    char direction = isOutput ? 1 : 0;
+    
+    fwrite(&time, sizeof(double), 1, file_);
+    fwrite(&direction, 1, 1, file_);
+    fwrite(&size, sizeof(int), 1, file_);
+    fwrite(data, 1, size, file_);
+}
+
+void CSITrafficLog::Stop()
+{
+    if (file_ != NULL)
+    {
+        fclose(file_);
+        file_ = NULL;
+    }
+}
+
+bool CSITrafficLog::StartReplay(const char *filePath, bool isRealTime)
+{
+    string path = (filePath != NULL && filePath[0] != 0) ? string(filePath) : GetTrafficLogPath(name_);
+    
+    FILE *file = fopenUTF8(path.c_str(), "rb");
+    
+    if (file == NULL)
+        return false;
+    
+    char tag[sizeof(s_trafficLogTag)];
+    int version = 0;
+    
+    if (fread(tag, 1, sizeof(tag), file) != sizeof(tag) || memcmp(tag, s_trafficLogTag, sizeof(tag)) ||
+        fread(&version, sizeof(int), 1, file) != 1 || version != s_trafficLogVersion)
+    {
+        fclose(file);
+        return false;
+    }
+    
+    // keep the input records only, as time, size and bytes
+    WDL_TypedBuf<unsigned char> records;
+    double firstTime = -1.0;
+    
+    for (;;)
+    {
+        double time;
+        char direction;
+        int size;
+        
+        if (fread(&time, sizeof(double), 1, file) != 1 || fread(&direction, 1, 1, file) != 1 || fread(&size, sizeof(int), 1, file) != 1 || size < 0 || size > 65536)
+            break;
+        
+        int pos = records.GetSize();
+        unsigned char *rec = records.ResizeOK(pos + sizeof(double) + sizeof(int) + size);
+        if (rec == NULL || (int)fread(rec + pos + sizeof(double) + sizeof(int), 1, size, file) != size)
+        {
+            records.Resize(pos);
+            break;
+        }
+        
+        if (direction != 0)
+        {
+            records.Resize(pos);
+            continue;
+        }
+        
+        if (firstTime < 0.0)
+            firstTime = time;
+        
+        memcpy(rec + pos, &time, sizeof(double));
+        memcpy(rec + pos + sizeof(double), &size, sizeof(int));
     }
+    
+    fclose(file);
+    
+    memcpy(replay_.ResizeOK(records.GetSize()), records.Get(), records.GetSize());
+    replayPosition_ = 0;
+    replayStartTime_ = isRealTime ? time_precise() - (firstTime > 0.0 ? firstTime : 0.0) : -1.0;
+    
+    return true;
+}
+
+bool CSITrafficLog::GetNextReplayed(const unsigned char *&data, int &size)
+{
+    if (replayPosition_ + (int)(sizeof(double) + sizeof(int)) > replay_.GetSize())
+        return false;
+    
+    const unsigned char *rec = (const unsigned char *)replay_.Get() + replayPosition_;
+    
+    double time;
+    memcpy(&time, rec, sizeof(double));
+    
+    if (replayStartTime_ >= 0.0 && time > time_precise() - replayStartTime_)
+        return false;
+    
+    memcpy(&size, rec + sizeof(double), sizeof(int));
+    data = rec + sizeof(double) + sizeof(int);
+    replayPosition_ += sizeof(double) + sizeof(int) + size;
+    
+    if (replayPosition_ >= replay_.GetSize())
+        replay_.Resize(0, false); // finished, but data stays valid until the next StartReplay
+    
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3972,8 +5722,10 @@ Midi_ControlSurface::Midi_ControlSurface(CSurfIntegrator *const csi, Page *page,
     displayType_ = 0x14;
     lastRun_ = 0;
     
+    const double startTime = time_precise();
     ProcessMIDIWidgetFile(surfaceFile, this);
     InitHardwiredWidgets(this);
+    csi_->AddInitPhaseTime(InitPhase_SurfaceFiles, startTime);
     InitializeMeters();
     InitZoneManager(csi_, this, zoneFolder, fxZoneFolder);
 }
@@ -4048,7 +5800,7 @@ OSC_X32ControlSurfaceIO::OSC_X32ControlSurfaceIO(CSurfIntegrator *const csi, con
     X32HeartBeatLastRefreshTime_ = GetTickCount()-30000;
 }
 
-OSC_ControlSurfaceIO::OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const char *surfaceName, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun) : csi_(csi), name_(surfaceName), channelCount_(channelCount)
+OSC_ControlSurfaceIO::OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const char *surfaceName, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun) : csi_(csi), name_(surfaceName), channelCount_(channelCount), trafficLog_(surfaceName)
 {
     // private:
     inSocket_ = NULL;
@@ -4056,6 +5808,7 @@ OSC_ControlSurfaceIO::OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const cha
     maxBundleSize_ = 0; // could be user configured, possible some networks might enforce a 1500 byte MTU or something
     maxPacketsPerRun_ = maxPacketsPerRun < 0 ? 0 : maxPacketsPerRun;
     sentPacketCount_ = 0;
+    packetTime_ = 0.0;
 
     if (strcmp(receiveOnPort, transmitToPort))
     {
@@ -4117,29 +5870,64 @@ OSC_ControlSurfaceIO::~OSC_ControlSurfaceIO()
     }
 }
 
+bool OSC_ControlSurfaceIO::ReceiveNextPacket()
+{
+    if (inSocket_ != NULL && inSocket_->isOk() && inSocket_->receiveNextPacket(0))  // timeout, in ms
+    {
+        packetTime_ = time_precise();
+        trafficLog_.Record(false, inSocket_->packetData(), inSocket_->packetSize(), packetTime_);
+        packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
+        return true;
+    }
+    
+    const unsigned char *replayed;
+    int replayedSize;
+    while (trafficLog_.GetNextReplayed(replayed, replayedSize))
+        InjectPacket(replayed, replayedSize);
+    
+    if (injectedPackets_.Available() < (int)sizeof(int))
+    {
+        injectedPackets_.Clear();
+        return false;
+    }
+    
+    int sz;
+    memcpy(&sz, injectedPackets_.Get(), sizeof(int));
+    if (WDL_NOT_NORMALLY(injectedPackets_.Available() < (int)sizeof(int) + sz)) // not enough data in queue, should not happen
+    {
+        injectedPackets_.Clear();
+        return false;
+    }
+    
+    memcpy(injectedPacket_.ResizeOK(sz), (const char *)injectedPackets_.Get() + sizeof(int), sz);
+    injectedPackets_.Advance(sizeof(int) + sz);
+    packetReader_.init(injectedPacket_.Get(), sz);
+    packetTime_ = time_precise();
+    return true;
+}
+
 void OSC_ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
 {
-   if (inSocket_ != NULL && inSocket_->isOk())
+   while (ReceiveNextPacket())
    {
-       while (inSocket_->receiveNextPacket(0))  // timeout, in ms
+       oscpkt::Message *message;
+       
+       if (g_timingDisplay)
+           surface->SetInputTime(packetTime_);
+       
+       while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
        {
-           packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
-           oscpkt::Message *message;
-           
-           while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
+           if (message->arg().isFloat())
            {
-               if (message->arg().isFloat())
-               {
-                   float value = 0;
-                   message->arg().popFloat(value);
-                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
-               }
-               else if (message->arg().isInt32())
-               {
-                   int value;
-                   message->arg().popInt32(value);
-                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
-               }
+               float value = 0;
+               message->arg().popFloat(value);
+               surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+           }
+           else if (message->arg().isInt32())
+           {
+               int value;
+               message->arg().popInt32(value);
+               surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
            }
        }
    }
@@ -4147,44 +5935,43 @@ void OSC_ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
 
 void OSC_X32ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
 {
-   if (inSocket_ != NULL && inSocket_->isOk())
+   while (ReceiveNextPacket())
    {
-       while (inSocket_->receiveNextPacket(0))  // timeout, in ms
+       oscpkt::Message *message;
+       
+       if (g_timingDisplay)
+           surface->SetInputTime(packetTime_);
+       
+       while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
        {
-           packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
-           oscpkt::Message *message;
-           
-           while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
+           if (message->arg().isFloat())
            {
-               if (message->arg().isFloat())
-               {
-                   float value = 0;
-                   message->arg().popFloat(value);
-                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
-               }
-               else if (message->arg().isInt32())
+               float value = 0;
+               message->arg().popFloat(value);
+               surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+           }
+           else if (message->arg().isInt32())
+           {
+               int value;
+               message->arg().popInt32(value);
+               
+               if (message->addressPattern() == "/-stat/selidx")
                {
-                   int value;
-                   message->arg().popInt32(value);
+                   WDL_FastString x32Select;
                    
-                   if (message->addressPattern() == "/-stat/selidx")
-                   {
-                       WDL_FastString x32Select;
-                       
-                       x32Select.Set(message->addressPattern().c_str());
-                       x32Select.Append("/");
-                       if (value < 10)
-                           x32Select.Append("0");
-
-                       char buf[64];
-                       snprintf(buf, sizeof(buf), "%d", value);
-                       x32Select.Append(buf);
-                                              
-                       surface->ProcessOSCMessage(x32Select.Get(), 1.0);
-                   }
-                   else
-                       surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+                   x32Select.Set(message->addressPattern().c_str());
+                   x32Select.Append("/");
+                   if (value < 10)
+                       x32Select.Append("0");
+
+                   char buf[64];
+                   snprintf(buf, sizeof(buf), "%d", value);
+                   x32Select.Append(buf);
+                                          
+                   surface->ProcessOSCMessage(x32Select.Get(), 1.0);
                }
+               else
+                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
            }
        }
    }
@@ -4196,8 +5983,10 @@ void OSC_X32ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
 OSC_ControlSurface::OSC_ControlSurface(CSurfIntegrator *const csi, Page *page, const char *name, int channelOffset, const char *templateFilename, const char *zoneFolder, const char *fxZoneFolder, OSC_ControlSurfaceIO *surfaceIO) : ControlSurface(csi, page, name, surfaceIO->GetChannelCount(), channelOffset), surfaceIO_(surfaceIO)
 
 {
-    ProcessOSCWidgetFile(string(GetResourcePath()) + "/CSI/Surfaces/OSC/" + templateFilename);
+    const double startTime = time_precise();
+    ProcessOSCWidgetFile(templateFilename);
     InitHardwiredWidgets(this);
+    csi_->AddInitPhaseTime(InitPhase_SurfaceFiles, startTime);
     InitZoneManager(csi_, this, zoneFolder, fxZoneFolder);
 }
 
@@ -4269,6 +6058,7 @@ void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, const char *valu
 void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, double value)
 {
     surfaceIO_->SendOSCMessage(oscAddress, value);
+    feedbackProcessor->GetWidget()->TraceFeedback(feedbackProcessor);
     
     if (g_surfaceOutDisplay)
     {
@@ -4281,6 +6071,7 @@ void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor
 void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int value)
 {
     surfaceIO_->SendOSCMessage(oscAddress, value);
+    feedbackProcessor->GetWidget()->TraceFeedback(feedbackProcessor);
 
     if (g_surfaceOutDisplay)
     {
@@ -4293,6 +6084,7 @@ void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor
 void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, const char *value)
 {
     surfaceIO_->SendOSCMessage(oscAddress, value);
+    feedbackProcessor->GetWidget()->TraceFeedback(feedbackProcessor);
 
     if (g_surfaceOutDisplay)
     {
@@ -4383,12 +6175,30 @@ void Midi_ControlSurface::InitializeMCUXT()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 static const char * const Control_Surface_Integrator = "Control Surface Integrator";
 
-CSurfIntegrator::CSurfIntegrator() : actions_(true, disposeAction), fxParamSteppedValueCounts_(true, disposeCounts)
+CSurfIntegrator::CSurfIntegrator() : actions_(true, disposeAction), zoneDefinitions_(true, disposeZoneDefinitions), formattedFXParams_(compareFXParamKeys), fxParamWrites_(compareFXParamKeys), feedbackLatencies_(true, disposeFeedbackLatencies)
 {
     currentPageIndex_ = 0;
 
     shouldRun_ = true;
     
+    meterTick_ = 0;
+    anyTrackSoloTick_ = -1;
+    anyTrackSolo_ = false;
+    
+    toggleStatesCommandCount_ = s_commandCount;
+    toggleStatesTime_ = 0.0;
+    
+    if (s_commandHookUsers++ == 0 && g_reaper_plugin_info)
+        g_reaper_plugin_info->Register("hookpostcommand", (void *)OnPostCommand);
+    
+    if (s_integrators.GetSize() == 0)
+        RegisterScriptFunctions(true);
+    s_integrators.Add(this);
+    
+#ifdef __linux__
+    zoneFileWatch_ = -1;
+#endif
+    
     InitActionsDictionary();
 
     int size = 0;
@@ -4418,7 +6228,19 @@ CSurfIntegrator::CSurfIntegrator() : actions_(true, disposeAction), fxParamStepp
 CSurfIntegrator::~CSurfIntegrator()
 {
     Shutdown();
-
+    
+    if (--s_commandHookUsers == 0 && g_reaper_plugin_info)
+        g_reaper_plugin_info->Register("-hookpostcommand", (void *)OnPostCommand);
+    
+    s_integrators.DeletePtr(this);
+    if (s_integrators.GetSize() == 0)
+        RegisterScriptFunctions(false);
+    
+#ifdef __linux__
+    if (zoneFileWatch_ >= 0)
+        close(zoneFileWatch_);
+#endif
+    
     midiSurfacesIO_.Empty(true);
     
     oscSurfacesIO_.Empty(true);
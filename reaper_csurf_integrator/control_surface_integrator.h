@@ -71,6 +71,9 @@ extern bool g_surfaceRawInDisplay;
 extern bool g_surfaceInDisplay;
 extern bool g_surfaceOutDisplay;
 extern bool g_fxParamsWrite;
+extern bool g_timingDisplay;
+extern bool g_fxParamsThinWhileTouched;
+extern bool g_recordSurfaceTraffic;
 
 extern REAPER_PLUGIN_HINSTANCE g_hInst;
 
@@ -260,120 +263,229 @@ enum PropertyType {
 #define DEFPT(x) PropertyType_##x ,
   DECLARE_PROPERTY_TYPES(DEFPT)
 #undef DEFPT
+  PropertyType_Count
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class PropertyList
+class PropertySet
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-    enum { MAX_PROP=24, RECLEN=10 };
+    // Immutable once interned -- every PropertyList holding the same properties, in the same order, shares one of these
+    // and it is freed, along with any of its strings no other set uses, when the last of them lets go
+    friend class PropertyList;
+    
+    enum { MAX_PROP=24 };
     int nprops_;
     PropertyType props_[MAX_PROP];
-    char vals_[MAX_PROP][RECLEN]; // if last byte is nonzero, pointer, otherwise, string
+    const char *vals_[MAX_PROP]; // interned strings
+    signed char index_[PropertyType_Count]; // slot in props_/vals_, -1 if not set
+    mutable int refCount_; // PropertyLists holding this set
+    
+    PropertySet() : nprops_(0), refCount_(0) { memset(index_, -1, sizeof(index_)); }
+    
+    static void disposeSet(PropertySet *set) { delete set; }
 
-    static char *get_item_ptr(char *vp) // returns a strdup'd string
+    static WDL_StringKeyedArray<int> &strings()
+    {
+        static WDL_StringKeyedArray<int> s_strings; // value is the number of interned sets using the string
+        return s_strings;
+    }
+    
+    static WDL_StringKeyedArray<PropertySet*> &sets()
+    {
+        static WDL_StringKeyedArray<PropertySet*> s_sets(true, disposeSet);
+        return s_sets;
+    }
+    
+    static const char *intern_string(const char *str)
     {
-        if (!vp[RECLEN-1]) return NULL;
-        char *ret;
-        memcpy(&ret,vp,sizeof(char *));
-        return ret;
+        const char *interned = NULL;
+        
+        if (strings().GetPtr(str, &interned) == NULL)
+        {
+            strings().Insert(str, 0);
+            strings().GetPtr(str, &interned);
+        }
+        
+        return interned;
     }
+    
+    static void release_string(const char *str)
+    {
+        int *refCount = strings().GetPtr(str);
+        
+        if (WDL_NORMALLY(refCount) && --*refCount == 0)
+            strings().Delete(str);
+    }
+    
+    static void get_key(const PropertySet &set, char *key, int keySize)
+    {
+        // interned strings are unique, so their addresses identify the set
+        key[0] = 0;
+        for (int x = 0; x < set.nprops_; ++x)
+            snprintf_append(key, keySize, "%d:%p,", set.props_[x], set.vals_[x]);
+    }
+    
+    // returns the shared set with a reference added for the caller, see release_set
+    static const PropertySet *intern_set(const PropertySet &set)
+    {
+        if (set.nprops_ == 0)
+            return NULL;
+        
+        char key[MAX_PROP * 24 + 1];
+        get_key(set, key, sizeof(key));
+        
+        PropertySet *interned = sets().Get(key);
+        
+        if (interned == NULL)
+        {
+            interned = new PropertySet(set);
+            interned->refCount_ = 0;
+            sets().Insert(key, interned);
+            
+            for (int x = 0; x < set.nprops_; ++x)
+                (*strings().GetPtr(set.vals_[x]))++;
+        }
+        
+        interned->refCount_++;
+        
+        return interned;
+    }
+    
+    static void release_set(const PropertySet *set)
+    {
+        if (set == NULL || --set->refCount_ > 0)
+            return;
+        
+        char key[MAX_PROP * 24 + 1];
+        get_key(*set, key, sizeof(key));
+        
+        const char *vals[MAX_PROP];
+        const int nprops = set->nprops_;
+        memcpy(vals, set->vals_, nprops * sizeof(vals[0]));
+        
+        sets().Delete(key);
+        
+        for (int x = 0; x < nprops; ++x)
+            release_string(vals[x]);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class PropertyList
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    const PropertySet *set_; // NULL when empty, otherwise holds a reference on the interned set
 
   public:
-    PropertyList() : nprops_(0) { }
-    ~PropertyList()
+    PropertyList() : set_(NULL) { }
+    PropertyList(const PropertyList &cp) : set_(cp.set_) { if (set_) set_->refCount_++; }
+    ~PropertyList() { PropertySet::release_set(set_); }
+    
+    PropertyList &operator=(const PropertyList &cp)
     {
-        for (int x = 0; x < nprops_; ++x) free(get_item_ptr(&vals_[x][0]));
+        if (cp.set_)
+            cp.set_->refCount_++;
+        PropertySet::release_set(set_);
+        set_ = cp.set_;
+        return *this;
     }
     
     void delete_props()
     {
-        for (int x = 0; x < nprops_; ++x) free(get_item_ptr(&vals_[x][0]));
-        nprops_ = 0;
+        PropertySet::release_set(set_);
+        set_ = NULL;
     }
 
     void set_prop(PropertyType prop, const char *val)
     {
+        PropertySet set;
+        if (set_)
+            set = *set_;
+        
         int x;
-        if (prop == PropertyType_Unknown)
-            x = nprops_;
+        if (prop == PropertyType_Unknown || set.index_[prop] < 0)
+            x = set.nprops_;
         else
-            for (x = 0; x < nprops_ && props_[x] != prop; ++x);
+            x = set.index_[prop];
 
-        if (WDL_NOT_NORMALLY(x >= MAX_PROP)) return;
+        if (WDL_NOT_NORMALLY(x >= PropertySet::MAX_PROP)) return;
 
-        char *rec = &vals_[x][0];
-        if (x == nprops_)
+        if (x == set.nprops_)
         {
-            nprops_++;
-            props_[x] = prop;
-        }
-        else
-        {
-            free(get_item_ptr(rec));
+            set.nprops_++;
+            set.props_[x] = prop;
+            if (prop != PropertyType_Unknown)
+                set.index_[prop] = x;
         }
 
-        if (strlen(val) < RECLEN)
-        {
-          lstrcpyn_safe(rec, val, RECLEN);
-          rec[RECLEN-1] = 0;
-        }
-        else
-        {
-          char *v = strdup(val);
-          memcpy(rec, &v, sizeof(v));
-          rec[RECLEN-1] = 1;
-        }
+        set.vals_[x] = PropertySet::intern_string(val);
+        
+        const PropertySet *previous = set_;
+        set_ = PropertySet::intern_set(set);
+        PropertySet::release_set(previous);
     }
     void set_prop_int(PropertyType prop, int v) { char tmp[64]; snprintf(tmp,sizeof(tmp),"%d",v); set_prop(prop,tmp); }
 
     const char *get_prop(PropertyType prop) const
     {
-        for (int x = 0; x < nprops_; ++x)
-            if (props_[x] == prop)
-            {
-                char *p = get_item_ptr((char *) (&vals_[x][0]));
-                return p ? p : &vals_[x][0];
-            }
-        return NULL;
+        if (set_ == NULL || prop == PropertyType_Unknown)
+            return NULL;
+        
+        const int x = set_->index_[prop];
+        return x < 0 ? NULL : set_->vals_[x];
     }
 
     const char *enum_props(int x, PropertyType &type) const
     {
-        if (x<0 || x >= nprops_) return NULL;
-        type = props_[x];
-        return get_item_ptr((char*)&vals_[x][0]);
+        if (set_ == NULL || x < 0 || x >= set_->nprops_) return NULL;
+        type = set_->props_[x];
+        return set_->vals_[x];
     }
 
     static PropertyType prop_from_string(const char *str)
     {
-#define CHK(x) if (!strcmp(str,#x)) return PropertyType_##x;
-        DECLARE_PROPERTY_TYPES(CHK)
+        static WDL_StringKeyedArray<int> s_propsByName;
+        
+        if (s_propsByName.GetSize() == 0)
+        {
+#define CHK(x) s_propsByName.AddUnsorted(#x, PropertyType_##x);
+            DECLARE_PROPERTY_TYPES(CHK)
 #undef CHK
-        return PropertyType_Unknown;
+            s_propsByName.Resort();
+        }
+        
+        return (PropertyType)s_propsByName.Get(str, PropertyType_Unknown);
     }
     static const char *string_from_prop(PropertyType type)
     {
-#define CHK(x) if (type == PropertyType_##x) return #x;
-        DECLARE_PROPERTY_TYPES(CHK)
+        static const char * const s_names[PropertyType_Count] =
+        {
+            NULL,
+#define CHK(x) #x,
+            DECLARE_PROPERTY_TYPES(CHK)
 #undef CHK
-        return NULL;
+        };
+        
+        if (type <= PropertyType_Unknown || type >= PropertyType_Count)
+            return NULL;
+        
+        return s_names[type];
     }
 
     void save_list(FILE *fxFile) const
     {
-        for (int x = 0; x < nprops_; ++x)
+        if (set_ == NULL)
+            return;
+        
+        for (int x = 0; x < set_->nprops_; ++x)
         {
-            //const char *value = get_item_ptr((char *)&vals_[x][0]), *key = string_from_prop(props_[x]);
-            const char *value = get_prop(props_[x]);
-            const char *key = string_from_prop(props_[x]);
+            const char *value = set_->vals_[x];
+            const char *key = string_from_prop(set_->props_[x]);
             
             if (key && value)
                 fprintf(fxFile, "%s=%s ", key, value);
-            //else if (WDL_NORMALLY(props_[x] == PropertyType_Unknown && value && strstr(value,"=")))
-                //fprintf(fxFile, " %s", value);
         }
-        //fprintf(fxFile,"\n");
     }
 
     void print_to_buf(char * buf, int buf_size, PropertyType prop)
@@ -400,6 +512,17 @@ class ActionContext;
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum ActionParamLayout
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    ActionParamLayout_Default,              // Action [intParam | paramIndex | stringParam]
+    ActionParamLayout_Bank,                 // Bank "ZoneName" amount
+    ActionParamLayout_CommandId,            // Reaper commandId | _NAMED_COMMAND
+    ActionParamLayout_FXParamNameDisplay,   // FXParamNameDisplay paramIndex ["Alias"]
+    ActionParamLayout_FixedTextDisplay,     // FixedTextDisplay "text" paramIndex
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Action
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -409,6 +532,10 @@ public:
     
     virtual const char *GetName() { return "Action"; }
 
+    // Descriptor -- consulted once, when an ActionContext is built from a Zone file line
+    virtual ActionParamLayout GetParamLayout() { return ActionParamLayout_Default; }
+    virtual void GetDefaultRange(double &rangeMinimum, double &rangeMaximum) {}
+
     virtual void Touch(ActionContext *context, double value) {}
     virtual void RequestUpdate(ActionContext *context) {}
     virtual void Do(ActionContext *context, double value) {}
@@ -437,10 +564,12 @@ protected:
     bool isPanLeftTouched_;
     bool isPanRightTouched_;
     bool isMCUTrackPanWidth_;
+    int zoneReferences_; // number of live Zones navigating with this
 
     Navigator(const CSurfIntegrator *const csi, Page * page) : csi_(csi), page_(page)
     {
         // protected:
+        zoneReferences_ = 0;
         isVolumeTouched_ = false;
         isPanTouched_ = false;
         isPanWidthTouched_ = false;
@@ -455,6 +584,10 @@ public:
     virtual const char *GetName() { return "Navigator"; }
     virtual MediaTrack *GetTrack() { return NULL; }
     virtual int GetChannelNum() { return 0; }
+    
+    void AddZoneReference() { zoneReferences_++; }
+    void RemoveZoneReference() { zoneReferences_--; }
+    int GetZoneReferences() { return zoneReferences_; }
 
     bool GetIsNavigatorTouched() { return isVolumeTouched_ || isPanTouched_ || isPanWidthTouched_ || isPanLeftTouched_ || isPanRightTouched_; }
     
@@ -552,6 +685,25 @@ public:
     virtual MediaTrack *GetTrack() override;
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ActionContextConfig
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Immutable once interned -- shared by every ActionContext configured with the same values, and freed when the last one lets go
+    string stringParam;
+    string fxParamDisplayName;
+    vector<double> steppedValues;
+    vector<double> acceleratedDeltaValues;
+    vector<int> acceleratedTickValues;
+    vector<rgba_color> colorValues;
+    mutable int refCount;
+    
+    ActionContextConfig() : refCount(0) {}
+    
+    static const ActionContextConfig *Intern(const ActionContextConfig &config); // adds a reference for the caller
+    static void Release(const ActionContextConfig *config);
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class ActionContext
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -562,24 +714,20 @@ private:
     Widget  *const widget_;
     Zone  *const zone_;
 
-    int intParam_;
+    const ActionContextConfig *config_;
     
-    string stringParam_;
+    int intParam_;
     
     int paramIndex_;
-    string fxParamDisplayName_;
     
     int commandId_;
     
     double rangeMinimum_;
     double rangeMaximum_;
     
-    vector<double> steppedValues_;
     int steppedValuesIndex_;
     
     double deltaValue_;
-    vector<double> acceleratedDeltaValues_;
-    vector<int> acceleratedTickValues_;
     int accumulatedIncTicks_;
     int accumulatedDecTicks_;
     
@@ -591,7 +739,6 @@ private:
     double deferredValue_;
     
     bool supportsColor_;
-    vector<rgba_color> colorValues_;
     int currentColorIndex_;
     
     bool supportsTrackColor_;
@@ -604,10 +751,21 @@ private:
     void GetSteppedValues(Widget *widget, Action *action,  Zone *zone, int paramNumber, const string_list &params, const PropertyList &widgetProperties, double &deltaValue, vector<double> &acceleratedDeltaValues, double &rangeMinimum, double &rangeMaximum, vector<double> &steppedValues, vector<int> &acceleratedTickValues);
     void SetColor(const string_list &params, bool &supportsColor, bool &supportsTrackColor, vector<rgba_color> &colorValues);
     void GetColorValues(vector<rgba_color> &colorValues, const string_list &colors);
+    
+    void SetConfig(const ActionContextConfig &config)
+    {
+        const ActionContextConfig *previous = config_;
+        config_ = ActionContextConfig::Intern(config);
+        ActionContextConfig::Release(previous);
+    }
+    
+    ActionContext(const ActionContext &); // would share config_ without a reference
+    ActionContext &operator=(const ActionContext &);
+    
 public:
     ActionContext(CSurfIntegrator *const csi, Action *action, Widget *widget, Zone *zone, int paramIndex, const string_list *params, const string *stringParam);
 
-    virtual ~ActionContext() {}
+    virtual ~ActionContext() { ActionContextConfig::Release(config_); }
     
     CSurfIntegrator *GetCSI() { return csi_; }
     
@@ -620,7 +778,7 @@ public:
     int GetIntParam() { return intParam_; }
     int GetCommandId() { return commandId_; }
     
-    const char *GetFXParamDisplayName() { return fxParamDisplayName_.c_str(); }
+    const char *GetFXParamDisplayName() { return config_->fxParamDisplayName.c_str(); }
     
     MediaTrack *GetTrack();
     
@@ -654,13 +812,11 @@ public:
     void UpdateJSFXWidgetSteppedValue(double value);
     void UpdateColorValue(double value);
 
-    const char *GetStringParam() { return stringParam_.c_str(); }
-    const   vector<double> &GetAcceleratedDeltaValues() { return acceleratedDeltaValues_; }
-    void    SetAccelerationValues(const vector<double> &acceleratedDeltaValues) { acceleratedDeltaValues_ = acceleratedDeltaValues; }
-    const   vector<int> &GetAcceleratedTickCounts() { return acceleratedTickValues_; }
-    void    SetTickCounts(const vector<int> &acceleratedTickValues) { acceleratedTickValues_ = acceleratedTickValues; }
-    int     GetNumberOfSteppedValues() { return (int)steppedValues_.size(); }
-    const   vector<double> &GetSteppedValues() { return steppedValues_; }
+    const char *GetStringParam() { return config_->stringParam.c_str(); }
+    const   vector<double> &GetAcceleratedDeltaValues() { return config_->acceleratedDeltaValues; }
+    const   vector<int> &GetAcceleratedTickCounts() { return config_->acceleratedTickValues; }
+    int     GetNumberOfSteppedValues() { return (int)config_->steppedValues.size(); }
+    const   vector<double> &GetSteppedValues() { return config_->steppedValues; }
     double  GetDeltaValue() { return deltaValue_; }
     void    SetDeltaValue(double deltaValue) { deltaValue_ = deltaValue; }
     double  GetRangeMinimum() const { return rangeMinimum_; }
@@ -679,15 +835,33 @@ public:
             ClearWidget();
     }
     
+    void SetAccelerationValues(const vector<double> &acceleratedDeltaValues)
+    {
+        ActionContextConfig config = *config_;
+        config.acceleratedDeltaValues = acceleratedDeltaValues;
+        SetConfig(config);
+    }
+    
+    void SetTickCounts(const vector<int> &acceleratedTickValues)
+    {
+        ActionContextConfig config = *config_;
+        config.acceleratedTickValues = acceleratedTickValues;
+        SetConfig(config);
+    }
+
     void SetStringParam(const char *stringParam) 
     { 
-        stringParam_ = stringParam;
+        ActionContextConfig config = *config_;
+        config.stringParam = stringParam;
+        SetConfig(config);
         RequestUpdate();
     }
 
     void SetStepValues(const vector<double> &steppedValues) 
     {
-        steppedValues_ = steppedValues;
+        ActionContextConfig config = *config_;
+        config.steppedValues = steppedValues;
+        SetConfig(config);
         if (steppedValuesIndex_ >= steppedValues.size())
             steppedValuesIndex_ = 0;
         RequestUpdate();
@@ -712,10 +886,12 @@ public:
         int index = 0;
         double delta = 100000000.0;
         
-        for (int i = 0; i < steppedValues_.size(); ++i)
-            if (fabs(steppedValues_[i] - value) < delta)
+        const vector<double> &steppedValues = config_->steppedValues;
+        
+        for (int i = 0; i < steppedValues.size(); ++i)
+            if (fabs(steppedValues[i] - value) < delta)
             {
-                delta = fabs(steppedValues_[i] - value);
+                delta = fabs(steppedValues[i] - value);
                 index = i;
             }
         
@@ -794,6 +970,20 @@ public:
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum ZoneSlotKind // how Zone::GetSlotIndex() combines slotIndex_ with the ZoneManager offsets, fixed by the Zone name
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    ZoneSlotKind_Default,
+    ZoneSlotKind_TrackSend,
+    ZoneSlotKind_TrackReceive,
+    ZoneSlotKind_TrackFXMenu,
+    ZoneSlotKind_SelectedTrackSend,
+    ZoneSlotKind_SelectedTrackReceive,
+    ZoneSlotKind_SelectedTrackFXMenu,
+    ZoneSlotKind_MasterTrackFXMenu,
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Zone
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -806,6 +996,7 @@ protected:
     string const name_;
     string const alias_;
     string const sourceFilePath_;
+    ZoneSlotKind const slotKind_;
     
     bool isActive_;
     
@@ -821,18 +1012,33 @@ protected:
 
     ptrvector<Zone *> subZones_;
 
-    void UpdateCurrentActionContextModifier(Widget *widget);
+    bool UpdateCurrentActionContextModifier(Widget *widget);
+    
+    static ZoneSlotKind SlotKindFromName(const string &name);
         
 public:
-    Zone(CSurfIntegrator *const csi, ZoneManager  *const zoneManager, Navigator *navigator, int slotIndex, const string &name, const string &alias, const string &sourceFilePath): csi_(csi), zoneManager_(zoneManager), navigator_(navigator), slotIndex_(slotIndex), name_(name), alias_(alias), sourceFilePath_(sourceFilePath), actionContextDictionary_(destroyActionContextListArray)
+    Zone(CSurfIntegrator *const csi, ZoneManager  *const zoneManager, Navigator *navigator, int slotIndex, const string &name, const string &alias, const string &sourceFilePath): csi_(csi), zoneManager_(zoneManager), navigator_(navigator), slotIndex_(slotIndex), name_(name), alias_(alias), sourceFilePath_(sourceFilePath), slotKind_(SlotKindFromName(name)), actionContextDictionary_(destroyActionContextListArray)
     {
         isActive_ = false;
+        
+        if (navigator_ != NULL)
+            navigator_->AddZoneReference();
     }
 
     virtual ~Zone()
     {
+        // ptrvector only frees its own slots, and nothing else owns the Zones loaded into these
+        for (int i = 0; i < includedZones_.size(); ++i)
+            delete includedZones_[i];
+        
+        for (int i = 0; i < subZones_.size(); ++i)
+            delete subZones_[i];
+        
         includedZones_.clear();
         subZones_.clear();
+        
+        if (navigator_ != NULL)
+            navigator_->RemoveZoneReference();
     }
     
     void InitSubZones(const string_list &subZones, const char *widgetSuffix);
@@ -840,6 +1046,7 @@ public:
     void SetXTouchDisplayColors(const char *colors);
     void RestoreXTouchDisplayColors();
     void UpdateCurrentActionContextModifiers();
+    bool ResolveCurrentActionContextModifiers();
     
     const WDL_PointerKeyedArray<Widget*, WDL_IntKeyedArray<WDL_PtrList<ActionContext> *> *> &GetActionContextDictionary() { return actionContextDictionary_; }
     const WDL_PtrList<ActionContext> &GetActionContexts(Widget *widget);
@@ -855,6 +1062,7 @@ public:
 
     const char *GetSourceFilePath() { return sourceFilePath_.c_str(); }
     ptrvector<Zone *> &GetIncludedZones() { return includedZones_; }
+    bool UsesSourceFile(const char *filePath);
 
     Navigator *GetNavigator() { return navigator_; }
     void SetSlotIndex(int index) { slotIndex_ = index; }
@@ -895,16 +1103,19 @@ public:
             }
         }
         
+        // A widget has a handful of modifiers, each with one or two contexts, so the default 4K granularity of these
+        // would make the lists, not the contexts, most of a zone's heap
         if (!m)
         {
             m = new WDL_IntKeyedArray<WDL_PtrList<ActionContext> *>(destroyActionContextList);
+            m->SetGranul(64);
             actionContextDictionary_.Insert(widget,m);
         }
         
         WDL_PtrList<ActionContext> *l = m->Get(modifier);
         if (!l)
         {
-            l = new WDL_PtrList<ActionContext>;
+            l = new WDL_PtrList<ActionContext>(2 * sizeof(ActionContext *));
             m->Insert(modifier,l);
         }
 
@@ -993,6 +1204,9 @@ protected:
     
     bool isTwoState_;
     
+    double traceInputTime_; // arrival time of the input awaiting its feedback, 0 when none -- only set while timing is shown
+    string type_; // name without its channel number, e.g. "Fader" for Fader3, so latencies can be grouped by kind of control
+    
 public:
     // all Widgets are owned by their ControlSurface!
     Widget(CSurfIntegrator *const csi,  ControlSurface *surface, const char *name) : csi_(csi), surface_(surface), name_(name)
@@ -1004,6 +1218,7 @@ public:
         stepSize_ = 0.0;
         hasBeenUsedByUpdate_ = false;
         isTwoState_ = false;
+        traceInputTime_ = 0.0;
 
         int index = (int)strlen(name) - 1;
         if (isdigit(name[index]))
@@ -1014,7 +1229,10 @@ public:
             index++;
             
             channelNumber_ = atoi(name + index);
+            type_.assign(name, index);
         }
+        else
+            type_ = name;
     }
     
     ~Widget()
@@ -1029,6 +1247,7 @@ public:
     bool GetHasBeenUsedByUpdate() { return hasBeenUsedByUpdate_; }
     
     const char *GetName() { return name_.c_str(); }
+    const char *GetType() { return type_.c_str(); }
     ControlSurface *GetSurface() { return surface_; }
     ZoneManager *GetZoneManager();
     int GetChannelNumber() { return channelNumber_; }
@@ -1057,6 +1276,7 @@ public:
     void RestoreXTouchDisplayColors();
     void ForceClear();
     void LogInput(double value);
+    void TraceFeedback(FeedbackProcessor *feedbackProcessor);
     
     void AddFeedbackProcessor(FeedbackProcessor *feedbackProcessor) // takes ownership of feedbackProcessor
     {
@@ -1080,6 +1300,70 @@ struct CSIZoneInfo
     string alias;
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CSIZoneTemplateLine
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string_list tokens;
+    int lineNumber;         // for error reporting
+    bool hasSuffix;         // a token carries the '|' widget suffix placeholder, so it is substituted per instance
+    
+    // widget lines only, resolved when the file is parsed
+    string widgetName;
+    int modifier;
+    bool isValueInverted;
+    bool isFeedbackInverted;
+    bool isHold;
+    bool isDecrease;
+    bool isIncrease;
+    Action *action;         // NULL when the action name carries the suffix placeholder
+    string_list memberParams;
+    
+    CSIZoneTemplateLine() : lineNumber(0), hasSuffix(false), modifier(0), isValueInverted(false), isFeedbackInverted(false), isHold(false), isDecrease(false), isIncrease(false), action(NULL) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CSIZoneTemplate
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // a .zon file parsed once and kept read-only, so FX Zones can be instantiated without going back to disk or re-parsing
+    WDL_PtrList<CSIZoneTemplateLine> lines;
+    
+    ~CSIZoneTemplate() { lines.Empty(true); }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CSIZoneDefinitions
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // shared by every ZoneManager that uses the same Zone/FXZone folders, on any Page
+    WDL_StringKeyedArray<CSIZoneInfo*> zoneInfo;
+    WDL_StringKeyedArray<CSIZoneTemplate*> zoneTemplates;
+    WDL_PtrList<ZoneManager> zoneManagers; // users, so a changed file can be dropped from all of their Zone pools
+    bool isPreProcessed;
+    int reloadSerial; // last zone file change applied, so users sharing these definitions re-parse a changed file once
+    
+    static void disposeZoneInfo(CSIZoneInfo *info) { delete info; }
+    static void disposeZoneTemplate(CSIZoneTemplate *zoneTemplate) { delete zoneTemplate; }
+    
+    CSIZoneDefinitions() : zoneInfo(true, disposeZoneInfo), zoneTemplates(true, disposeZoneTemplate), isPreProcessed(false), reloadSerial(0) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum ListenerCategory
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    ListenerCategory_GoHome,
+    ListenerCategory_Sends,
+    ListenerCategory_Receives,
+    ListenerCategory_FocusedFX,
+    ListenerCategory_FocusedFXParam,
+    ListenerCategory_FXMenu,
+    ListenerCategory_LocalFXSlot,
+    ListenerCategory_SelectedTrackFX,
+    NumListenerCategories
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class ZoneManager
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1090,8 +1374,9 @@ private:
     string const zoneFolder_;
     string const fxZoneFolder_;
    
-    WDL_StringKeyedArray<CSIZoneInfo*> zoneInfo_;
-    static void disposeAction(CSIZoneInfo *zoneInfo) { delete zoneInfo; }
+    CSIZoneDefinitions *const zoneDefinitions_;
+    WDL_StringKeyedArray<CSIZoneInfo*> &zoneInfo_;
+    WDL_StringKeyedArray<CSIZoneTemplate*> &zoneTemplates_;
         
     double holdDelayAmount_;
     
@@ -1101,18 +1386,24 @@ private:
 
     ptrvector<Zone *> goZones_;
     
+    WDL_StringKeyedArray<bool> unresolvedZoneNames_; // asked for while loading Home and the Go Zones, but no .zon file defined them
+    
     ptrvector<ZoneManager *> listeners_;
     
     WDL_PtrList<Zone> zonesToBeDeleted_;
     
-    bool listensToGoHome_;
-    bool listensToSends_;
-    bool listensToReceives_;
-    bool listensToFocusedFX_;
-    bool listensToFocusedFXParam_;
-    bool listensToFXMenu_;
-    bool listensToLocalFXSlot_;
-    bool listensToSelectedTrackFX_;
+    enum { MaxPooledZones = 32 };
+    WDL_PtrList<Zone> zonePool_; // retired FX Zones kept for reuse, oldest first
+    
+    int listenerCategories_; // bit per ListenerCategory this surface listens to
+    
+    // Per category dispatch lists derived from listeners_, rebuilt when a Broadcaster/Listener relationship changes
+    WDL_PtrList<ZoneManager> subscribers_[NumListenerCategories];         // listeners in the category
+    WDL_PtrList<ZoneManager> goZoneTargets_[NumListenerCategories];       // listeners outside the category, and the listeners of those in it
+    WDL_PtrList<ZoneManager> clearFXZoneTargets_[NumListenerCategories];  // the listeners of listeners in the category
+    int subscribersGeneration_;
+    
+    void RefreshSubscribers();
 
     Zone *focusedFXParamZone_;
     bool isFocusedFXParamMappingEnabled_;
@@ -1135,10 +1426,15 @@ private:
 
     void GoFXSlot(MediaTrack *track, Navigator *navigator, int fxSlot);
     void GoSelectedTrackFX();
-    void GetWidgetNameAndModifiers(const char *line, string &baseWidgetName, int &modifier, bool &isValueInverted, bool &isFeedbackInverted, double &holdDelayAmount,
+    void GetWidgetNameAndModifiers(const char *line, string &baseWidgetName, int &modifier, bool &isValueInverted, bool &isFeedbackInverted, bool &isHold,
                                    bool &isDecrease, bool &isIncrease);
     void GetNavigatorsForZone(const char *zoneName, const char *navigatorName, ptrvector<Navigator *> &navigators);
     void LoadZones(ptrvector<Zone *> &zones, string_list &zoneList);
+    CSIZoneTemplate *GetZoneTemplate(const char *filePath);
+    Zone *GetFXZone(const char *fxName, Navigator *navigator, int fxSlot);
+    void LoadHomeAndGoZones();
+    void ReloadHomeAndGoZones();
+    bool IsHomeOrGoZoneFile(const char *filePath);
          
     void DoAction(Widget *widget, double value, bool &isUsed);
     void DoRelativeAction(Widget *widget, double delta, bool &isUsed);
@@ -1205,61 +1501,54 @@ private:
         selectedTrackFXMenuOffset_ = 0;
     }
    
-    bool GetIsListener()
-    {
-        return listensToGoHome_ || listensToSends_ || listensToReceives_ || listensToFocusedFX_ || listensToFocusedFXParam_ || listensToFXMenu_ || listensToLocalFXSlot_ || listensToSelectedTrackFX_;
-    }
-    
-    void ListenToGoZone(const char *zoneName)
-    {
-        if (!strcmp("SelectedTrackSend", zoneName) && listensToSends_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->GoZone(zoneName);
-        else if (!strcmp("SelectedTrackReceive", zoneName) && listensToReceives_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->GoZone(zoneName);
-        else if (!strcmp("SelectedTrackFX", zoneName) && listensToSelectedTrackFX_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->GoZone(zoneName);
-        else if (!strcmp("SelectedTrackFXMenu", zoneName) && listensToFXMenu_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->GoZone(zoneName);
+    bool GetIsListener() { return listenerCategories_ != 0; }
+    
+    const WDL_PtrList<ZoneManager> &GetSubscribers(ListenerCategory category) { RefreshSubscribers(); return subscribers_[category]; }
+    const WDL_PtrList<ZoneManager> &GetGoZoneTargets(ListenerCategory category) { RefreshSubscribers(); return goZoneTargets_[category]; }
+    const WDL_PtrList<ZoneManager> &GetClearFXZoneTargets(ListenerCategory category) { RefreshSubscribers(); return clearFXZoneTargets_[category]; }
+    
+    static bool GetGoZoneCategory(const char *zoneName, ListenerCategory &category)
+    {
+        if (!strcmp("SelectedTrackSend", zoneName))
+            category = ListenerCategory_Sends;
+        else if (!strcmp("SelectedTrackReceive", zoneName))
+            category = ListenerCategory_Receives;
+        else if (!strcmp("SelectedTrackFX", zoneName))
+            category = ListenerCategory_SelectedTrackFX;
+        else if (!strcmp("SelectedTrackFXMenu", zoneName))
+            category = ListenerCategory_FXMenu;
         else
-            GoZone(zoneName);
-    }
-    
-    void ListenToClearFXZone(const char *zoneToClear)
-    {
-        if (!strcmp("FocusedFXParam", zoneToClear) && listensToFocusedFXParam_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ClearFocusedFXParam();
-        else if (!strcmp("FocusedFX", zoneToClear) && listensToFocusedFX_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ClearFocusedFX();
-        else if (!strcmp("SelectedTrackFX", zoneToClear) && listensToSelectedTrackFX_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ClearSelectedTrackFX();
-        else if (!strcmp("FXSlot", zoneToClear) && listensToFXMenu_)
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ClearFXSlot();
+            return false;
+        
+        return true;
     }
     
-    void ListenToGoHome()
+    static bool GetClearFXZoneCategory(const char *zoneName, ListenerCategory &category)
     {
-        if (listensToGoHome_)
-            GoHome();
+        if (!strcmp("FocusedFXParam", zoneName))
+            category = ListenerCategory_FocusedFXParam;
+        else if (!strcmp("FocusedFX", zoneName))
+            category = ListenerCategory_FocusedFX;
+        else if (!strcmp("SelectedTrackFX", zoneName))
+            category = ListenerCategory_SelectedTrackFX;
+        else if (!strcmp("FXSlot", zoneName))
+            category = ListenerCategory_FXMenu;
+        else
+            return false;
+        
+        return true;
     }
     
-    void ListenToGoFXSlot(MediaTrack *track, Navigator *navigator, int fxSlot)
+    void ClearFXZone(ListenerCategory category)
     {
-        if (listensToFXMenu_)
-            GoFXSlot(track, navigator, fxSlot);
-    }
-
-    void ListenToToggleEnableFocusedFXParamMapping()
-    {
-        if (listensToFocusedFXParam_)
-            ToggleEnableFocusedFXParamMapping();
+        switch (category)
+        {
+            case ListenerCategory_FocusedFXParam:  ClearFocusedFXParam(); break;
+            case ListenerCategory_FocusedFX:       ClearFocusedFX(); break;
+            case ListenerCategory_SelectedTrackFX: ClearSelectedTrackFX(); break;
+            case ListenerCategory_FXMenu:          ClearFXSlot(); break;
+            default: break;
+        }
     }
 
     void ToggleEnableFocusedFXParamMapping()
@@ -1275,12 +1564,6 @@ private:
         }
     }
 
-    void ListenToToggleEnableFocusedFXMapping()
-    {
-        if (listensToFocusedFX_)
-            ToggleEnableFocusedFXMapping();
-    }
-
     void ToggleEnableFocusedFXMapping()
     {
         isFocusedFXMappingEnabled_ = ! isFocusedFXMappingEnabled_;
@@ -1292,13 +1575,67 @@ private:
             focusedFXParamZone_->Deactivate();
     }
     
+    void RetireZone(Zone *zone)
+    {
+        zone->Deactivate();
+        if (zonePool_.Find(zone) == -1)
+            zonePool_.Add(zone);
+    }
+    
+    Zone *GetPooledZone(const char *name, Navigator *navigator, int slotIndex)
+    {
+        for (int i = zonePool_.GetSize() - 1; i >= 0; --i)
+        {
+            Zone *zone = zonePool_.Get(i);
+            
+            if (zone->GetNavigator() == navigator && zone->GetSlotIndex() == slotIndex && !strcmp(zone->GetName(), name))
+            {
+                zonePool_.Delete(i);
+                return zone;
+            }
+        }
+        
+        return NULL;
+    }
+    
+    void InvalidateZoneFile(const char *filePath)
+    {
+        zoneTemplates_.Delete(filePath);
+        
+        for (int i = 0; i < zoneDefinitions_->zoneManagers.GetSize(); ++i)
+            zoneDefinitions_->zoneManagers.Get(i)->DiscardPooledZones(filePath);
+    }
+    
+    void DiscardPooledZones(const char *filePath)
+    {
+        for (int i = zonePool_.GetSize() - 1; i >= 0; --i)
+        {
+            if (!strcmp(zonePool_.Get(i)->GetSourceFilePath(), filePath))
+            {
+                zonesToBeDeleted_.Add(zonePool_.Get(i));
+                zonePool_.Delete(i);
+            }
+        }
+    }
+    
+    void ReclaimZones()
+    {
+        if (zonesToBeDeleted_.GetSize() == 0 && zonePool_.GetSize() <= MaxPooledZones)
+            return;
+        
+        zonesToBeDeleted_.Empty(true);
+        
+        while (zonePool_.GetSize() > MaxPooledZones)
+            zonePool_.Delete(0, true);
+        
+        ReclaimFixedTrackNavigators();
+    }
+    
     void ClearFocusedFX()
     {
         if (focusedFXZone_ != NULL)
         {
-            focusedFXZone_->Deactivate();
-            if (zonesToBeDeleted_.Find(focusedFXZone_) == -1)
-                zonesToBeDeleted_.Add(focusedFXZone_);
+            RetireZone(focusedFXZone_);
             focusedFXZone_ = NULL;
         }
     }
@@ -1306,22 +1643,16 @@ private:
     void ClearSelectedTrackFX()
     {
         for (int i = 0; i < (int)selectedTrackFXZones_.size(); ++i)
-        {
-            selectedTrackFXZones_[i]->Deactivate();
-            if (zonesToBeDeleted_.Find(selectedTrackFXZones_[i]) == -1)
-                zonesToBeDeleted_.Add(selectedTrackFXZones_[i]);
-        }
+            RetireZone(selectedTrackFXZones_[i]);
         
-        selectedTrackFXZones_.Empty();
+        selectedTrackFXZones_.clear();
     }
     
     void ClearFXSlot()
     {
         if (fxSlotZone_ != NULL)
         {
-            fxSlotZone_->Deactivate();
-            if (zonesToBeDeleted_.Find(fxSlotZone_) == -1)
-                zonesToBeDeleted_.Add(fxSlotZone_);
+            RetireZone(fxSlotZone_);
             fxSlotZone_ = NULL;
             ReactivateFXMenuZone();
         }
@@ -1340,6 +1671,8 @@ public:
 
     ~ZoneManager()
     {
+        zoneDefinitions_->zoneManagers.DeletePtr(this);
+        
         if (homeZone_ != NULL)
         {
             delete homeZone_;
@@ -1370,9 +1703,15 @@ public:
             learnFocusedFXZone_ = NULL;
         }
             
+        for (int i = 0; i < goZones_.size(); ++i)
+            delete goZones_[i];
+        
         goZones_.clear();
 
         selectedTrackFXZones_.Empty(true);
+        
+        zonePool_.Empty(true);
+        zonesToBeDeleted_.Empty(true);
     }
     
     void Initialize();
@@ -1380,11 +1719,13 @@ public:
     void SetHoldDelayAmount(double value) { holdDelayAmount_ = value; }
 
     Navigator *GetNavigatorForTrack(MediaTrack* track);
+    void ReclaimFixedTrackNavigators();
     Navigator *GetMasterTrackNavigator();
     Navigator *GetSelectedTrackNavigator();
     Navigator *GetFocusedFXNavigator();
     
     bool GetIsBroadcaster() { return  ! (listeners_.size() == 0); }
+    bool GetListensTo(ListenerCategory category) { return (listenerCategories_ & (1 << category)) != 0; }
     void AddListener(ControlSurface *surface);
     void SetListenerCategories(PropertyList &pList);
     const ptrvector<ZoneManager *> &GetListeners() { return listeners_; }
@@ -1393,6 +1734,7 @@ public:
     
     void PreProcessZones();
     void PreProcessZoneFile(const char *filePath);
+    void ReloadZoneFile(const char *filePath, int reloadSerial);
     void LoadZoneFile(Zone *zone, const char *widgetSuffix);
     void LoadZoneFile(Zone *zone, const char *filePath, const char *widgetSuffix);
 
@@ -1406,6 +1748,7 @@ public:
     
     const char *GetFXZoneFolder() { return fxZoneFolder_.c_str(); }
     const WDL_StringKeyedArray<CSIZoneInfo*> &GetZoneInfo() { return zoneInfo_; }
+    void AddUnresolvedZoneName(const char *zoneName) { unresolvedZoneNames_.Insert(zoneName, true); }
 
     CSurfIntegrator *GetCSI() { return csi_; }
     ControlSurface *GetSurface() { return surface_; }
@@ -1532,8 +1875,19 @@ public:
         if (! GetIsBroadcaster() && ! GetIsListener()) // No Broadcasters/Listeners relationships defined
             GoZone(zoneName);
         else
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ListenToGoZone(zoneName);
+        {
+            ListenerCategory category;
+            
+            if (GetGoZoneCategory(zoneName, category))
+            {
+                const WDL_PtrList<ZoneManager> &targets = GetGoZoneTargets(category);
+                for (int i = 0; i < targets.GetSize(); ++i)
+                    targets.Get(i)->GoZone(zoneName);
+            }
+            else
+                for (int i = 0; i < listeners_.size(); ++i)
+                    listeners_[i]->GoZone(zoneName);
+        }
     }
     
     void GoZone(const char *zoneName)
@@ -1570,29 +1924,31 @@ public:
     
     void DeclareClearFXZone(const char *zoneName)
     {
+        ListenerCategory category;
+        
+        if ( ! GetClearFXZoneCategory(zoneName, category))
+            return;
+        
         if (! GetIsBroadcaster() && ! GetIsListener()) // No Broadcasters/Listeners relationships defined
+            ClearFXZone(category);
+        else
         {
-            if (!strcmp("FocusedFXParam", zoneName))
-                ClearFocusedFXParam();
-            else if (!strcmp("FocusedFX", zoneName))
-                ClearFocusedFX();
-            else if (!strcmp("SelectedTrackFX", zoneName))
-                ClearSelectedTrackFX();
-            else if (!strcmp("FXSlot", zoneName))
-                ClearFXSlot();
+            const WDL_PtrList<ZoneManager> &targets = GetClearFXZoneTargets(category);
+            for (int i = 0; i < targets.GetSize(); ++i)
+                targets.Get(i)->ClearFXZone(category);
         }
-        else
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ListenToClearFXZone(zoneName);
     }
     
     void DeclareGoFXSlot(MediaTrack *track, Navigator *navigator, int fxSlot)
     {
-        if (listensToLocalFXSlot_ || (! GetIsBroadcaster() && ! GetIsListener())) // No Broadcasters/Listeners relationships defined
+        if (GetListensTo(ListenerCategory_LocalFXSlot) || (! GetIsBroadcaster() && ! GetIsListener())) // No Broadcasters/Listeners relationships defined
             GoFXSlot(track, navigator, fxSlot);
         else
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ListenToGoFXSlot(track, navigator, fxSlot);
+        {
+            const WDL_PtrList<ZoneManager> &subscribers = GetSubscribers(ListenerCategory_FXMenu);
+            for (int i = 0; i < subscribers.GetSize(); ++i)
+                subscribers.Get(i)->GoFXSlot(track, navigator, fxSlot);
+        }
     }
                 
     void RemoveZone(const char *zoneName)
@@ -1658,8 +2014,11 @@ public:
         if (! GetIsBroadcaster() && ! GetIsListener()) // No Broadcasters/Listeners relationships defined
             GoHome();
         else
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ListenToGoHome();
+        {
+            const WDL_PtrList<ZoneManager> &subscribers = GetSubscribers(ListenerCategory_GoHome);
+            for (int i = 0; i < subscribers.GetSize(); ++i)
+                subscribers.Get(i)->GoHome();
+        }
     }
         
     void OnTrackSelection()
@@ -1693,8 +2052,11 @@ public:
         if (! GetIsBroadcaster() && ! GetIsListener()) // No Broadcasters/Listeners relationships defined
             ToggleEnableFocusedFXParamMapping();
         else
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ListenToToggleEnableFocusedFXParamMapping();
+        {
+            const WDL_PtrList<ZoneManager> &subscribers = GetSubscribers(ListenerCategory_FocusedFXParam);
+            for (int i = 0; i < subscribers.GetSize(); ++i)
+                subscribers.Get(i)->ToggleEnableFocusedFXParamMapping();
+        }
     }
 
     void DeclareToggleEnableFocusedFXMapping()
@@ -1702,8 +2064,11 @@ public:
         if (! GetIsBroadcaster() && ! GetIsListener()) // No Broadcasters/Listeners relationships defined
             ToggleEnableFocusedFXMapping();
         else
-            for (int i = 0; i < listeners_.size(); ++i)
-                listeners_[i]->ListenToToggleEnableFocusedFXMapping();
+        {
+            const WDL_PtrList<ZoneManager> &subscribers = GetSubscribers(ListenerCategory_FocusedFX);
+            for (int i = 0; i < subscribers.GetSize(); ++i)
+                subscribers.Get(i)->ToggleEnableFocusedFXMapping();
+        }
     }
     
     bool GetIsGoZoneActive(const char *zoneName)
@@ -1757,6 +2122,8 @@ public:
         info->alias = zoneInfo.alias;
         info->filePath = zoneInfo.filePath;
         
+        InvalidateZoneFile(zoneInfo.filePath.c_str()); // the file may have just been (re)written by Learn
+        
         if ( ! zoneInfo_.Exists(name) && name && *name)
             zoneInfo_.Insert(name, info);
         else
@@ -1790,6 +2157,8 @@ public:
 
         if (homeZone_ != NULL)
             homeZone_->RequestUpdate();
+        
+        ReclaimZones();
     }
 };
 
@@ -1913,7 +2282,9 @@ private:
         DWORD pressedTime;
     };
     ModifierState modifiers_[MaxModifiers];
-    WDL_TypedBuf<int> modifierCombinations_;
+    int engagedModifiers_; // mask of every engaged modifier
+    WDL_TypedBuf<int> modifierCombinations_; // built from engagedModifiers_ on demand
+    bool modifierCombinationsDirty_;
     static int intcmp_rev(const void *a, const void *b) { return *(const int *)a > *(const int *)b ? -1 : *(const int *)a < *(const int *)b ? 1 : 0; }
     
     void GetCombinations(const Modifiers *indices, int num_indices, WDL_TypedBuf<int> &combinations)
@@ -1941,14 +2312,18 @@ public:
         surface_ = surface;
         latchTime_ = 100;
 
+        engagedModifiers_ = 0;
+        
         int *p = modifierCombinations_.ResizeOK(1);
         if (WDL_NORMALLY(p)) p[0]=0;
+        modifierCombinationsDirty_ = false;
 
         memset(modifiers_,0,sizeof(modifiers_));
     }
     
     void RecalculateModifiers();
-    const WDL_TypedBuf<int> &GetModifiers() { return modifierCombinations_; }
+    const WDL_TypedBuf<int> &GetModifiers();
+    int GetEngagedModifiers() { return engagedModifiers_; } // same as GetModifiers().Get()[0]
     
     bool GetShift() { return modifiers_[Shift].isEngaged; }
     bool GetOption() { return modifiers_[Option].isEngaged; }
@@ -2161,6 +2536,13 @@ private:
         
     WDL_PtrList<FeedbackProcessor> trackColorFeedbackProcessors_; // does not own pointers
     
+    // Per-channel track colors, polled once per tick -- processors only hear about real color or bank changes
+    WDL_TypedBuf<MediaTrack*> colorTracks_;
+    WDL_TypedBuf<int> nativeTrackColors_;
+    WDL_TypedBuf<rgba_color> trackColors_;
+    
+    bool RefreshTrackColors();
+    
     WDL_TypedBuf<ChannelTouch> channelTouches_;
     WDL_TypedBuf<ChannelToggle> channelToggles_;
 
@@ -2192,6 +2574,8 @@ protected:
     static void disposeAction(CSIMessageGenerator *messageGenerator) { delete messageGenerator; }
 
     bool speedX5_;
+    
+    double inputTime_; // when the message now being processed arrived, for feedback latency tracing
 
     ControlSurface(CSurfIntegrator *const csi, Page *page, const string &name, int numChannels, int channelOffset) : csi_(csi), page_(page), name_(name), numChannels_(numChannels), channelOffset_(channelOffset), CSIMessageGeneratorsByMessage_(true, disposeAction), accelerationValues_(true, disposeAccelValues),
         accelerationValuesForDecrement_(true, disposeIncDecAccelValues), accelerationValuesForIncrement_(true, disposeIncDecAccelValues)
@@ -2215,6 +2599,7 @@ protected:
         zoneManager_ = NULL;
         modifierManager_ = new ModifierManager(csi_, NULL, this);
         speedX5_ = false;
+        inputTime_ = 0.0;
         
         int size = 0;
         scrubModePtr_ = (int*)get_config_var("scrubmode", &size);
@@ -2309,6 +2694,8 @@ public:
     ZoneManager *GetZoneManager() { return zoneManager_; }
     Page *GetPage() { return page_; }
     const char *GetName() { return name_.c_str(); }
+    double GetInputTime() { return inputTime_; }
+    void SetInputTime(double inputTime) { inputTime_ = inputTime; } // set by the IO before each message it hands over
     
     int GetNumChannels() { return numChannels_; }
     int GetChannelOffset() { return channelOffset_; }
@@ -2442,6 +2829,9 @@ public:
         for (int i = 0; i < widgets_.GetSize(); ++i)
             widgets_.Get(i)->ForceClear();
         
+        // Cleared color LEDs no longer match the cache, so the next RequestUpdate must resend every channel
+        trackColors_.Resize(0);
+        
         FlushIO();
     }
            
@@ -2578,6 +2968,7 @@ public:
     void SetScrub(bool value);
     
     const WDL_TypedBuf<int> &GetModifiers();
+    int GetEngagedModifiers();
     void ClearModifiers();
     void ClearModifier(const char *modifier);
 
@@ -2694,6 +3085,46 @@ public:
 void ReleaseMidiInput(midi_Input *input);
 void ReleaseMidiOutput(midi_Output *output);
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class CSITrafficLog
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Raw surface traffic, written to /CSI/Traffic/<surface>.csitraffic while g_recordSurfaceTraffic is set,
+    // and recorded input fed back through the owning IO on request.
+    // File: "CSIT" and an int version, then records of double seconds since recording began, char isOutput, int size, size bytes
+private:
+    string const name_;
+    FILE *file_;
+    double startTime_;
+    
+    WDL_HeapBuf replay_; // the input records of the file being replayed
+    int replayPosition_;
+    double replayStartTime_; // < 0 replays as fast as possible
+    
+    void Write(bool isOutput, const void *data, int size, double eventTime);
+    
+public:
+    CSITrafficLog(const char *name) : name_(name), file_(NULL), startTime_(0.0), replayPosition_(0), replayStartTime_(0.0) {}
+    ~CSITrafficLog() { Stop(); }
+    
+    void Record(bool isOutput, const void *data, int size, double eventTime = -1.0) // eventTime in time_precise() seconds, < 0 = now
+    {
+        if (g_recordSurfaceTraffic || file_ != NULL)
+            Write(isOutput, data, size, eventTime >= 0.0 ? eventTime : time_precise());
+    }
+    
+    void Update() // closes the file once recording has been switched off
+    {
+        if (file_ != NULL && ! g_recordSurfaceTraffic)
+            Stop();
+    }
+    
+    void Stop();
+    
+    bool StartReplay(const char *filePath, bool isRealTime); // NULL or empty filePath replays the surface's own recording
+    bool GetNextReplayed(const unsigned char *&data, int &size); // next recorded input that is due
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Midi_ControlSurfaceIO
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2706,15 +3137,21 @@ protected:
     midi_Output *const midiOutput_;
     WDL_Queue messageQueue_;
     const int maxMesssagesPerRun_;
+    WDL_Queue injectedMessages_; // int size-prefixed messages from InjectMidiMessage, consumed by the next HandleExternalInput
+    WDL_HeapBuf injectedMessage_; // the injected message being processed, grown to fit long SysEx
+    double lastSwapTime_; // input frame offsets count from here
+    CSITrafficLog trafficLog_;
     
     void SendMidiSysexMessage(MIDI_event_ex_t *midiMessage)
     {
+        trafficLog_.Record(true, midiMessage->midi_message, midiMessage->size);
+        
         if (midiOutput_)
             midiOutput_->SendMsg(midiMessage, -1);
     }
 
 public:
-    Midi_ControlSurfaceIO(CSurfIntegrator *csi, const char *name, int channelCount, midi_Input *midiInput, midi_Output *midiOutput, int surfaceRefreshRate, int maxMesssagesPerRun) : csi_(csi), name_(name), channelCount_(channelCount), midiInput_(midiInput), midiOutput_(midiOutput), surfaceRefreshRate_(surfaceRefreshRate), maxMesssagesPerRun_(maxMesssagesPerRun) {}
+    Midi_ControlSurfaceIO(CSurfIntegrator *csi, const char *name, int channelCount, midi_Input *midiInput, midi_Output *midiOutput, int surfaceRefreshRate, int maxMesssagesPerRun) : csi_(csi), name_(name), channelCount_(channelCount), midiInput_(midiInput), midiOutput_(midiOutput), surfaceRefreshRate_(surfaceRefreshRate), maxMesssagesPerRun_(maxMesssagesPerRun), lastSwapTime_(0.0), trafficLog_(name) {}
 
     ~Midi_ControlSurfaceIO()
     {
@@ -2730,6 +3167,14 @@ public:
 
     void HandleExternalInput(Midi_ControlSurface *surface);
     
+    void InjectMidiMessage(const unsigned char *message, int size) // processed as if it arrived on the MIDI input, works without a device
+    {
+        if (WDL_NOT_NORMALLY(size < 1)) return;
+
+        injectedMessages_.Add(&size, sizeof(int));
+        injectedMessages_.Add(message, size);
+    }
+    
     void QueueMidiSysExMessage(MIDI_event_ex_t *midiMessage)
     {
         if (WDL_NOT_NORMALLY(midiMessage->size > 255)) return;
@@ -2741,12 +3186,19 @@ public:
 
     void SendMidiMessage(int first, int second, int third)
     {
+        const unsigned char message[3] = { (unsigned char)first, (unsigned char)second, (unsigned char)third };
+        trafficLog_.Record(true, message, sizeof(message));
+        
         if (midiOutput_)
             midiOutput_->Send(first, second, third, -1);
     }
     
+    bool StartReplay(const char *filePath, bool isRealTime) { return trafficLog_.StartReplay(filePath, isRealTime); }
+    
     void Run()
     {
+        trafficLog_.Update();
+        
         int numSent = 0;
         
         while ((maxMesssagesPerRun_ == 0 || numSent < maxMesssagesPerRun_) && messageQueue_.Available() >= 1)
@@ -2928,6 +3380,12 @@ protected:
     int maxPacketsPerRun_; // 0 = no limit
     int sentPacketCount_; // count of packets sent this Run() slice, after maxPacketsPerRun_ packtees go into packetQueue_
     WDL_Queue packetQueue_;
+    WDL_Queue injectedPackets_; // size-prefixed packets from InjectPacket, read after the socket's packets
+    WDL_HeapBuf injectedPacket_; // the injected packet packetReader_ is currently parsing
+    double packetTime_; // when the packet packetReader_ is parsing was read off the socket or dequeued
+    CSITrafficLog trafficLog_;
+    
+    bool ReceiveNextPacket();
     
 public:
     OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const char *name, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun);
@@ -2939,10 +3397,21 @@ public:
     
     virtual void HandleExternalInput(OSC_ControlSurface *surface);
 
+    void InjectPacket(const void *p, int sz) // processed as if it arrived on the receive port, works without a socket
+    {
+        if (WDL_NOT_NORMALLY(!p || sz < 1)) return;
+        
+        injectedPackets_.Add(&sz, sizeof(int));
+        injectedPackets_.Add(p, sz);
+    }
+
+    bool StartReplay(const char *filePath, bool isRealTime) { return trafficLog_.StartReplay(filePath, isRealTime); }
+
     void QueuePacket(const void *p, int sz)
     {
         if (WDL_NOT_NORMALLY(!outSocket_)) return;
         if (WDL_NOT_NORMALLY(!p || sz < 1)) return;
+        trafficLog_.Record(true, p, sz);
         if (WDL_NOT_NORMALLY(packetQueue_.GetSize() > 32*1024*1024)) return; // drop packets after 32MB queued
         if (maxPacketsPerRun_ != 0 && sentPacketCount_ >= maxPacketsPerRun_)
         {
@@ -3047,6 +3516,8 @@ public:
     
     void BeginRun()
     {
+        trafficLog_.Update();
+        
         sentPacketCount_ = 0;
         // send any latent packets first
         while (packetQueue_.GetSize()>=sizeof(int))
@@ -3161,6 +3632,11 @@ protected:
     int selectedTracksOffset_;
     WDL_PtrList<MediaTrack> tracks_;
     WDL_PtrList<MediaTrack> selectedTracks_;
+    bool selectedTracksValid_;
+    
+    WDL_TypedBuf<MediaTrack*> allTracks_; // every track in CSurf id order, compared each tick to detect list changes
+    WDL_PointerKeyedArray<MediaTrack*, int> trackIds_; // track -> CSurf id, rebuilt only when allTracks_ changes
+    bool trackIdsValid_;
     
     WDL_PtrList<MediaTrack> vcaTopLeadTracks_;
     MediaTrack             *vcaLeadTrack_;
@@ -3174,12 +3650,59 @@ protected:
     WDL_PointerKeyedArray<MediaTrack*, WDL_PtrList<MediaTrack>* > folderDictionary_;
     static void disposeFolderParents(WDL_PtrList<MediaTrack> *parent) { delete parent;  }
  
-    WDL_PtrList<Navigator> fixedTrackNavigators_;
+    enum { NumFixedTrackNavigatorBuckets = 64 };
+    WDL_PtrList<Navigator> fixedTrackNavigators_[NumFixedTrackNavigatorBuckets]; // hashed by track, see GetFixedTrackNavigatorBucket
+    static int GetFixedTrackNavigatorBucket(MediaTrack *track) { return (int)((((UINT_PTR)track >> 4) ^ ((UINT_PTR)track >> 12)) % NumFixedTrackNavigatorBuckets); }
     WDL_PtrList<Navigator> trackNavigators_;
     Navigator *const masterTrackNavigator_;
     Navigator *selectedTrackNavigator_;
     Navigator *focusedFXNavigator_;
     
+    WDL_TypedBuf<MediaTrack*> channelTracks_; // channel -> track, resolved in one pass after each tick or navigation change
+    bool channelTracksValid_;
+    
+    void InvalidateChannelTracks() { channelTracksValid_ = false; }
+    
+    void RebuildChannelTracks()
+    {
+        int numChannels = 0;
+        
+        for (int i = 0; i < trackNavigators_.GetSize(); ++i)
+            if (trackNavigators_.Get(i)->GetChannelNum() + 1 > numChannels)
+                numChannels = trackNavigators_.Get(i)->GetChannelNum() + 1;
+        
+        MediaTrack **channelTracks = channelTracks_.ResizeOK(numChannels, false);
+        
+        if (channelTracks == NULL)
+            numChannels = 0;
+        
+        for (int i = 0; i < numChannels; ++i)
+            channelTracks[i] = ResolveTrackFromChannel(i);
+        
+        channelTracksValid_ = true;
+    }
+    
+    MediaTrack *ResolveTrackFromChannel(int channelNumber);
+    
+    bool RefreshSelectedTracks();
+    
+    int GetCachedIdFromTrack(MediaTrack *track)
+    {
+        if ( ! trackIdsValid_)
+        {
+            trackIds_.DeleteAll();
+            
+            for (int i = 0; i < allTracks_.GetSize(); ++i)
+                trackIds_.AddUnsorted(allTracks_.Get()[i], i + 1);
+            
+            trackIds_.Resort();
+            
+            trackIdsValid_ = true;
+        }
+        
+        return trackIds_.Get(track, 0);
+    }
+    
     void ForceScrollLink()
     {
         // Make sure selected track is visble on the control surface
@@ -3191,16 +3714,16 @@ protected:
                 if (selectedTrack == trackNavigators_.Get(i)->GetTrack())
                     return;
             
-            for (int i = 1; i <= GetNumTracks(); ++i)
-            {
-                if (selectedTrack == GetTrackFromId(i))
-                {
-                    trackOffset_ = i - 1;
-                    break;
-                }
-            }
+            int trackId = GetCachedIdFromTrack(selectedTrack);
             
-            trackOffset_ -= targetScrollLinkChannel_;
+            // The index is only rebuilt on the next tick, so a track list change may have left it stale -- confirm the hit, ask REAPER on a miss
+            if (trackId <= 0 || GetTrackFromId(trackId) != selectedTrack)
+                trackId = GetIdFromTrack(selectedTrack);
+            
+            if (trackId <= 0)
+                return;
+            
+            trackOffset_ = trackId - 1 - targetScrollLinkChannel_;
             
             if (trackOffset_ <  0)
                 trackOffset_ =  0;
@@ -3209,6 +3732,8 @@ protected:
             
             if (trackOffset_ >  top)
                 trackOffset_ = top;
+            
+            InvalidateChannelTracks();
         }
     }
     
@@ -3234,6 +3759,9 @@ public:
         selectedTracksOffset_ = 0;
         vcaLeadTrack_ = NULL;
         folderParentTrack_ = NULL;
+        channelTracksValid_ = false;
+        selectedTracksValid_ = false;
+        trackIdsValid_ = false;
     }
     
     ~TrackNavigationManager()
@@ -3242,7 +3770,8 @@ public:
         delete selectedTrackNavigator_;
         delete focusedFXNavigator_;
         
-        fixedTrackNavigators_.Empty(true);
+        for (int i = 0; i < NumFixedTrackNavigatorBuckets; ++i)
+            fixedTrackNavigators_[i].Empty(true);
         trackNavigators_.Empty(true);
     }
     
@@ -3252,6 +3781,8 @@ public:
     bool GetSynchPages() { return synchPages_; }
     bool GetScrollLink() { return isScrollLinkEnabled_; }
     int  GetNumTracks() { return CSurf_NumTracks(followMCP_); }
+    int  GetNumVisibleTracks() { return tracks_.GetSize(); }
+    int  GetNumTrackNavigators() { return trackNavigators_.GetSize(); }
     Navigator *GetMasterTrackNavigator() { return masterTrackNavigator_; }
     Navigator *GetSelectedTrackNavigator() { return selectedTrackNavigator_; }
     Navigator *GetFocusedFXNavigator() { return focusedFXNavigator_; }
@@ -3263,33 +3794,45 @@ public:
     
     void VCAModeActivated()
     {
+        InvalidateChannelTracks();
+        
         currentTrackVCAFolderMode_ = 1;
     }
     
     void FolderModeActivated()
     {
+        InvalidateChannelTracks();
+        
         currentTrackVCAFolderMode_ = 2;
     }
     
     void SelectedTracksModeActivated()
     {
+        InvalidateChannelTracks();
+        
         currentTrackVCAFolderMode_ = 3;
     }
     
     void VCAModeDeactivated()
     {
+        InvalidateChannelTracks();
+        
         if (currentTrackVCAFolderMode_ == 1)
             currentTrackVCAFolderMode_ = 0;
     }
     
     void FolderModeDeactivated()
     {
+        InvalidateChannelTracks();
+        
         if (currentTrackVCAFolderMode_ == 2)
             currentTrackVCAFolderMode_ = 0;
     }
     
     void SelectedTracksModeDeactivated()
     {
+        InvalidateChannelTracks();
+        
         if (currentTrackVCAFolderMode_ == 3)
             currentTrackVCAFolderMode_ = 0;
     }
@@ -3405,10 +3948,8 @@ public:
     
     const WDL_PtrList<MediaTrack> &GetSelectedTracks()
     {
-        selectedTracks_.Empty();
-        
-        for (int i = 0; i < CountSelectedTracks2(NULL, false); ++i)
-            selectedTracks_.Add(DAW::GetSelectedTrack(i));
+        if ( ! selectedTracksValid_ && RefreshSelectedTracks() && currentTrackVCAFolderMode_ == 3)
+            InvalidateChannelTracks();
         
         return selectedTracks_;
     }
@@ -3416,7 +3957,10 @@ public:
     void SetTrackOffset(int trackOffset)
     {
         if (isScrollSynchEnabled_)
+        {
             trackOffset_ = trackOffset;
+            InvalidateChannelTracks();
+        }
     }
     
     void AdjustTrackBank(int amount)
@@ -3424,6 +3968,8 @@ public:
         if (currentTrackVCAFolderMode_ != 0)
             return;
 
+        InvalidateChannelTracks();
+        
         int numTracks = tracks_.GetSize();
         
         if (numTracks <= trackNavigators_.GetSize())
@@ -3455,6 +4001,8 @@ public:
         if (currentTrackVCAFolderMode_ != 1)
             return;
 
+        InvalidateChannelTracks();
+        
         int numTracks = vcaSpillTracks_.GetSize();
             
         if (numTracks <= trackNavigators_.GetSize())
@@ -3476,6 +4024,8 @@ public:
         if (currentTrackVCAFolderMode_ != 2)
             return;
 
+        InvalidateChannelTracks();
+        
         int numTracks = folderSpillTracks_.GetSize();
         
         if (numTracks <= trackNavigators_.GetSize())
@@ -3497,6 +4047,8 @@ public:
         if (currentTrackVCAFolderMode_ != 3)
             return;
 
+        InvalidateChannelTracks();
+        
         int numTracks = selectedTracks_.GetSize();
        
         if (numTracks <= trackNavigators_.GetSize())
@@ -3522,89 +4074,45 @@ public:
         TrackNavigator *newNavigator = new TrackNavigator(csi_, page_, this, channelNum);
         
         trackNavigators_.Add(newNavigator);
+        
+        InvalidateChannelTracks();
             
         return newNavigator;
     }
     
     Navigator *GetNavigatorForTrack(MediaTrack *track)
     {
-        for (int i = 0; i < fixedTrackNavigators_.GetSize(); ++i)
-            if (fixedTrackNavigators_.Get(i)->GetTrack() == track)
-                return fixedTrackNavigators_.Get(i);
+        WDL_PtrList<Navigator> &bucket = fixedTrackNavigators_[GetFixedTrackNavigatorBucket(track)];
+        
+        for (int i = 0; i < bucket.GetSize(); ++i)
+            if (bucket.Get(i)->GetTrack() == track)
+                return bucket.Get(i);
           
         FixedTrackNavigator *newNavigator = new FixedTrackNavigator(csi_, page_, track);
         
-        fixedTrackNavigators_.Add(newNavigator);
+        bucket.Add(newNavigator);
             
         return newNavigator;
     }
     
+    void ReclaimFixedTrackNavigators()
+    {
+        // Called once Zones have been deleted, so a navigator no Zone refers to any more can go
+        for (int b = 0; b < NumFixedTrackNavigatorBuckets; ++b)
+            for (int i = fixedTrackNavigators_[b].GetSize() - 1; i >= 0; --i)
+                if (fixedTrackNavigators_[b].Get(i)->GetZoneReferences() == 0)
+                    fixedTrackNavigators_[b].Delete(i, true);
+    }
+    
     MediaTrack *GetTrackFromChannel(int channelNumber)
-    {       
-        if (currentTrackVCAFolderMode_ == 0)
-        {
-            if (channelNumber + trackOffset_ < GetNumTracks() && channelNumber + trackOffset_ < tracks_.GetSize())
-                return tracks_.Get(channelNumber + trackOffset_);
-            else
-                return NULL;
-        }
-        else if (currentTrackVCAFolderMode_ == 1)
-        {
-            if (vcaLeadTrack_ == NULL)
-            {
-                if (channelNumber < vcaTopLeadTracks_.GetSize() && DAW::ValidateTrackPtr(vcaTopLeadTracks_.Get(channelNumber)))
-                    return vcaTopLeadTracks_.Get(channelNumber);
-                else
-                    return NULL;
-            }
-            else
-            {
-                if (channelNumber == 0 && vcaSpillTracks_.GetSize() > 0 && DAW::ValidateTrackPtr(vcaSpillTracks_.Get(channelNumber)))
-                    return vcaSpillTracks_.Get(channelNumber);
-                else if (vcaTrackOffset_ == 0 && channelNumber < vcaSpillTracks_.GetSize() && DAW::ValidateTrackPtr(vcaSpillTracks_.Get(channelNumber)))
-                    return vcaSpillTracks_.Get(channelNumber);
-                else
-                {
-                    channelNumber += vcaTrackOffset_;
-                    
-                    if (channelNumber < vcaSpillTracks_.GetSize() && DAW::ValidateTrackPtr(vcaSpillTracks_.Get(channelNumber)))
-                        return vcaSpillTracks_.Get(channelNumber);
-                }
-            }
-        }
-        else if (currentTrackVCAFolderMode_ == 2)
-        {
-            if (folderParentTrack_ == NULL)
-            {
-                if (channelNumber < folderTopParentTracks_.GetSize() && DAW::ValidateTrackPtr(folderTopParentTracks_.Get(channelNumber)))
-                    return folderTopParentTracks_.Get(channelNumber);
-                else
-                    return NULL;
-            }
-            else
-            {
-                if (channelNumber == 0 && folderSpillTracks_.GetSize() > 0 && DAW::ValidateTrackPtr(folderSpillTracks_.Get(channelNumber)))
-                    return folderSpillTracks_.Get(channelNumber);
-                else if (folderTrackOffset_ == 0 && channelNumber < folderSpillTracks_.GetSize() && DAW::ValidateTrackPtr(folderSpillTracks_.Get(channelNumber)))
-                    return folderSpillTracks_.Get(channelNumber);
-                else
-                {
-                    channelNumber += folderTrackOffset_;
-                    
-                    if (channelNumber < folderSpillTracks_.GetSize() && DAW::ValidateTrackPtr(folderSpillTracks_.Get(channelNumber)))
-                        return folderSpillTracks_.Get(channelNumber);
-                }
-            }
-        }
-        else if (currentTrackVCAFolderMode_ == 3)
-        {
-            if (channelNumber + selectedTracksOffset_ >= selectedTracks_.GetSize())
-                return NULL;
-            else
-                return selectedTracks_.Get(channelNumber + selectedTracksOffset_);
-        }
+    {
+        if ( ! channelTracksValid_)
+            RebuildChannelTracks();
         
-        return NULL;
+        if (channelNumber >= 0 && channelNumber < channelTracks_.GetSize())
+            return channelTracks_.Get()[channelNumber];
+        
+        return ResolveTrackFromChannel(channelNumber);
     }
     
     MediaTrack *GetTrackFromId(int trackNumber)
@@ -3657,6 +4165,8 @@ public:
             vcaLeadTrack_ = track;
        
         vcaTrackOffset_ = 0;
+        
+        InvalidateChannelTracks();
     }
 
     bool GetIsFolderSpilled(MediaTrack *track)
@@ -3699,6 +4209,8 @@ public:
             folderParentTrack_ = track;
        
         folderTrackOffset_ = 0;
+        
+        InvalidateChannelTracks();
     }
     
     void ToggleSynchPages()
@@ -3727,18 +4239,25 @@ public:
        
     void OnTrackSelection()
     {
+        selectedTracksValid_ = false;
+        
         if (isScrollLinkEnabled_ && tracks_.GetSize() > trackNavigators_.GetSize())
             ForceScrollLink();
     }
     
     void OnTrackListChange()
     {
+        InvalidateChannelTracks();
+        selectedTracksValid_ = false;
+        
         if (isScrollLinkEnabled_ && tracks_.GetSize() > trackNavigators_.GetSize())
             ForceScrollLink();
     }
 
     void OnTrackSelectionBySurface(MediaTrack *track)
     {
+        selectedTracksValid_ = false;
+        
         if (isScrollLinkEnabled_)
         {
             if (IsTrackVisible(track, true))
@@ -3792,17 +4311,26 @@ public:
         if (currentTrackVCAFolderMode_ != 1)
             return;
     
+        InvalidateChannelTracks();
+        
         vcaTopLeadTracks_.Empty();
         vcaSpillTracks_.Empty();
         
         unsigned int leadTrackVCALeaderGroup = 0;
         unsigned int leadTrackVCALeaderGroupHigh = 0;
         
+        // Every other track here was just fetched by index, so the lead is the only one that can have gone stale --
+        // checking it once keeps ResolveTrackFromChannel from validating a track per channel
         if (vcaLeadTrack_ != NULL)
         {
-            leadTrackVCALeaderGroup = DAW::GetTrackGroupMembership(vcaLeadTrack_, "VOLUME_VCA_LEAD");
-            leadTrackVCALeaderGroupHigh = DAW::GetTrackGroupMembershipHigh(vcaLeadTrack_, "VOLUME_VCA_LEAD");
-            vcaSpillTracks_.Add(vcaLeadTrack_);
+            if (DAW::ValidateTrackPtr(vcaLeadTrack_))
+            {
+                leadTrackVCALeaderGroup = DAW::GetTrackGroupMembership(vcaLeadTrack_, "VOLUME_VCA_LEAD");
+                leadTrackVCALeaderGroupHigh = DAW::GetTrackGroupMembershipHigh(vcaLeadTrack_, "VOLUME_VCA_LEAD");
+                vcaSpillTracks_.Add(vcaLeadTrack_);
+            }
+            else
+                vcaSpillTracks_.Add(NULL); // the lead's channel goes blank, as it did when it was checked per channel
         }
         
         // Get Visible Tracks
@@ -3840,6 +4368,8 @@ public:
         if (currentTrackVCAFolderMode_ != 2)
             return;
         
+        InvalidateChannelTracks();
+        
         folderTopParentTracks_.Empty();
         folderDictionary_.DeleteAll();
 
@@ -3916,6 +4446,19 @@ public:
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum RunPhase
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    RunPhase_RebuildTracks,
+    RunPhase_VCASpill,
+    RunPhase_FolderTracks,
+    RunPhase_SelectedTracks,
+    RunPhase_HandleExternalInput,
+    RunPhase_RequestUpdate,
+    RunPhase_Count
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Page
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3927,18 +4470,41 @@ protected:
     ModifierManager *modifierManager_;
     WDL_PtrList<ControlSurface> surfaces_;
     
+    // "Show timing" -- per-phase Run() cost, accumulated and reported to the console every few seconds
+    double runPhaseTimes_[RunPhase_Count];
+    double runMaxTickTime_;
+    double runWindowStartTime_;
+    int runTicks_;
+    bool isRunTimed_; // g_timingDisplay as of the last tick, so switching timing on starts a fresh window
+    
+    void AddRunPhaseTime(RunPhase phase, double &startTime) // startTime moves on to now, ready for the next phase
+    {
+        if ( ! g_timingDisplay)
+            return;
+        
+        double now = time_precise();
+        runPhaseTimes_[phase] += now - startTime;
+        startTime = now;
+    }
+    
+    void EndRunTick(double tickStartTime);
+    void ResetRunTimes();
+    
 public:
     Page(CSurfIntegrator *const csi, const char *name, bool followMCP,  bool synchPages, bool isScrollLinkEnabled, bool isScrollSynchEnabled) : csi_(csi), name_(name)
     {
         trackNavigationManager_ = new TrackNavigationManager(csi_, this, followMCP, synchPages, isScrollLinkEnabled, isScrollSynchEnabled);
         modifierManager_ = new ModifierManager(csi_, this, NULL);
+        
+        isRunTimed_ = false;
+        ResetRunTimes();
     }
 
     ~Page()
     {
+        surfaces_.Empty(true); // Zones release their Navigators, so go first
         delete trackNavigationManager_;
         delete modifierManager_;
-        surfaces_.Empty(true);
     }
         
     const char *GetName() { return name_.c_str(); }
@@ -3953,6 +4519,12 @@ public:
         surfaces_.Add(surface);
     }
     
+    void ReloadZoneFile(const char *filePath, int reloadSerial)
+    {
+        for (int i = 0; i < surfaces_.GetSize(); ++i)
+            surfaces_.Get(i)->GetZoneManager()->ReloadZoneFile(filePath, reloadSerial);
+    }
+    
     void UpdateCurrentActionContextModifiers()
     {
         for (int i = 0; i < surfaces_.GetSize(); ++i)
@@ -4094,6 +4666,7 @@ public:
     void SelectedTracksModeActivated() { trackNavigationManager_->SelectedTracksModeActivated(); }
     void SelectedTracksModeDeactivated() { trackNavigationManager_->SelectedTracksModeDeactivated(); }
     Navigator * GetNavigatorForTrack(MediaTrack *track) { return trackNavigationManager_->GetNavigatorForTrack(track); }
+    void ReclaimFixedTrackNavigators() { trackNavigationManager_->ReclaimFixedTrackNavigators(); }
     Navigator * GetNavigatorForChannel(int channelNum) { return trackNavigationManager_->GetNavigatorForChannel(channelNum); }
     MediaTrack *GetTrackFromId(int trackNumber) { return trackNavigationManager_->GetTrackFromId(trackNumber); }
     int GetIdFromTrack(MediaTrack *track) { return trackNavigationManager_->GetIdFromTrack(track); }
@@ -4112,93 +4685,62 @@ public:
     const char *GetCurrentInputMonitorMode(MediaTrack *track) { return trackNavigationManager_->GetCurrentInputMonitorMode(track); }
     const WDL_PtrList<MediaTrack> &GetSelectedTracks() { return trackNavigationManager_->GetSelectedTracks(); }
     
-    
-    /*
-    int repeats = 0;
-    
-    void Run()
-    {
-        int start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-                
-        repeats++;
-         
-        if (repeats > 50)
-        {
-            repeats = 0;
-            
-            int totalDuration = 0;
-
-            start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-            trackNavigationManager_->RebuildTracks();
-            trackNavigationManager_->RebuildVCASpill();
-            trackNavigationManager_->RebuildFolderTracks();
-            int duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - start;
-            totalDuration += duration;
-            ShowDuration("Rebuild Track/VCA/Folder List", duration);
-            
-            for (int i = 0; i < surfaces_.GetSize(); ++i)
-            {
-                start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-                surfaces_.Get(i)->HandleExternalInput();
-                duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - start;
-                totalDuration += duration;
-                ShowDuration(surfaces_.Get(i)->GetName(), "HandleExternalInput", duration);
-            }
-            
-            for (int i = 0; i < surfaces_.GetSize(); ++i)
-            {
-                start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-                surfaces_.Get(i)->RequestUpdate();
-                duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - start;
-                totalDuration += duration;
-                ShowDuration(surfaces_.Get(i)->GetName(), "Request Update", duration);
-            }
-            
-            char msgBuffer[250];
-            
-            snprintf(msgBuffer, sizeof(msgBuffer), "Total duration = %d\n\n\n", totalDuration);
-            ShowConsoleMsg(msgBuffer);
-        }
-    }
-    
-    
-    void ShowDuration(string item, int duration)
-    {
-        char msgBuffer[250];
-        
-        snprintf(msgBuffer, sizeof(msgBuffer), "%s - %d microseconds\n", item.c_str(), duration);
-        ShowConsoleMsg(msgBuffer);
-    }
-    
-    void ShowDuration(string surface, string item, int duration)
-    {
-        char msgBuffer[250];
-        
-        snprintf(msgBuffer, sizeof(msgBuffer), "%s - %s - %d microseconds\n", surface.c_str(), item.c_str(), duration);
-        ShowConsoleMsg(msgBuffer);
-    }
-   */
 
-//*
-    void Run()
-    {
-        trackNavigationManager_->RebuildTracks();
-        trackNavigationManager_->RebuildVCASpill();
-        trackNavigationManager_->RebuildFolderTracks();
-        trackNavigationManager_->RebuildSelectedTracks();
-        
-        for (int i = 0; i < surfaces_.GetSize(); ++i)
-            surfaces_.Get(i)->HandleExternalInput();
-        
-        for (int i = 0; i < surfaces_.GetSize(); ++i)
-            surfaces_.Get(i)->RequestUpdate();
-    }
-//*/
+    void Run();
 };
 
 static const int s_stepSizes_[]  = { 2,   3,   4,   5,   6,   7,   8,   9,   10,  11,  12,  13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25 };
 static const int s_tickCounts_[] = { 250, 235, 220, 205, 190, 175, 160, 145, 130, 115, 100, 90, 80, 70, 60, 50, 45, 40, 35, 30, 25, 20, 20, 20 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum InitPhase
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    InitPhase_Ports,            // CSI.ini and opening MIDI/OSC ports
+    InitPhase_SurfaceFiles,     // Surface.txt and .ost widget definitions
+    InitPhase_PreProcessZones,  // scanning Zone and FXZone folders
+    InitPhase_LoadZones,        // Home and GoZones
+    InitPhase_Count
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TrackMeter
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    int tick;           // CSurfIntegrator Run() count when these were read
+    double peakL;
+    double peakR;
+    bool isSoloGated;   // some track is soloed, but not this one
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FXParamKey
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    MediaTrack *track;
+    int fxIndex;
+    int paramIndex;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FormattedFXParam
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double normalizedValue; // value the text was formatted from
+    double formatTime;
+    char text[128];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PendingFXParamWrite
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double value;
+    double writeTime;   // when value was last handed to the plugin
+    bool isPending;
+    bool isTouched;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class CSurfIntegrator : public IReaperControlSurface
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -4228,13 +4770,55 @@ private:
     int projectMetronomePrimaryVolumeOffs_; // for double -- if invalid, use fallbacks
     int projectMetronomeSecondaryVolumeOffs_; // for double -- if invalid, use fallbacks
     
-    WDL_StringKeyedArray<WDL_IntKeyedArray<int>* > fxParamSteppedValueCounts_;
-    static void disposeCounts(WDL_IntKeyedArray<int> *counts) { delete counts; }
+    WDL_StringKeyedArray<CSIZoneDefinitions*> zoneDefinitions_;
+    static void disposeZoneDefinitions(CSIZoneDefinitions *zoneDefinitions) { delete zoneDefinitions; }
     
-    void InitActionsDictionary();
+    double initPhaseTimes_[InitPhase_Count]; // seconds spent in each phase of the last Init()
+    
+    // Meters are read at most once per track per tick, however many contexts display them
+    int meterTick_;
+    int anyTrackSoloTick_;
+    bool anyTrackSolo_;
+    WDL_PointerKeyedArray<MediaTrack*, TrackMeter> trackMeters_;
+    
+    // Action toggle states, dropped whenever REAPER runs a main-section action and otherwise re-polled at a low rate
+    WDL_IntKeyedArray<int> toggleStates_;
+    int toggleStatesCommandCount_;
+    double toggleStatesTime_;
+    
+    void RefreshToggleStates();
+    
+    // Plugin string formatting can be slow or lock against the audio thread, so only reformat when the value moves
+    WDL_AssocArray<FXParamKey, FormattedFXParam> formattedFXParams_;
+    static int compareFXParamKeys(FXParamKey *a, FXParamKey *b)
+    {
+        if (a->track != b->track) return a->track < b->track ? -1 : 1;
+        if (a->fxIndex != b->fxIndex) return a->fxIndex < b->fxIndex ? -1 : 1;
+        return a->paramIndex < b->paramIndex ? -1 : a->paramIndex > b->paramIndex ? 1 : 0;
+    }
     
-    void InitFXParamStepValues();
+    // FX param writes from a burst of encoder/fader messages land once per tick, with the last value
+    WDL_AssocArray<FXParamKey, PendingFXParamWrite> fxParamWrites_;
+    
+    // Input-to-feedback latencies in seconds, keyed by "surface feedback-processor", reported and cleared with the Run timing
+    WDL_StringKeyedArray<WDL_TypedBuf<double>*> feedbackLatencies_;
+    static void disposeFeedbackLatencies(WDL_TypedBuf<double> *latencies) { delete latencies; }
+    
+    PendingFXParamWrite *GetFXParamWrite(MediaTrack *track, int fxIndex, int paramIndex);
+    
+#ifdef __linux__
+    int zoneFileWatch_; // inotify descriptor for the CSI/Surfaces tree
+    string_list zoneFileWatchFolders_;
+    WDL_IntKeyedArray<int> zoneFileWatchFolderIndices_; // watch descriptor -> index into zoneFileWatchFolders_
+    
+    void AddZoneFileWatch(const char *folder);
+#endif
+    
+    void InitZoneFileWatch();
+    void CheckZoneFileWatch();
 
+    void InitActionsDictionary();
+    
     double GetPrivateProfileDouble(const char *key)
     {
         char tmp[512];
@@ -4270,6 +4854,25 @@ public:
     }
     
     void Init();
+    
+    void AddInitPhaseTime(InitPhase phase, double startTime) { initPhaseTimes_[phase] += time_precise() - startTime; }
+    
+    const TrackMeter &GetTrackMeter(MediaTrack *track);
+    int GetToggleState(int commandId);
+    
+    bool InjectMidiMessage(const char *surfaceName, const unsigned char *message, int size);
+    bool InjectOSCPacket(const char *surfaceName, const void *packet, int size);
+    bool ReplaySurfaceTraffic(const char *surfaceName, const char *filePath, bool isRealTime);
+    const char *GetFormattedFXParamValue(MediaTrack *track, int fxIndex, int paramIndex);
+    
+    double GetFXParam(MediaTrack *track, int fxIndex, int paramIndex, double *min, double *max);
+    void SetFXParam(MediaTrack *track, int fxIndex, int paramIndex, double value);
+    void TouchFXParam(MediaTrack *track, int fxIndex, int paramIndex, bool isTouched);
+    void FlushFXParamWrites();
+    
+    void AddFeedbackLatency(const char *surfaceName, const char *widgetType, const char *feedbackProcessorName, double latency);
+    void ReportFeedbackLatencies();
+    void ClearFeedbackLatencies() { feedbackLatencies_.DeleteAll(); }
 
     double GetFaderMaxDB() { return GetPrivateProfileDouble("slidermaxv"); }
     double GetFaderMinDB() { return GetPrivateProfileDouble("sliderminv"); }
@@ -4349,12 +4952,27 @@ public:
     }
     // End direct calls
     
-    ActionContext *GetActionContext(const char *actionName, Widget *widget, Zone *zone, const string_list &params)
+    Action *GetAction(const char *actionName)
     {
         if (actions_.Exists(actionName))
-            return new ActionContext(this, actions_.Get(actionName), widget, zone, 0, &params, NULL);
+            return actions_.Get(actionName);
         else
-            return new ActionContext(this, actions_.Get("NoAction"), widget, zone, 0, &params, NULL);
+            return actions_.Get("NoAction");
+    }
+    
+    ActionContext *GetActionContext(const char *actionName, Widget *widget, Zone *zone, const string_list &params)
+    {
+        return new ActionContext(this, GetAction(actionName), widget, zone, 0, &params, NULL);
+    }
+    
+    CSIZoneDefinitions *GetZoneDefinitions(const string &zoneFolder, const string &fxZoneFolder)
+    {
+        string key = zoneFolder + "|" + fxZoneFolder;
+        
+        if ( ! zoneDefinitions_.Exists(key.c_str()))
+            zoneDefinitions_.Insert(key.c_str(), new CSIZoneDefinitions());
+        
+        return zoneDefinitions_.Get(key.c_str());
     }
 
     void OnTrackSelection(MediaTrack *track) override
@@ -4365,6 +4983,11 @@ public:
     
     void SetTrackListChange() override
     {
+        FlushFXParamWrites();
+        
+        trackMeters_.DeleteAll();
+        formattedFXParams_.DeleteAll();
+        
         if (pages_.Get(currentPageIndex_))
             pages_.Get(currentPageIndex_)->OnTrackListChange();
     }
@@ -4448,6 +5071,15 @@ public:
     
     void TrackFXListChanged(MediaTrack *track)
     {
+        for (int i = formattedFXParams_.GetSize() - 1; i >= 0; --i)
+        {
+            FXParamKey key = { NULL, 0, 0 };
+            formattedFXParams_.EnumeratePtr(i, &key);
+            
+            if (key.track == track)
+                formattedFXParams_.DeleteByIndex(i);
+        }
+        
         for (int i = 0; i < pages_.GetSize(); ++i)
             pages_.Get(i)->TrackFXListChanged(track);
         
@@ -4478,16 +5110,6 @@ public:
  
                     if (fxFile)
                         fprintf(fxFile, "\tFXParam %d \"%s\"\n", j, fxParamName);
-                        
-                    /* step sizes
-                    double stepOut = 0;
-                    double smallstepOut = 0;
-                    double largestepOut = 0;
-                    bool istoggleOut = false;
-                    TrackFX_GetParameterStepSizes(track, i, j, &stepOut, &smallstepOut, &largestepOut, &istoggleOut);
-
-                    ShowConsoleMsg(("\n\n" + to_string(j) + " - \"" + string(fxParamName) + "\"\t\t\t\t Step = " +  to_string(stepOut) + " Small Step = " + to_string(smallstepOut)  + " LargeStep = " + to_string(largestepOut)  + " Toggle Out = " + (istoggleOut == 0 ? "false" : "true")).c_str());
-                    */
                 }
                 
                 if (fxFile)
@@ -4499,19 +5121,18 @@ public:
         }
     }
     
-    const char *GetTCPFXParamName(MediaTrack *track, int fxIndex, int paramIndex, char *buf, int bufsz)
-    {
-        buf[0]=0;
-        TrackFX_GetParamName(track, fxIndex, paramIndex, buf, bufsz);
-        return buf;
-    }
-        
     //int repeats = 0;
     
     void Run() override
     {
         //int start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
         
+        CheckZoneFileWatch();
+        
+        meterTick_++;
+        
+        RefreshToggleStates();
+        
         if (shouldRun_ && pages_.Get(currentPageIndex_))
             pages_.Get(currentPageIndex_)->Run();
         /*
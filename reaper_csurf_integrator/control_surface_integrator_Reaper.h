@@ -139,12 +139,24 @@ public:
         return ::GetTrack(NULL, trackidx) ;
     }
     
+    static int GetNativeTrackColor(MediaTrack *track)
+    {
+        if (ValidateTrackPtr(track))
+            return ::GetTrackColor(track);
+        else
+            return 0;
+    }
+    
     static rgba_color GetTrackColor(MediaTrack *track)
+    {
+        return GetTrackColorFromNative(GetNativeTrackColor(track));
+    }
+    
+    static rgba_color GetTrackColorFromNative(int nativeColor)
     {
         rgba_color color;
         
-        if (ValidateTrackPtr(track))
-            ::ColorFromNative(::GetTrackColor(track), &color.r, &color.g, &color.b);
+        ::ColorFromNative(nativeColor, &color.r, &color.g, &color.b);
         
         if (color.r == 0 && color.g == 0 && color.b == 0)
         {
@@ -349,12 +349,7 @@ static WDL_DLGRET dlgProcEditAdvanced(HWND hwndDlg, UINT uMsg, WPARAM wParam, LP
     
     char buf[MEDBUF];
 
-    int modifier = 0;
-
-    const WDL_TypedBuf<int> &modifiers = zoneManager->GetSurface()->GetModifiers();
-        
-    if (modifiers.GetSize() > 0)
-        modifier = modifiers.Get()[0];
+    int modifier = zoneManager->GetSurface()->GetEngagedModifiers();
         
     switch (uMsg)
     {
@@ -1643,11 +1638,7 @@ static WDL_DLGRET dlgProcLearnFX(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM
             
             if (zoneManager)
             {
-                const WDL_TypedBuf<int> &modifiers = zoneManager->GetSurface()->GetModifiers();
-                
-                if (modifiers.GetSize() > 0)
-                    modifier = modifiers.Get()[0];
-                
+                modifier = zoneManager->GetSurface()->GetEngagedModifiers();
                 paramContext = GetFirstContext(zoneManager, widget, modifier);
             }
             
@@ -2946,6 +2937,9 @@ static WDL_DLGRET dlgProcAdvancedSetup(HWND hwndDlg, UINT uMsg, WPARAM wParam, L
             CheckDlgButton(hwndDlg, IDC_CHECK_ShowInput, g_surfaceInDisplay);
             CheckDlgButton(hwndDlg, IDC_CHECK_ShowOutput, g_surfaceOutDisplay);
             CheckDlgButton(hwndDlg, IDC_CHECK_WriteFXParams, g_fxParamsWrite);
+            CheckDlgButton(hwndDlg, IDC_CHECK_ShowTiming, g_timingDisplay);
+            CheckDlgButton(hwndDlg, IDC_CHECK_ThinTouchedFXWrites, g_fxParamsThinWhileTouched);
+            CheckDlgButton(hwndDlg, IDC_CHECK_RecordSurfaceTraffic, g_recordSurfaceTraffic);
         }
             
         case WM_COMMAND:
@@ -3286,6 +3280,9 @@ static WDL_DLGRET dlgProcAdvancedSetup(HWND hwndDlg, UINT uMsg, WPARAM wParam, L
                         g_surfaceInDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowInput) != 0;
                         g_surfaceOutDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowOutput) != 0;
                         g_fxParamsWrite = IsDlgButtonChecked(hwndDlg, IDC_CHECK_WriteFXParams) != 0;
+                        g_timingDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowTiming) != 0;
+                        g_fxParamsThinWhileTouched = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ThinTouchedFXWrites) != 0;
+                        g_recordSurfaceTraffic = IsDlgButtonChecked(hwndDlg, IDC_CHECK_RecordSurfaceTraffic) != 0;
                         
                         TransferBroadcasters(s_broadcasters, s_pages.Get(s_pageIndex)->broadcasters);
 
@@ -779,6 +779,7 @@ class Bank : public Action
 {
 public:
     virtual const char *GetName() override { return "Bank"; }
+    virtual ActionParamLayout GetParamLayout() override { return ActionParamLayout_Bank; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
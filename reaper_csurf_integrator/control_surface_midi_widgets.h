@@ -2074,24 +2074,14 @@ public:
 
     virtual void UpdateTrackColors() override
     {
-        bool shouldUpdate = false;
-          
-        vector<rgba_color> trackColors;
-        
         for (int i = 0; i < currentTrackColors_.GetSize(); ++i)
-            trackColors.push_back(surface_->GetTrackColorForChannel(i));
-        
-        for (int i = 0; i < trackColors.size(); ++i)
         {
-            if (trackColors[i] != currentTrackColors_.Get()[i])
+            if (surface_->GetTrackColorForChannel(i) != currentTrackColors_.Get()[i])
             {
-                shouldUpdate = true;
+                ForceUpdateTrackColors();
                 break;
             }
         }
-        
-        if (shouldUpdate)
-            ForceUpdateTrackColors();
     }
     
     virtual void ForceUpdateTrackColors() override
@@ -2113,12 +2103,7 @@ public:
         midiSysExData.evt.midi_message[midiSysExData.evt.size++] = displayType_;
         midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x72;
 
-        vector<rgba_color> trackColors;
-        
         for (int i = 0; i < surface_->GetNumChannels(); ++i)
-            trackColors.push_back(surface_->GetTrackColorForChannel(i));
-
-        for (int i = 0; i < trackColors.size(); ++i)
         {
             if (lastStringSent_ == "")
             {
@@ -2126,7 +2111,7 @@ public:
             }
             else
             {
-                rgba_color color = trackColors[i];
+                rgba_color color = surface_->GetTrackColorForChannel(i);
                 
                 currentTrackColors_.Get()[i] = color;
                 
@@ -128,6 +128,9 @@
 #define IDC_LIST_Links                  1310
 #define ID_BUTTON_SymLink               1311
 #define ID_BUTTON_SymUnlink             1312
+#define IDC_CHECK_ShowTiming            1313
+#define IDC_CHECK_ThinTouchedFXWrites   1314
+#define IDC_CHECK_RecordSurfaceTraffic  1315
 
 // Next default values for new objects
 // 
@@ -135,7 +138,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        131
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         1313
+#define _APS_NEXT_CONTROL_VALUE         1316
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
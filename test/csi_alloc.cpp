@@ -0,0 +1,93 @@
+//
+//  csi_alloc.cpp
+//  reaper_csurf_integrator test harness
+//
+//  Counts heap traffic for the whole process.  The executable's malloc family takes precedence over libc's for every
+//  shared object, the dlopen'ed plug-in included, and operator new goes through malloc in libstdc++.
+//
+
+#include <malloc.h>
+#include <stddef.h>
+
+#include "csi_host.h"
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void __libc_free(void *ptr);
+}
+
+#define CSI_EXPORT extern "C" __attribute__((visibility("default"))) // the build hides symbols by default
+
+static long long s_allocations = 0;
+static long long s_frees = 0;
+static long long s_liveBytes = 0;
+
+AllocationStats GetAllocationStats()
+{
+    AllocationStats stats;
+    stats.allocations = s_allocations;
+    stats.frees = s_frees;
+    stats.liveBytes = s_liveBytes;
+    return stats;
+}
+
+CSI_EXPORT void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+
+    if (ptr)
+    {
+        s_allocations++;
+        s_liveBytes += malloc_usable_size(ptr);
+    }
+
+    return ptr;
+}
+
+CSI_EXPORT void *calloc(size_t count, size_t size)
+{
+    void *ptr = __libc_calloc(count, size);
+
+    if (ptr)
+    {
+        s_allocations++;
+        s_liveBytes += malloc_usable_size(ptr);
+    }
+
+    return ptr;
+}
+
+CSI_EXPORT void *realloc(void *ptr, size_t size)
+{
+    size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+    void *newPtr = __libc_realloc(ptr, size);
+
+    if (newPtr)
+    {
+        s_allocations++;
+        s_liveBytes += (long long)malloc_usable_size(newPtr) - (long long)oldSize;
+
+        if (ptr)
+            s_frees++;
+    }
+    else if (ptr && size == 0)
+    {
+        s_frees++;
+        s_liveBytes -= oldSize;
+    }
+
+    return newPtr;
+}
+
+CSI_EXPORT void free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    s_frees++;
+    s_liveBytes -= malloc_usable_size(ptr);
+    __libc_free(ptr);
+}
@@ -0,0 +1,566 @@
+//
+//  csi_bench.cpp
+//  reaper_csurf_integrator test harness
+//
+//  Benchmarks that drive the built plug-in through CSIHost.  Times are wall clock on this machine; API call counts
+//  and allocation counts are exact and comparable between builds.  Run with "make bench", or
+//  "./csi_bench [path to plug-in] run|init|contexts".
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csi_host.h"
+
+static double Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixtures -- an 8 channel MCU style surface
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static string MixerSurfaceFile(int channels)
+{
+    string surface;
+    char buffer[512];
+
+    for (int i = 0; i < channels; ++i)
+    {
+        snprintf(buffer, sizeof(buffer),
+                 "Widget Fader%d\n    Fader14Bit %02x 7f 7f\n    FB_Fader14Bit %02x 7f 7f\nWidgetEnd\n"
+                 "Widget Rotary%d\n    Encoder b0 %02x 7f\n    FB_Encoder b0 %02x 7f\nWidgetEnd\n"
+                 "Widget Mute%d\n    Press 90 %02x 7f\n    FB_TwoState 90 %02x 7f 90 %02x 00\nWidgetEnd\n"
+                 "Widget Solo%d\n    Press 90 %02x 7f\n    FB_TwoState 90 %02x 7f 90 %02x 00\nWidgetEnd\n"
+                 "Widget Select%d\n    Press 90 %02x 7f\n    FB_TwoState 90 %02x 7f 90 %02x 00\nWidgetEnd\n",
+                 i + 1, 0xe0 + i, 0xe0 + i,
+                 i + 1, 0x10 + i, 0x30 + i,
+                 i + 1, 0x10 + i, 0x10 + i, 0x10 + i,
+                 i + 1, 0x08 + i, 0x08 + i, 0x08 + i,
+                 i + 1, 0x18 + i, 0x18 + i, 0x18 + i);
+        surface += buffer;
+    }
+
+    return surface;
+}
+
+// The channel strip zones -- including VCA, Folder or SelectedTracks in Home switches the page into that mode
+static const char *s_channelZoneNames[] = { "Track", "VCA", "Folder", "SelectedTracks" };
+
+static const char *s_channelZoneBody =
+    "    Fader| TrackVolume\n"
+    "    Rotary| TrackPan\n"
+    "    Mute| TrackMute\n"
+    "    Solo| TrackSolo\n"
+    "    Select| TrackUniqueSelect\n"
+    "ZoneEnd\n";
+
+static void WriteMixerSurface(CSIHost &host, const char *folder, int channels, const char *channelZone = "Track")
+{
+    string base = string("CSI/Surfaces/") + folder;
+
+    host.WriteFile((base + "/Surface.txt").c_str(), MixerSurfaceFile(channels));
+    host.WriteFile((base + "/Zones/Home.zon").c_str(), string("Zone Home\n    IncludedZones\n        ") + channelZone + "\n    IncludedZonesEnd\nZoneEnd\n");
+
+    for (int i = 0; i < (int)(sizeof(s_channelZoneNames) / sizeof(s_channelZoneNames[0])); ++i)
+        host.WriteFile((base + "/Zones/" + s_channelZoneNames[i] + ".zon").c_str(), string("Zone ") + s_channelZoneNames[i] + "\n" + s_channelZoneBody);
+
+    host.WriteFile((base + "/FXZones/README.txt").c_str(), "");
+}
+
+// Zone files that are only preprocessed at Init -- plain zones nobody navigates to, and FX zones for FX nobody focuses
+static void WriteSpareZones(CSIHost &host, const char *folder, int numZones)
+{
+    string base = string("CSI/Surfaces/") + folder;
+    char buffer[256];
+
+    for (int i = 0; i < numZones; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            snprintf(buffer, sizeof(buffer), "Spare%d", i);
+            host.WriteFile((base + "/Zones/Spare/" + buffer + ".zon").c_str(), string("Zone ") + buffer + "\n" + s_channelZoneBody);
+        }
+        else
+        {
+            string fxZone;
+
+            snprintf(buffer, sizeof(buffer), "Zone \"VST: Bench Synth %d (CSI)\" \"Bench Synth %d\"\n", i, i);
+            fxZone += buffer;
+
+            for (int channel = 1; channel <= 8; ++channel)
+            {
+                snprintf(buffer, sizeof(buffer), "    Rotary%d FXParam %d \"Param %d\"\n", channel, channel - 1, channel);
+                fxZone += buffer;
+            }
+
+            fxZone += "ZoneEnd\n";
+
+            snprintf(buffer, sizeof(buffer), "%s/FXZones/Bench Synth %d.zon", base.c_str(), i);
+            host.WriteFile(buffer, fxZone);
+        }
+    }
+}
+
+static string MidiSurfaceLine(const char *name, int channels, int port)
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "SurfaceType=MIDI SurfaceName=%s SurfaceChannelCount=%d MidiInput=%d MidiOutput=%d MIDISurfaceRefreshRate=15 MaxMIDIMesssagesPerRun=0\n", name, channels, port, port);
+    return buffer;
+}
+
+enum Topology
+{
+    Topology_Flat,
+    Topology_Folders,   // folders of 8, the first track of each is the parent
+    Topology_VCA,       // 8 VCA leads, every other track follows one of them
+    Topology_Selection, // every 4th track selected
+    Topology_Count
+};
+
+static const char *s_topologyNames[Topology_Count] = { "flat", "folders", "vca", "selection" };
+static const char *s_topologyZones[Topology_Count] = { "Track", "Folder", "VCA", "SelectedTracks" };
+
+static void BuildSession(CSIHost &host, int numTracks, Topology topology)
+{
+    host.ClearTracks();
+
+    for (int i = 0; i < numTracks; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "Track %d", i + 1);
+
+        StubTrack *track = host.AddTrack(name);
+        track->volume = 0.25 + (i % 7) * 0.1;
+        track->pan = ((i % 5) - 2) * 0.25;
+        track->peaks[0] = track->peaks[1] = (i % 10) * 0.05;
+
+        if (topology == Topology_Folders)
+            track->folderDepth = i % 8 == 0 ? 1 : i % 8 == 7 || i == numTracks - 1 ? -1 : 0;
+        else if (topology == Topology_VCA)
+        {
+            if (i < 8)
+                track->vcaLeadMask = 1u << i;
+            else if (i % 2 == 0)
+                track->vcaFollowMask = 1u << (i % 8);
+        }
+        else if (topology == Topology_Selection)
+            track->selected = i % 4 == 0;
+    }
+
+    if (topology != Topology_Selection && numTracks > 0)
+        host.SelectOnly(host.GetTrack(0));
+}
+
+static void PrintCallCounts(const vector<pair<string, long long> > &counts, double perTick, int maxFunctions)
+{
+    long long total = 0;
+    for (int i = 0; i < (int)counts.size(); ++i)
+        total += counts[i].second;
+
+    printf("    %.1f API calls per tick:", total / perTick);
+
+    for (int i = 0; i < (int)counts.size() && i < maxFunctions; ++i)
+        printf("%s %s %.1f", i == 0 ? "" : ",", counts[i].first.c_str(), counts[i].second / perTick);
+
+    printf("\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// run -- Run() cost against session size and shape
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int BenchRun(CSIHost &host, int argc, char *argv[])
+{
+    static const int s_trackCounts[] = { 10, 100, 1000, 5000 };
+    const int numTicks = argc > 0 ? atoi(argv[0]) : 300;
+
+    host.WriteFile("CSI/CSI.ini",
+                   "Version=7.0\n\n" + MidiSurfaceLine("Mixer", 8, 0) +
+                   "\nPageName=Home PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n"
+                   "    Surface=Mixer Zones=Mixer StartChannel=0\n");
+
+    printf("Run(): one 8 channel surface, %d ticks per case; the topology's zone (Track, Folder, VCA, SelectedTracks) drives the channels\n", numTicks);
+    printf("%-10s %6s %12s %12s\n", "topology", "tracks", "us/tick", "max us");
+
+    for (int t = 0; t < Topology_Count; ++t)
+    {
+        WriteMixerSurface(host, "Mixer", 8, s_topologyZones[t]);
+
+        for (int n = 0; n < (int)(sizeof(s_trackCounts) / sizeof(s_trackCounts[0])); ++n)
+        {
+            BuildSession(host, s_trackCounts[n], (Topology)t);
+            host.Reset();
+            host.NotifyTrackListChange();
+            host.Tick(10);
+
+            CSIHost::ResetCallCounts();
+
+            double maxTick = 0.0;
+            double start = Now();
+
+            for (int i = 0; i < numTicks; ++i)
+            {
+                double tickStart = Now();
+
+                // some motion every tick, like playback with automation and meters
+                StubTrack *track = host.GetTrack(i % s_trackCounts[n]);
+                track->volume = 0.25 + (i % 11) * 0.05;
+                track->peaks[0] = track->peaks[1] = (i % 20) * 0.025;
+
+                host.Tick();
+
+                if (Now() - tickStart > maxTick)
+                    maxTick = Now() - tickStart;
+            }
+
+            double elapsed = Now() - start;
+
+            printf("%-10s %6d %12.1f %12.1f\n", s_topologyNames[t], s_trackCounts[n], elapsed / numTicks * 1e6, maxTick * 1e6);
+
+            vector<pair<string, long long> > counts;
+            CSIHost::GetCallCounts(counts);
+            PrintCallCounts(counts, numTicks, 6);
+        }
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// init -- CSurfIntegrator::Init, as run by CSURF_EXT_RESET, against the size of the config tree
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum InitPhase { InitPhase_Ports, InitPhase_SurfaceFiles, InitPhase_PreProcessZones, InitPhase_LoadZones, InitPhase_Count }; // as Init reports them
+
+struct InitCase
+{
+    int surfaces;
+    int pages;
+    int spareZones; // per surface, half plain zones and half FX zones
+};
+
+static const InitCase s_initCases[] =
+{
+    {  1, 1,  10 },
+    {  4, 1,  10 },
+    { 16, 1,  10 },
+    {  4, 4,  10 },
+    {  4, 1, 200 },
+    { 16, 4, 200 },
+};
+
+static void WriteInitConfig(CSIHost &host, const InitCase &initCase)
+{
+    string ini = "Version=7.0\n\n";
+    char name[32];
+
+    for (int i = 0; i < initCase.surfaces; ++i)
+    {
+        snprintf(name, sizeof(name), "Surface%d", i + 1);
+        ini += MidiSurfaceLine(name, 8, i % host.GetNumMidiPorts());
+    }
+
+    for (int page = 0; page < initCase.pages; ++page)
+    {
+        snprintf(name, sizeof(name), "Page%d", page + 1);
+        ini += string("\nPageName=") + name + " PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n";
+
+        for (int i = 0; i < initCase.surfaces; ++i)
+        {
+            snprintf(name, sizeof(name), "Surface%d", i + 1);
+            ini += string("    Surface=") + name + " Zones=" + name + " StartChannel=0\n";
+        }
+    }
+
+    host.WriteFile("CSI/CSI.ini", ini);
+
+    string cleanup = "rm -rf '" + host.GetResourcePath() + "/CSI/Surfaces'";
+    if (system(cleanup.c_str()) != 0)
+        printf("could not clear %s\n", cleanup.c_str());
+
+    for (int i = 0; i < initCase.surfaces; ++i)
+    {
+        snprintf(name, sizeof(name), "Surface%d", i + 1);
+        WriteMixerSurface(host, name, 8);
+        WriteSpareZones(host, name, initCase.spareZones);
+    }
+}
+
+static int BenchInit(CSIHost &host, int argc, char *argv[])
+{
+    const int numResets = argc > 0 ? atoi(argv[0]) : 20;
+
+    // real time, so the phase times Init prints with "Show timing" on are wall clock rather than the simulated clock
+    host.SetRealTime(true);
+    host.SetTimingDisplay(true);
+
+    printf("Init via CSURF_EXT_RESET: 8 channel MIDI surfaces, every surface on every page, mean of %d resets per case\n", numResets);
+    printf("retained is the heap still live after the last reset, over that of an empty CSI.ini\n");
+    printf("%8s %5s %6s %9s %9s %9s %9s %9s %11s %11s\n", "surfaces", "pages", "zones", "ports ms", "files ms", "scan ms", "load ms", "total ms", "allocations", "retained KB");
+
+    host.WriteFile("CSI/CSI.ini", "Version=7.0\n");
+    host.Reset();
+    const long long emptyBytes = GetAllocationStats().liveBytes;
+
+    for (int c = 0; c < (int)(sizeof(s_initCases) / sizeof(s_initCases[0])); ++c)
+    {
+        const InitCase &initCase = s_initCases[c];
+
+        WriteInitConfig(host, initCase);
+        host.Reset(); // warm the file cache, and the first Reset's allocations are not steady state
+
+        double phases[InitPhase_Count] = { 0.0, 0.0, 0.0, 0.0 };
+        bool isReported = true;
+        double total = 0.0;
+        long long allocations = 0;
+
+        for (int i = 0; i < numResets; ++i)
+        {
+            host.ClearConsole();
+
+            AllocationStats before = GetAllocationStats();
+            double start = Now();
+            host.Reset();
+            total += Now() - start;
+            allocations += GetAllocationStats().allocations - before.allocations;
+
+            // the plug-in's own per-phase report; builds without it still get the total and the allocations
+            double ports = 0.0, files = 0.0, scan = 0.0, load = 0.0;
+            size_t report = host.GetConsole().find("CSI Init:");
+
+            if (report == string::npos || sscanf(host.GetConsole().c_str() + report, "CSI Init: %*d pages, %*d surfaces -- ports %lf ms, surface files %lf ms, zone preprocessing %lf ms, zone loading %lf ms", &ports, &files, &scan, &load) != 4)
+                isReported = false;
+
+            phases[InitPhase_Ports] += ports;
+            phases[InitPhase_SurfaceFiles] += files;
+            phases[InitPhase_PreProcessZones] += scan;
+            phases[InitPhase_LoadZones] += load;
+        }
+
+        printf("%8d %5d %6d", initCase.surfaces, initCase.pages, initCase.spareZones + 2);
+
+        for (int phase = 0; phase < InitPhase_Count; ++phase)
+            if (isReported)
+                printf(" %9.2f", phases[phase] / numResets);
+            else
+                printf(" %9s", "-");
+
+        printf(" %9.2f %11lld %11.1f\n", total / numResets * 1000.0, allocations / numResets, (GetAllocationStats().liveBytes - emptyBytes) / 1024.0);
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// contexts -- building ActionContexts from zone lines, and what each one costs on the heap
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One button per channel for each of these, and a Track zone line for each of them under every modifier below
+// unshared is the same line made distinct for every context by one extra value -- "%s", filled in per modifier and line, with
+// the widget suffix making it per channel too -- so no two contexts share a config, which is the layout before they were interned
+static const struct { const char *widget; const char *action; const char *unshared; } s_contextLines[] =
+{
+    { "Fader",   "TrackVolume",                           "TrackVolume [ 0 %s ]" },
+    { "Rotary",  "TrackPan [ (0.001,0.002,0.004,0.008) ]", "TrackPan [ %s (0.001,0.002,0.004,0.008) ]" },
+    { "Mute",    "TrackMute { 255 0 0 }",                 "TrackMute [ 0 %s ] { 255 0 0 }" },
+    { "Solo",    "TrackSolo { 255 255 0 }",               "TrackSolo [ 0 %s ] { 255 255 0 }" },
+    { "Select",  "TrackUniqueSelect",                     "TrackUniqueSelect [ 0 %s ]" },
+    { "RecArm",  "TrackRecordArm { 255 0 0 }",            "TrackRecordArm [ 0 %s ] { 255 0 0 }" },
+    { "Display", "TrackNameDisplay",                      "TrackNameDisplay [ 0 %s ]" },
+    { "Auto",    "TrackAutoMode [ 0 1 2 3 4 5 ]",         "TrackAutoMode [ 0 1 2 3 4 %s ]" },
+};
+
+static const char *s_contextModifiers[] = { "", "Shift+", "Option+", "Control+", "Alt+", "Flip+", "Shift+Option+", "Shift+Control+", "Option+Control+", "Shift+Alt+" };
+
+static const int s_numContextLines = sizeof(s_contextLines) / sizeof(s_contextLines[0]);
+static const int s_numContextModifiers = sizeof(s_contextModifiers) / sizeof(s_contextModifiers[0]);
+
+enum ContextZone
+{
+    ContextZone_Empty,
+    ContextZone_Shared,
+    ContextZone_Unshared,
+};
+
+static void WriteContextSurface(CSIHost &host, int channels, ContextZone contextZone)
+{
+    string surface;
+    char buffer[256];
+
+    for (int channel = 0; channel < channels; ++channel)
+        for (int line = 0; line < s_numContextLines; ++line)
+        {
+            int index = channel * s_numContextLines + line;
+            int status = 0x90 + (index / 128) % 16;
+
+            snprintf(buffer, sizeof(buffer), "Widget %s%d\n    Press %02x %02x 7f\n    FB_TwoState %02x %02x 7f %02x %02x 00\nWidgetEnd\n",
+                     s_contextLines[line].widget, channel + 1, status, index % 128, status, index % 128, status, index % 128);
+            surface += buffer;
+        }
+
+    string trackZone = "Zone Track\n";
+
+    for (int modifier = 0; contextZone != ContextZone_Empty && modifier < s_numContextModifiers; ++modifier)
+        for (int line = 0; line < s_numContextLines; ++line)
+        {
+            // 0.<modifier><line><channel>1 -- the trailing 1 keeps every channel's value distinct
+            char value[32];
+            snprintf(value, sizeof(value), "0.%d%d|1", modifier, line);
+            snprintf(buffer, sizeof(buffer), contextZone == ContextZone_Shared ? s_contextLines[line].action : s_contextLines[line].unshared, value);
+            
+            trackZone += string("    ") + s_contextModifiers[modifier] + s_contextLines[line].widget + "| " + buffer + "\n";
+        }
+
+    trackZone += "ZoneEnd\n";
+
+    host.WriteFile("CSI/Surfaces/Contexts/Surface.txt", surface);
+    host.WriteFile("CSI/Surfaces/Contexts/Zones/Home.zon", "Zone Home\n    IncludedZones\n        Track\n    IncludedZonesEnd\nZoneEnd\n");
+    host.WriteFile("CSI/Surfaces/Contexts/Zones/Track.zon", trackZone);
+    host.WriteFile("CSI/Surfaces/Contexts/FXZones/README.txt", "");
+}
+
+struct ResetCost
+{
+    double seconds;         // the fastest reset, the least disturbed by the rest of the machine
+    long long allocations;
+    long long heapGrowth; // across the first reset, from an empty CSI.ini to this one
+};
+
+static ResetCost MeasureResets(CSIHost &host, const string &ini, int numResets)
+{
+    ResetCost cost = { 1e9, 0, 0 };
+
+    // Heap is compared across one reset from an empty CSI.ini only, so builds that leak the previous config's zones on
+    // every reset still show what this config holds.  That reset also warms the file cache, so it is not timed.
+    host.WriteFile("CSI/CSI.ini", "Version=7.0\n");
+    host.Reset();
+    host.WriteFile("CSI/CSI.ini", ini);
+    
+    long long liveBytes = GetAllocationStats().liveBytes;
+    host.Reset();
+    cost.heapGrowth = GetAllocationStats().liveBytes - liveBytes;
+
+    for (int i = 0; i < numResets; ++i)
+    {
+        AllocationStats before = GetAllocationStats();
+        double start = Now();
+        host.Reset();
+        cost.seconds = min(cost.seconds, Now() - start);
+        cost.allocations = GetAllocationStats().allocations - before.allocations; // the same every time
+    }
+
+    return cost;
+}
+
+static int BenchContexts(CSIHost &host, int argc, char *argv[])
+{
+    const int channels = argc > 0 ? atoi(argv[0]) : 125;
+    const int numResets = argc > 1 ? atoi(argv[1]) : 20;
+    const int numContexts = channels * s_numContextLines * s_numContextModifiers;
+
+    if (channels < 1 || numResets < 1)
+        return 1;
+
+    const string ini = "Version=7.0\n\n" + MidiSurfaceLine("Contexts", channels, 0) +
+                       "\nPageName=Home PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n"
+                       "    Surface=Contexts Zones=Contexts StartChannel=0\n";
+
+    // The same surface and zones with an empty Track zone first, so the populated configs' costs over it are the
+    // contexts themselves
+    WriteContextSurface(host, channels, ContextZone_Empty);
+    ResetCost empty = MeasureResets(host, ini, numResets);
+
+    WriteContextSurface(host, channels, ContextZone_Shared);
+    ResetCost shared = MeasureResets(host, ini, numResets);
+
+    WriteContextSurface(host, channels, ContextZone_Unshared);
+    ResetCost unshared = MeasureResets(host, ini, numResets);
+
+    printf("ActionContexts: %d channels x %d zone lines x %d modifiers = %d contexts, fastest of %d resets\n",
+           channels, s_numContextLines, s_numContextModifiers, numContexts, numResets);
+    printf("unshared gives every context a config of its own, as before configs were interned\n");
+    printf("%-24s %12s %12s %12s\n", "", "empty zone", "populated", "unshared");
+    printf("%-24s %12.2f %12.2f %12.2f\n", "reset ms", empty.seconds * 1000.0, shared.seconds * 1000.0, unshared.seconds * 1000.0);
+    printf("%-24s %12lld %12lld %12lld\n", "allocations per reset", empty.allocations, shared.allocations, unshared.allocations);
+    printf("%-24s %12.1f %12.1f %12.1f\n", "heap growth KB", empty.heapGrowth / 1024.0, shared.heapGrowth / 1024.0, unshared.heapGrowth / 1024.0);
+    
+    const ResetCost *populated[] = { &shared, &unshared };
+    
+    for (int i = 0; i < 2; ++i)
+        printf("per context, %-9s %.2f us, %.2f allocations, %.0f bytes\n", i == 0 ? "populated" : "unshared",
+               (populated[i]->seconds - empty.seconds) * 1e6 / numContexts,
+               (double)(populated[i]->allocations - empty.allocations) / numContexts,
+               (double)(populated[i]->heapGrowth - empty.heapGrowth) / numContexts);
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Runner
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const struct { const char *name; int (*bench)(CSIHost &, int, char *[]); const char *usage; } s_benches[] =
+{
+    { "run", BenchRun, "run [ticks]" },
+    { "init", BenchInit, "init [resets]" },
+    { "contexts", BenchContexts, "contexts [channels] [resets]" },
+};
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("usage: csi_bench <plug-in>");
+        for (int i = 0; i < (int)(sizeof(s_benches) / sizeof(s_benches[0])); ++i)
+            printf(" %s %s", i == 0 ? "" : "|", s_benches[i].usage);
+        printf("\n");
+        return 1;
+    }
+
+    int (*bench)(CSIHost &, int, char *[]) = NULL;
+
+    for (int i = 0; i < (int)(sizeof(s_benches) / sizeof(s_benches[0])); ++i)
+        if ( ! strcmp(argv[2], s_benches[i].name))
+            bench = s_benches[i].bench;
+
+    if (bench == NULL)
+    {
+        printf("unknown benchmark %s\n", argv[2]);
+        return 1;
+    }
+
+    char resourcePath[] = "/tmp/csi_bench_XXXXXX";
+
+    if (mkdtemp(resourcePath) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    int result = 1;
+
+    {
+        CSIHost host;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "Virtual Port %d", i + 1);
+            host.AddMidiPort(name);
+        }
+
+        if (host.Load(argv[1], resourcePath) && host.WriteFile("CSI/CSI.ini", "Version=7.0\n") && host.CreateSurface())
+            result = bench(host, argc - 3, argv + 3);
+        else
+            printf("%s", host.GetConsole().c_str());
+    }
+
+    string cleanup = string("rm -rf ") + resourcePath;
+    if (system(cleanup.c_str()) != 0)
+        result = 1;
+
+    return result;
+}
@@ -0,0 +1,1740 @@
+//
+//  csi_host.cpp
+//  reaper_csurf_integrator test harness
+//
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sstream>
+
+#include "csi_host.h"
+
+#include "../reaper_csurf_integrator/oscpkt.hh"
+#include "../reaper_csurf_integrator/udp.hh"
+
+CSIHost *CSIHost::s_host = NULL;
+
+static const double s_midiFrameOffsetScale = 1024000.0; // midi_Input frame offsets are in 1/1024000 s, not sample frames
+
+// Every stub counts its own calls, so benchmarks can report REAPER API traffic by function name
+static vector<string> s_callNames;
+static vector<long long> s_callCounts;
+
+#define STUB_CALLED() static const int s_callIndex = CSIHost::RegisterCall(__FUNCTION__); CSIHost::CountCall(s_callIndex)
+
+static CSIHost *Host() { return CSIHost::Get(); }
+static StubTrack *TrackOf(MediaTrack *track) { return Host()->IsValidTrack(track) ? (StubTrack *)track : NULL; }
+
+static void CopyString(char *buf, int bufSize, const char *text)
+{
+    if (buf == NULL || bufSize <= 0)
+        return;
+
+    snprintf(buf, bufSize, "%s", text);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// StubTrack
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+StubFX &StubTrack::AddFX(const char *fxName, int numParams)
+{
+    fx.push_back(StubFX(fxName));
+
+    for (int i = 0; i < numParams; ++i)
+    {
+        char paramName[64];
+        snprintf(paramName, sizeof(paramName), "Param %d", i + 1);
+        fx.back().params.push_back(StubFXParam(paramName));
+    }
+
+    return fx.back();
+}
+
+StubSend &StubTrack::AddSend(StubTrack *destination)
+{
+    sends.push_back(StubSend(this, destination));
+    return sends.back();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Virtual MIDI devices
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+class StubEventList : public MIDI_eventlist
+{
+private:
+    vector<unsigned char> data_;
+
+    static int RecordSize(const MIDI_event_t *evt)
+    {
+        int size = (int)(sizeof(MIDI_event_t) - sizeof(evt->midi_message)) + (evt->size > 4 ? evt->size : 4);
+        return (size + 7) & ~7;
+    }
+
+public:
+    virtual void AddItem(MIDI_event_t *evt)
+    {
+        int pos = (int)data_.size();
+        data_.resize(pos + RecordSize(evt), 0);
+        memcpy(&data_[pos], evt, sizeof(MIDI_event_t) - sizeof(evt->midi_message) + evt->size);
+    }
+
+    virtual MIDI_event_t *EnumItems(int *bpos)
+    {
+        if (bpos == NULL || *bpos < 0 || *bpos >= (int)data_.size())
+            return NULL;
+
+        MIDI_event_t *evt = (MIDI_event_t *)&data_[*bpos];
+        *bpos += RecordSize(evt);
+        return evt;
+    }
+
+    virtual void DeleteItem(int bpos) {}
+    virtual int GetSize() { return (int)data_.size(); }
+    virtual void Empty() { data_.clear(); }
+};
+
+class VirtualMidiInput : public midi_Input
+{
+private:
+    int port_;
+    bool isRunning_;
+    double lastSwapTime_;
+    vector<HostMidiMessage> pending_;
+    StubEventList readBuf_;
+
+public:
+    VirtualMidiInput(int port) : port_(port), isRunning_(false), lastSwapTime_(-1.0) {}
+    virtual ~VirtualMidiInput() { Host()->ForgetMidiDevice(this); }
+
+    int GetPort() { return port_; }
+
+    void Queue(const unsigned char *bytes, int size)
+    {
+        HostMidiMessage message;
+        message.time = Host()->GetTime();
+        message.bytes.assign(bytes, bytes + size);
+        pending_.push_back(message);
+    }
+
+    virtual void start() { isRunning_ = true; }
+    virtual void stop() { isRunning_ = false; }
+
+    virtual void SwapBufs(unsigned int timestamp) { SwapBufsPrecise(timestamp, timestamp / 1000.0); }
+
+    // Everything that arrived since the previous swap becomes readable, stamped relative to that swap
+    virtual void SwapBufsPrecise(unsigned int coarsetimestamp, double precisetimestamp)
+    {
+        double now = Host()->GetTime();
+
+        readBuf_.Empty();
+
+        for (int i = 0; i < (int)pending_.size(); ++i)
+        {
+            const HostMidiMessage &message = pending_[i];
+
+            vector<unsigned char> storage(sizeof(MIDI_event_t) + message.bytes.size(), 0);
+            MIDI_event_t *evt = (MIDI_event_t *)&storage[0];
+
+            double offset = lastSwapTime_ < 0.0 ? 0.0 : message.time - lastSwapTime_;
+            evt->frame_offset = offset > 0.0 ? (int)(offset * s_midiFrameOffsetScale + 0.5) : 0;
+            evt->size = (int)message.bytes.size();
+            memcpy(evt->midi_message, &message.bytes[0], message.bytes.size());
+
+            if (isRunning_)
+                readBuf_.AddItem(evt);
+        }
+
+        pending_.clear();
+        lastSwapTime_ = now;
+    }
+
+    virtual MIDI_eventlist *GetReadBuf() { return &readBuf_; }
+};
+
+class VirtualMidiOutput : public midi_Output
+{
+private:
+    int port_;
+
+public:
+    VirtualMidiOutput(int port) : port_(port) {}
+    virtual ~VirtualMidiOutput() { Host()->ForgetMidiDevice(this); }
+
+    int GetPort() { return port_; }
+
+    virtual void SendMsg(MIDI_event_t *msg, int frame_offset)
+    {
+        if (msg != NULL && msg->size > 0)
+            Host()->ReceiveMidi(port_, msg->midi_message, msg->size);
+    }
+
+    virtual void Send(unsigned char status, unsigned char d1, unsigned char d2, int frame_offset)
+    {
+        unsigned char bytes[3] = { status, d1, d2 };
+        Host()->ReceiveMidi(port_, bytes, 3);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// REAPER API stubs -- every function the integrator calls, answered from the host's session model
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Tracks
+static int GetNumTracks() { STUB_CALLED(); return Host()->GetNumTracks(); }
+static int CSurf_NumTracks(bool mcpView) { STUB_CALLED(); return Host()->GetNumTracks(); }
+static MediaTrack *GetTrack(ReaProject *proj, int trackidx) { STUB_CALLED(); return (MediaTrack *)Host()->GetTrack(trackidx); }
+static MediaTrack *GetMasterTrack(ReaProject *proj) { STUB_CALLED(); return (MediaTrack *)Host()->GetMasterTrack(); }
+static MediaTrack *CSurf_TrackFromID(int idx, bool mcpView) { STUB_CALLED(); return (MediaTrack *)Host()->GetTrackFromId(idx); }
+static int CSurf_TrackToID(MediaTrack *track, bool mcpView) { STUB_CALLED(); return Host()->GetIdFromTrack(TrackOf(track)); }
+static bool ValidatePtr(void *pointer, const char *ctypename) { STUB_CALLED(); return ctypename != NULL && ! strcmp(ctypename, "MediaTrack*") && Host()->IsValidTrack(pointer); }
+
+static bool IsTrackVisible(MediaTrack *track, bool mixer)
+{
+    STUB_CALLED();
+
+    if (StubTrack *t = TrackOf(track))
+        return mixer ? t->isVisibleInMCP : t->isVisibleInTCP;
+
+    return false;
+}
+
+static bool GetTrackName(MediaTrack *track, char *bufOut, int bufOut_sz)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(track);
+
+    if (t == NULL)
+        return false;
+
+    if (t == Host()->GetMasterTrack())
+        CopyString(bufOut, bufOut_sz, "MASTER");
+    else if (t->name.empty())
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Track %d", Host()->GetIdFromTrack(t));
+        CopyString(bufOut, bufOut_sz, name);
+    }
+    else
+        CopyString(bufOut, bufOut_sz, t->name.c_str());
+
+    return true;
+}
+
+static int GetTrackColor(MediaTrack *track) { STUB_CALLED(); StubTrack *t = TrackOf(track); return t ? t->color : 0; }
+
+static void *GetSetMediaTrackInfo(MediaTrack *tr, const char *parmname, void *setNewValue)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(tr);
+
+    if (t == NULL || parmname == NULL)
+        return NULL;
+
+    if ( ! strcmp(parmname, "P_NAME"))
+    {
+        if (setNewValue)
+            t->name = (const char *)setNewValue;
+        return (void *)t->name.c_str();
+    }
+
+#define TRACK_FIELD(parm, field, type) if ( ! strcmp(parmname, parm)) { if (setNewValue) t->field = *(type *)setNewValue; return &t->field; }
+    TRACK_FIELD("I_CUSTOMCOLOR", color, int)
+    TRACK_FIELD("D_VOL", volume, double)
+    TRACK_FIELD("D_PAN", pan, double)
+    TRACK_FIELD("D_WIDTH", width, double)
+    TRACK_FIELD("D_DUALPANL", dualPanL, double)
+    TRACK_FIELD("D_DUALPANR", dualPanR, double)
+    TRACK_FIELD("I_PANMODE", panMode, int)
+    TRACK_FIELD("B_MUTE", isMuted, bool)
+    TRACK_FIELD("I_SOLO", solo, int)
+    TRACK_FIELD("I_RECARM", recArm, int)
+    TRACK_FIELD("I_RECINPUT", recInput, int)
+    TRACK_FIELD("I_RECMON", recMonitor, int)
+    TRACK_FIELD("I_RECMONITEMS", recMonitorItems, int)
+    TRACK_FIELD("I_AUTOMODE", autoMode, int)
+    TRACK_FIELD("B_PHASE", isPhaseInverted, bool)
+    TRACK_FIELD("B_MONO", isMono, bool)
+    TRACK_FIELD("I_SELECTED", selected, int)
+    TRACK_FIELD("I_FXEN", fxEnabled, int)
+    TRACK_FIELD("I_FOLDERDEPTH", folderDepth, int)
+    TRACK_FIELD("B_SHOWINMIXER", isVisibleInMCP, bool)
+    TRACK_FIELD("B_SHOWINTCP", isVisibleInTCP, bool)
+#undef TRACK_FIELD
+
+    if ( ! strcmp(parmname, "IP_TRACKNUMBER"))
+        return (void *)(intptr_t)Host()->GetIdFromTrack(t);
+
+    return NULL;
+}
+
+static double GetMediaTrackInfo_Value(MediaTrack *tr, const char *parmname)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(tr);
+
+    if (t == NULL || parmname == NULL)
+        return 0.0;
+
+    if ( ! strcmp(parmname, "IP_TRACKNUMBER"))
+        return t == Host()->GetMasterTrack() ? -1.0 : Host()->GetIdFromTrack(t);
+
+#define TRACK_VALUE(parm, field) if ( ! strcmp(parmname, parm)) return (double)t->field;
+    TRACK_VALUE("I_CUSTOMCOLOR", color)
+    TRACK_VALUE("D_VOL", volume)
+    TRACK_VALUE("D_PAN", pan)
+    TRACK_VALUE("D_WIDTH", width)
+    TRACK_VALUE("D_DUALPANL", dualPanL)
+    TRACK_VALUE("D_DUALPANR", dualPanR)
+    TRACK_VALUE("I_PANMODE", panMode)
+    TRACK_VALUE("B_MUTE", isMuted)
+    TRACK_VALUE("I_SOLO", solo)
+    TRACK_VALUE("I_RECARM", recArm)
+    TRACK_VALUE("I_RECINPUT", recInput)
+    TRACK_VALUE("I_RECMON", recMonitor)
+    TRACK_VALUE("I_RECMONITEMS", recMonitorItems)
+    TRACK_VALUE("I_AUTOMODE", autoMode)
+    TRACK_VALUE("B_PHASE", isPhaseInverted)
+    TRACK_VALUE("B_MONO", isMono)
+    TRACK_VALUE("I_SELECTED", selected)
+    TRACK_VALUE("I_FXEN", fxEnabled)
+    TRACK_VALUE("I_FOLDERDEPTH", folderDepth)
+    TRACK_VALUE("B_SHOWINMIXER", isVisibleInMCP)
+    TRACK_VALUE("B_SHOWINTCP", isVisibleInTCP)
+#undef TRACK_VALUE
+
+    return 0.0;
+}
+
+static unsigned int GetSetTrackGroupMembership(MediaTrack *tr, const char *groupname, unsigned int setmask, unsigned int setvalue)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(tr);
+
+    if (t == NULL || groupname == NULL)
+        return 0;
+
+    unsigned int *mask = NULL;
+
+    if ( ! strcmp(groupname, "VOLUME_VCA_LEAD"))
+        mask = &t->vcaLeadMask;
+    else if ( ! strcmp(groupname, "VOLUME_VCA_FOLLOW"))
+        mask = &t->vcaFollowMask;
+    else
+        return 0;
+
+    *mask = (*mask & ~setmask) | (setvalue & setmask);
+    return *mask;
+}
+
+static unsigned int GetSetTrackGroupMembershipHigh(MediaTrack *tr, const char *groupname, unsigned int setmask, unsigned int setvalue) { STUB_CALLED(); return 0; }
+
+static bool GetTrackUIVolPan(MediaTrack *track, double *volumeOut, double *panOut)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(track);
+
+    if (t == NULL)
+        return false;
+
+    if (volumeOut) *volumeOut = t->volume;
+    if (panOut) *panOut = t->pan;
+    return true;
+}
+
+static bool GetTrackUIMute(MediaTrack *track, bool *muteOut)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(track);
+
+    if (t == NULL)
+        return false;
+
+    if (muteOut) *muteOut = t->isMuted;
+    return true;
+}
+
+static bool GetTrackUIPan(MediaTrack *track, double *pan1Out, double *pan2Out, int *panmodeOut)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(track);
+
+    if (t == NULL)
+        return false;
+
+    if (pan1Out) *pan1Out = t->panMode == 6 ? t->dualPanL : t->pan;
+    if (pan2Out) *pan2Out = t->panMode == 6 ? t->dualPanR : t->width;
+    if (panmodeOut) *panmodeOut = t->panMode;
+    return true;
+}
+
+static double Track_GetPeakInfo(MediaTrack *track, int channel) { STUB_CALLED(); StubTrack *t = TrackOf(track); return t ? t->peaks[channel & 1] : 0.0; }
+
+// Track changes made by the surface
+static double CSurf_OnVolumeChange(MediaTrack *trackid, double volume, bool relative)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return volume;
+
+    t->volume = relative ? t->volume + volume : volume;
+    if (t->volume < 0.0)
+        t->volume = 0.0;
+    return t->volume;
+}
+
+static double CSurf_OnPanChange(MediaTrack *trackid, double pan, bool relative)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return pan;
+
+    t->pan = relative ? t->pan + pan : pan;
+    t->pan = t->pan < -1.0 ? -1.0 : t->pan > 1.0 ? 1.0 : t->pan;
+    return t->pan;
+}
+
+static double CSurf_OnWidthChange(MediaTrack *trackid, double width, bool relative)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return width;
+
+    t->width = relative ? t->width + width : width;
+    t->width = t->width < -1.0 ? -1.0 : t->width > 1.0 ? 1.0 : t->width;
+    return t->width;
+}
+
+static bool CSurf_OnMuteChange(MediaTrack *trackid, int mute)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return false;
+
+    t->isMuted = mute < 0 ? ! t->isMuted : mute != 0;
+    return t->isMuted;
+}
+
+static bool CSurf_OnSoloChange(MediaTrack *trackid, int solo)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return false;
+
+    t->solo = solo < 0 ? (t->solo ? 0 : 1) : solo;
+    return t->solo != 0;
+}
+
+static bool CSurf_OnRecArmChange(MediaTrack *trackid, int recarm)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return false;
+
+    t->recArm = recarm < 0 ? (t->recArm ? 0 : 1) : recarm;
+    return t->recArm != 0;
+}
+
+static bool CSurf_OnSelectedChange(MediaTrack *trackid, int selected)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(trackid);
+
+    if (t == NULL)
+        return false;
+
+    t->selected = selected < 0 ? ! t->selected : selected != 0;
+    return t->selected != 0;
+}
+
+static void CSurf_SetSurfaceVolume(MediaTrack *trackid, double volume, IReaperControlSurface *ignoresurf) { STUB_CALLED(); }
+static void CSurf_SetSurfacePan(MediaTrack *trackid, double pan, IReaperControlSurface *ignoresurf) { STUB_CALLED(); }
+static void CSurf_SetSurfaceMute(MediaTrack *trackid, bool mute, IReaperControlSurface *ignoresurf) { STUB_CALLED(); }
+static void CSurf_SetSurfaceSolo(MediaTrack *trackid, bool solo, IReaperControlSurface *ignoresurf) { STUB_CALLED(); }
+static void CSurf_SetSurfaceRecArm(MediaTrack *trackid, bool recarm, IReaperControlSurface *ignoresurf) { STUB_CALLED(); }
+static void CSurf_SetSurfaceSelected(MediaTrack *trackid, bool selected, IReaperControlSurface *ignoresurf) { STUB_CALLED(); }
+
+// Selection and solo
+static int CountSelectedTracks2(ReaProject *proj, bool wantmaster)
+{
+    STUB_CALLED();
+
+    int count = Host()->CountSelectedTracks();
+
+    if (wantmaster && Host()->GetMasterTrack()->selected)
+        count++;
+
+    return count;
+}
+
+static MediaTrack *GetSelectedTrack(ReaProject *proj, int seltrackidx) { STUB_CALLED(); return (MediaTrack *)Host()->GetSelectedTrack(seltrackidx); }
+static void SetOnlyTrackSelected(MediaTrack *track) { STUB_CALLED(); Host()->SelectOnly(TrackOf(track)); }
+static MediaTrack *SetMixerScroll(MediaTrack *leftmosttrack) { STUB_CALLED(); return leftmosttrack; }
+
+static bool AnyTrackSolo(ReaProject *proj)
+{
+    STUB_CALLED();
+
+    for (int i = 0; i < Host()->GetNumTracks(); ++i)
+        if (Host()->GetTrack(i)->solo)
+            return true;
+
+    return false;
+}
+
+static void SoloAllTracks(int solo)
+{
+    STUB_CALLED();
+
+    for (int i = 0; i < Host()->GetNumTracks(); ++i)
+        Host()->GetTrack(i)->solo = solo;
+}
+
+static int GetMasterMuteSoloFlags()
+{
+    STUB_CALLED();
+
+    StubTrack *master = Host()->GetMasterTrack();
+    return (master->isMuted ? 1 : 0) | (master->solo ? 2 : 0);
+}
+
+// Sends and receives -- receives are other tracks' sends, found by destination
+static StubSend *FindSend(StubTrack *t, int category, int index)
+{
+    if (t == NULL || index < 0)
+        return NULL;
+
+    if (category == 0)
+        return index < (int)t->sends.size() ? &t->sends[index] : NULL;
+
+    if (category < 0)
+    {
+        for (int i = 0; i < Host()->GetNumTracks(); ++i)
+        {
+            StubTrack *source = Host()->GetTrack(i);
+
+            for (int j = 0; j < (int)source->sends.size(); ++j)
+                if (source->sends[j].destination == t && index-- == 0)
+                    return &source->sends[j];
+        }
+    }
+
+    return NULL;
+}
+
+static int GetTrackNumSends(MediaTrack *tr, int category)
+{
+    STUB_CALLED();
+
+    StubTrack *t = TrackOf(tr);
+
+    if (t == NULL || category > 0)
+        return 0;
+
+    int count = 0;
+
+    while (FindSend(t, category, count))
+        count++;
+
+    return count;
+}
+
+static double GetTrackSendInfo_Value(MediaTrack *tr, int category, int sendidx, const char *parmname)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindSend(TrackOf(tr), category, sendidx);
+
+    if (send == NULL || parmname == NULL)
+        return 0.0;
+
+    if ( ! strcmp(parmname, "P_DESTTRACK")) return (double)(intptr_t)send->destination;
+    if ( ! strcmp(parmname, "P_SRCTRACK")) return (double)(intptr_t)send->source;
+    if ( ! strcmp(parmname, "B_MUTE")) return send->isMuted;
+    if ( ! strcmp(parmname, "D_VOL")) return send->volume;
+    if ( ! strcmp(parmname, "D_PAN")) return send->pan;
+
+    return 0.0;
+}
+
+static void *GetSetTrackSendInfo(MediaTrack *tr, int category, int sendidx, const char *parmname, void *setNewValue)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindSend(TrackOf(tr), category, sendidx);
+
+    if (send == NULL || parmname == NULL)
+        return NULL;
+
+    if ( ! strcmp(parmname, "P_DESTTRACK")) return send->destination;
+    if ( ! strcmp(parmname, "P_SRCTRACK")) return send->source;
+    if ( ! strcmp(parmname, "B_MUTE")) { if (setNewValue) send->isMuted = *(bool *)setNewValue; return &send->isMuted; }
+    if ( ! strcmp(parmname, "D_VOL")) { if (setNewValue) send->volume = *(double *)setNewValue; return &send->volume; }
+    if ( ! strcmp(parmname, "D_PAN")) { if (setNewValue) send->pan = *(double *)setNewValue; return &send->pan; }
+
+    return NULL;
+}
+
+// UI send indices: >= 0 are sends, < 0 are receives (-1 is the first)
+static StubSend *FindUISend(MediaTrack *track, int index)
+{
+    return index >= 0 ? FindSend(TrackOf(track), 0, index) : FindSend(TrackOf(track), -1, -1 - index);
+}
+
+static bool GetTrackSendUIVolPan(MediaTrack *track, int send_index, double *volumeOut, double *panOut)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindSend(TrackOf(track), 0, send_index);
+
+    if (send == NULL)
+        return false;
+
+    if (volumeOut) *volumeOut = send->volume;
+    if (panOut) *panOut = send->pan;
+    return true;
+}
+
+static bool GetTrackSendUIMute(MediaTrack *track, int send_index, bool *muteOut)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindSend(TrackOf(track), 0, send_index);
+
+    if (send == NULL)
+        return false;
+
+    if (muteOut) *muteOut = send->isMuted;
+    return true;
+}
+
+static bool GetTrackReceiveUIVolPan(MediaTrack *track, int recv_index, double *volumeOut, double *panOut)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindSend(TrackOf(track), -1, recv_index);
+
+    if (send == NULL)
+        return false;
+
+    if (volumeOut) *volumeOut = send->volume;
+    if (panOut) *panOut = send->pan;
+    return true;
+}
+
+static bool GetTrackReceiveUIMute(MediaTrack *track, int recv_index, bool *muteOut)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindSend(TrackOf(track), -1, recv_index);
+
+    if (send == NULL)
+        return false;
+
+    if (muteOut) *muteOut = send->isMuted;
+    return true;
+}
+
+static bool SetTrackSendUIVol(MediaTrack *track, int send_idx, double vol, int isend)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindUISend(track, send_idx);
+
+    if (send == NULL)
+        return false;
+
+    send->volume = vol;
+    return true;
+}
+
+static bool SetTrackSendUIPan(MediaTrack *track, int send_idx, double pan, int isend)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindUISend(track, send_idx);
+
+    if (send == NULL)
+        return false;
+
+    send->pan = pan;
+    return true;
+}
+
+static bool ToggleTrackSendUIMute(MediaTrack *track, int send_idx)
+{
+    STUB_CALLED();
+
+    StubSend *send = FindUISend(track, send_idx);
+
+    if (send == NULL)
+        return false;
+
+    send->isMuted = ! send->isMuted;
+    return true;
+}
+
+// FX
+static StubFX *FindFX(MediaTrack *track, int fx)
+{
+    StubTrack *t = TrackOf(track);
+
+    if (t == NULL || fx < 0 || fx >= (int)t->fx.size())
+        return NULL;
+
+    return &t->fx[fx];
+}
+
+static StubFXParam *FindFXParam(MediaTrack *track, int fx, int param)
+{
+    StubFX *stubFX = FindFX(track, fx);
+
+    if (stubFX == NULL || param < 0 || param >= (int)stubFX->params.size())
+        return NULL;
+
+    return &stubFX->params[param];
+}
+
+static int TrackFX_GetCount(MediaTrack *track) { STUB_CALLED(); StubTrack *t = TrackOf(track); return t ? (int)t->fx.size() : 0; }
+
+static bool TrackFX_GetFXName(MediaTrack *track, int fx, char *bufOut, int bufOut_sz)
+{
+    STUB_CALLED();
+
+    StubFX *stubFX = FindFX(track, fx);
+
+    CopyString(bufOut, bufOut_sz, stubFX ? stubFX->name.c_str() : "");
+    return stubFX != NULL;
+}
+
+static int TrackFX_GetNumParams(MediaTrack *track, int fx) { STUB_CALLED(); StubFX *stubFX = FindFX(track, fx); return stubFX ? (int)stubFX->params.size() : 0; }
+
+static double TrackFX_GetParam(MediaTrack *track, int fx, int param, double *minvalOut, double *maxvalOut)
+{
+    STUB_CALLED();
+
+    StubFXParam *p = FindFXParam(track, fx, param);
+
+    if (minvalOut) *minvalOut = p ? p->minValue : 0.0;
+    if (maxvalOut) *maxvalOut = p ? p->maxValue : 0.0;
+    return p ? p->value : 0.0;
+}
+
+static double TrackFX_GetParamEx(MediaTrack *track, int fx, int param, double *minvalOut, double *maxvalOut, double *midvalOut)
+{
+    STUB_CALLED();
+
+    StubFXParam *p = FindFXParam(track, fx, param);
+
+    if (minvalOut) *minvalOut = p ? p->minValue : 0.0;
+    if (maxvalOut) *maxvalOut = p ? p->maxValue : 0.0;
+    if (midvalOut) *midvalOut = p ? (p->minValue + p->maxValue) / 2.0 : 0.0;
+    return p ? p->value : 0.0;
+}
+
+static double TrackFX_GetParamNormalized(MediaTrack *track, int fx, int param)
+{
+    STUB_CALLED();
+
+    StubFXParam *p = FindFXParam(track, fx, param);
+
+    if (p == NULL || p->maxValue == p->minValue)
+        return 0.0;
+
+    return (p->value - p->minValue) / (p->maxValue - p->minValue);
+}
+
+static bool TrackFX_SetParam(MediaTrack *track, int fx, int param, double val)
+{
+    STUB_CALLED();
+
+    StubFXParam *p = FindFXParam(track, fx, param);
+
+    if (p == NULL)
+        return false;
+
+    p->value = val;
+    return true;
+}
+
+static bool TrackFX_EndParamEdit(MediaTrack *track, int fx, int param) { STUB_CALLED(); return FindFXParam(track, fx, param) != NULL; }
+
+static bool TrackFX_GetParamName(MediaTrack *track, int fx, int param, char *bufOut, int bufOut_sz)
+{
+    STUB_CALLED();
+
+    StubFXParam *p = FindFXParam(track, fx, param);
+
+    CopyString(bufOut, bufOut_sz, p ? p->name.c_str() : "");
+    return p != NULL;
+}
+
+static bool TrackFX_GetFormattedParamValue(MediaTrack *track, int fx, int param, char *bufOut, int bufOut_sz)
+{
+    STUB_CALLED();
+
+    StubFXParam *p = FindFXParam(track, fx, param);
+
+    if (p == NULL)
+    {
+        CopyString(bufOut, bufOut_sz, "");
+        return false;
+    }
+
+    if (bufOut && bufOut_sz > 0)
+        snprintf(bufOut, bufOut_sz, "%.2f", p->value);
+    return true;
+}
+
+static bool TrackFX_GetParameterStepSizes(MediaTrack *track, int fx, int param, double *stepOut, double *smallstepOut, double *largestepOut, bool *istoggleOut) { STUB_CALLED(); return false; }
+
+static bool TrackFX_GetNamedConfigParm(MediaTrack *track, int fx, const char *parmname, char *bufOutNeedBig, int bufOutNeedBig_sz)
+{
+    STUB_CALLED();
+
+    StubFX *stubFX = FindFX(track, fx);
+
+    if (stubFX == NULL || parmname == NULL)
+        return false;
+
+    if ( ! strcmp(parmname, "fx_ident") || ! strcmp(parmname, "fx_name"))
+    {
+        CopyString(bufOutNeedBig, bufOutNeedBig_sz, stubFX->name.c_str());
+        return true;
+    }
+
+    return false;
+}
+
+static bool TrackFX_GetEnabled(MediaTrack *track, int fx) { STUB_CALLED(); StubFX *stubFX = FindFX(track, fx); return stubFX && stubFX->isEnabled; }
+static void TrackFX_SetEnabled(MediaTrack *track, int fx, bool enabled) { STUB_CALLED(); if (StubFX *stubFX = FindFX(track, fx)) stubFX->isEnabled = enabled; }
+static bool TrackFX_GetOffline(MediaTrack *track, int fx) { STUB_CALLED(); StubFX *stubFX = FindFX(track, fx); return stubFX && stubFX->isOffline; }
+static void TrackFX_SetOffline(MediaTrack *track, int fx, bool offline) { STUB_CALLED(); if (StubFX *stubFX = FindFX(track, fx)) stubFX->isOffline = offline; }
+static void TrackFX_SetOpen(MediaTrack *track, int fx, bool open) { STUB_CALLED(); if (StubFX *stubFX = FindFX(track, fx)) stubFX->isOpen = open; }
+static void TrackFX_Show(MediaTrack *track, int index, int showFlag) { STUB_CALLED(); if (StubFX *stubFX = FindFX(track, index)) stubFX->isOpen = showFlag != 0 && showFlag != 2; }
+
+static bool GetLastTouchedFX(int *tracknumberOut, int *fxnumberOut, int *paramnumberOut) { STUB_CALLED(); return Host()->GetLastTouchedFX(tracknumberOut, fxnumberOut, paramnumberOut); }
+
+static bool GetTouchedOrFocusedFX(int mode, int *trackidxOut, int *itemidxOut, int *takeidxOut, int *fxidxOut, int *parmOut)
+{
+    STUB_CALLED();
+
+    int trackId = 0;
+    int fxIndex = 0;
+    int paramIndex = 0;
+
+    bool found = mode == 0 ? Host()->GetLastTouchedFX(&trackId, &fxIndex, &paramIndex) : Host()->GetFocusedFX(&trackId, &fxIndex);
+
+    if ( ! found)
+        return false;
+
+    if (trackidxOut) *trackidxOut = trackId - 1; // -1 = master
+    if (itemidxOut) *itemidxOut = -1;
+    if (takeidxOut) *takeidxOut = -1;
+    if (fxidxOut) *fxidxOut = fxIndex;
+    if (parmOut) *parmOut = paramIndex;
+    return true;
+}
+
+static int CountTCPFXParms(ReaProject *project, MediaTrack *track) { STUB_CALLED(); return 0; }
+static bool GetTCPFXParm(ReaProject *project, MediaTrack *track, int index, int *fxindexOut, int *parmidxOut) { STUB_CALLED(); return false; }
+
+// Items and takes -- the session model has none
+static int CountTrackMediaItems(MediaTrack *track) { STUB_CALLED(); return 0; }
+static MediaItem *GetTrackMediaItem(MediaTrack *tr, int itemidx) { STUB_CALLED(); return NULL; }
+static int CountTakes(MediaItem *item) { STUB_CALLED(); return 0; }
+static MediaItem_Take *GetMediaItemTake(MediaItem *item, int tk) { STUB_CALLED(); return NULL; }
+static int TakeFX_GetCount(MediaItem_Take *take) { STUB_CALLED(); return 0; }
+static void TakeFX_Show(MediaItem_Take *take, int index, int showFlag) { STUB_CALLED(); }
+
+// Transport
+static int GetPlayState() { STUB_CALLED(); return Host()->GetPlayState(); }
+static double GetPlayPosition() { STUB_CALLED(); return Host()->PlayPosition(); }
+static double GetCursorPosition() { STUB_CALLED(); return Host()->CursorPosition(); }
+static double GetProjectLength(ReaProject *proj) { STUB_CALLED(); return Host()->GetProjectLength(); }
+static void CSurf_OnPlay() { STUB_CALLED(); Host()->SetPlayState(1); }
+static void CSurf_OnStop() { STUB_CALLED(); Host()->SetPlayState(0); }
+static void CSurf_OnRecord() { STUB_CALLED(); Host()->SetPlayState(5); }
+static void CSurf_OnFwd(int seekplay) { STUB_CALLED(); Host()->CursorPosition() += 1.0; }
+static void CSurf_OnRew(int seekplay) { STUB_CALLED(); Host()->CursorPosition() = Host()->CursorPosition() > 1.0 ? Host()->CursorPosition() - 1.0 : 0.0; }
+static void SetEditCurPos(double time, bool moveview, bool seekplay) { STUB_CALLED(); Host()->CursorPosition() = time; }
+static void MoveEditCursor(double adjamt, bool dosel) { STUB_CALLED(); Host()->CursorPosition() += adjamt; }
+
+static int GetSetRepeatEx(ReaProject *proj, int val)
+{
+    STUB_CALLED();
+
+    if (val >= 0)
+        Host()->Repeat() = val > 1 ? ! Host()->Repeat() : val;
+
+    return Host()->Repeat();
+}
+
+static int GetGlobalAutomationOverride() { STUB_CALLED(); return Host()->AutomationOverride(); }
+static void SetGlobalAutomationOverride(int mode) { STUB_CALLED(); Host()->AutomationOverride() = mode; }
+
+// 120 bpm, 4/4 throughout
+static double TimeMap2_timeToBeats(ReaProject *proj, double tpos, int *measuresOutOptional, int *cmlOutOptional, double *fullbeatsOutOptional, int *cdenomOutOptional)
+{
+    STUB_CALLED();
+
+    double beats = tpos * 2.0;
+    int measures = (int)floor(beats / 4.0);
+
+    if (measuresOutOptional) *measuresOutOptional = measures;
+    if (cmlOutOptional) *cmlOutOptional = 4;
+    if (fullbeatsOutOptional) *fullbeatsOutOptional = beats;
+    if (cdenomOutOptional) *cdenomOutOptional = 4;
+    return beats - measures * 4.0;
+}
+
+static void format_timestr_pos(double tpos, char *buf, int buf_sz, int modeoverride) { STUB_CALLED(); if (buf && buf_sz > 0) snprintf(buf, buf_sz, "%.3f", tpos); }
+
+// Actions and toggle states
+static int NamedCommandLookup(const char *command_name) { STUB_CALLED(); return Host()->LookupNamedCommand(command_name); }
+static int GetToggleCommandState(int command_id) { STUB_CALLED(); return Host()->GetToggleState(command_id); }
+static void PreventUIRefresh(int prevent_count) { STUB_CALLED(); }
+
+// Undo and project state
+static const char *Undo_CanUndo2(ReaProject *proj) { STUB_CALLED(); return NULL; }
+static const char *Undo_CanRedo2(ReaProject *proj) { STUB_CALLED(); return NULL; }
+static int Undo_DoUndo2(ReaProject *proj) { STUB_CALLED(); return 0; }
+static int Undo_DoRedo2(ReaProject *proj) { STUB_CALLED(); return 0; }
+static int IsProjectDirty(ReaProject *proj) { STUB_CALLED(); return 0; }
+static void Main_SaveProject(ReaProject *proj, bool forceSaveAsInOptional) { STUB_CALLED(); }
+static int SetProjExtState(ReaProject *proj, const char *extname, const char *key, const char *value) { STUB_CALLED(); return 0; }
+
+// Configuration
+static union { int intValue; double doubleValue; } s_projectConfig[8];
+
+static int projectconfig_var_getoffs(const char *name, int *szOut)
+{
+    STUB_CALLED();
+
+    static const struct { const char *name; int size; } s_vars[] =
+    {
+        { "projtimemode", 4 }, { "projtimemode2", 4 }, { "projmeasoffs", 4 }, { "projtimeoffs", 8 },
+        { "panmode", 4 }, { "projmetrov1", 8 }, { "projmetrov2", 8 },
+    };
+
+    for (int i = 0; i < (int)(sizeof(s_vars) / sizeof(s_vars[0])); ++i)
+        if (name && ! strcmp(name, s_vars[i].name))
+        {
+            if (szOut) *szOut = s_vars[i].size;
+            return i;
+        }
+
+    if (szOut) *szOut = 0;
+    return -1;
+}
+
+static void *projectconfig_var_addr(ReaProject *proj, int idx) { STUB_CALLED(); return idx >= 0 && idx < 8 ? &s_projectConfig[idx] : NULL; }
+static void *get_config_var(const char *name, int *szOut) { STUB_CALLED(); if (szOut) *szOut = 0; return NULL; }
+static const char *get_ini_file() { STUB_CALLED(); return Host()->GetIniPath(); }
+static const char *GetResourcePath() { STUB_CALLED(); return Host()->GetResourcePath().c_str(); }
+static const char *GetExtState(const char *section, const char *key) { STUB_CALLED(); return Host()->GetExtState(section, key); }
+static void SetExtState(const char *section, const char *key, const char *value, bool persist) { STUB_CALLED(); Host()->SetExtState(section, key, value); }
+static void *plugin_getapi(const char *name) { STUB_CALLED(); return NULL; }
+
+static bool file_exists(const char *path)
+{
+    STUB_CALLED();
+
+    struct stat st;
+    return path != NULL && stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+static int MakeDirectories(const char *path)
+{
+    string partial;
+
+    for (const char *p = path; *p; ++p)
+    {
+        partial += *p;
+
+        if ((*p == '/' && partial.size() > 1) || p[1] == 0)
+            if (mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST)
+                return 0;
+    }
+
+    return 1;
+}
+
+static int RecursiveCreateDirectory(const char *path, size_t ignored) { STUB_CALLED(); return path ? MakeDirectories(path) : 0; }
+
+// Colors and scaling
+static int ColorToNative(int r, int g, int b) { STUB_CALLED(); return (r & 0xff) | ((g & 0xff) << 8) | ((b & 0xff) << 16); }
+
+static void ColorFromNative(int col, int *rOut, int *gOut, int *bOut)
+{
+    STUB_CALLED();
+
+    if (rOut) *rOut = col & 0xff;
+    if (gOut) *gOut = (col >> 8) & 0xff;
+    if (bOut) *bOut = (col >> 16) & 0xff;
+}
+
+static int GR_SelectColor(HWND hwnd, int *colorOut) { STUB_CALLED(); return 0; }
+
+// Fader law: 0..1000 slider over -150..+12 dB, linear in dB -- monotonic and invertible, which is all CSI relies on
+static double DB2SLIDER(double x)
+{
+    STUB_CALLED();
+
+    double slider = (x + 150.0) / 162.0 * 1000.0;
+    return slider < 0.0 ? 0.0 : slider > 1000.0 ? 1000.0 : slider;
+}
+
+static double SLIDER2DB(double y) { STUB_CALLED(); return y / 1000.0 * 162.0 - 150.0; }
+
+// Console, clock and MIDI devices
+static void ShowConsoleMsg(const char *msg) { STUB_CALLED(); Host()->AppendConsole(msg); }
+static double time_precise() { STUB_CALLED(); return Host()->GetTime(); }
+static int GetNumMIDIInputs() { STUB_CALLED(); return Host()->GetNumMidiPorts(); }
+static int GetNumMIDIOutputs() { STUB_CALLED(); return Host()->GetNumMidiPorts(); }
+
+static bool GetMIDIInputName(int dev, char *nameout, int nameout_sz)
+{
+    STUB_CALLED();
+
+    const char *name = Host()->GetMidiPortName(dev);
+    CopyString(nameout, nameout_sz, name ? name : "");
+    return name != NULL;
+}
+
+static bool GetMIDIOutputName(int dev, char *nameout, int nameout_sz)
+{
+    STUB_CALLED();
+
+    const char *name = Host()->GetMidiPortName(dev);
+    CopyString(nameout, nameout_sz, name ? name : "");
+    return name != NULL;
+}
+
+static midi_Input *CreateMIDIInput(int dev) { STUB_CALLED(); return Host()->CreateMidiInput(dev); }
+static midi_Output *CreateMIDIOutput(int dev, bool streamMode, int *msoffset100) { STUB_CALLED(); return Host()->CreateMidiOutput(dev); }
+
+// Localization: strings pass through untranslated
+static const char *LocalizeFunc(const char *str, const char *subctx, int flags) { return str; }
+
+// Anything the integrator does not call resolves here, so REAPERAPI_LoadAPI() still succeeds
+static void *UnstubbedFunction() { return NULL; }
+
+#define STUB(name) { #name, (void *)name }
+
+static const struct { const char *name; void *func; } s_reaperFunctions[] =
+{
+    STUB(AnyTrackSolo), STUB(CSurf_NumTracks), STUB(CSurf_OnFwd), STUB(CSurf_OnMuteChange), STUB(CSurf_OnPanChange),
+    STUB(CSurf_OnPlay), STUB(CSurf_OnRecArmChange), STUB(CSurf_OnRecord), STUB(CSurf_OnRew), STUB(CSurf_OnSelectedChange),
+    STUB(CSurf_OnSoloChange), STUB(CSurf_OnStop), STUB(CSurf_OnVolumeChange), STUB(CSurf_OnWidthChange),
+    STUB(CSurf_SetSurfaceMute), STUB(CSurf_SetSurfacePan), STUB(CSurf_SetSurfaceRecArm), STUB(CSurf_SetSurfaceSelected),
+    STUB(CSurf_SetSurfaceSolo), STUB(CSurf_SetSurfaceVolume), STUB(CSurf_TrackFromID), STUB(CSurf_TrackToID),
+    STUB(ColorFromNative), STUB(ColorToNative), STUB(CountSelectedTracks2), STUB(CountTCPFXParms), STUB(CountTakes),
+    STUB(CountTrackMediaItems), STUB(CreateMIDIInput), STUB(CreateMIDIOutput), STUB(DB2SLIDER), STUB(GR_SelectColor),
+    STUB(GetCursorPosition), STUB(GetExtState), STUB(GetGlobalAutomationOverride), STUB(GetLastTouchedFX),
+    STUB(GetMIDIInputName), STUB(GetMIDIOutputName), STUB(GetMasterMuteSoloFlags), STUB(GetMasterTrack),
+    STUB(GetMediaItemTake), STUB(GetMediaTrackInfo_Value), STUB(GetNumMIDIInputs), STUB(GetNumMIDIOutputs),
+    STUB(GetNumTracks), STUB(GetPlayPosition), STUB(GetPlayState), STUB(GetProjectLength), STUB(GetResourcePath),
+    STUB(GetSelectedTrack), STUB(GetSetMediaTrackInfo), STUB(GetSetRepeatEx), STUB(GetSetTrackGroupMembership),
+    STUB(GetSetTrackGroupMembershipHigh), STUB(GetSetTrackSendInfo), STUB(GetTCPFXParm), STUB(GetToggleCommandState),
+    STUB(GetTouchedOrFocusedFX), STUB(GetTrack), STUB(GetTrackColor), STUB(GetTrackMediaItem), STUB(GetTrackName),
+    STUB(GetTrackNumSends), STUB(GetTrackReceiveUIMute), STUB(GetTrackReceiveUIVolPan), STUB(GetTrackSendInfo_Value),
+    STUB(GetTrackSendUIMute), STUB(GetTrackSendUIVolPan), STUB(GetTrackUIMute), STUB(GetTrackUIPan), STUB(GetTrackUIVolPan),
+    STUB(IsProjectDirty), STUB(IsTrackVisible), STUB(Main_SaveProject), STUB(MoveEditCursor), STUB(NamedCommandLookup),
+    STUB(PreventUIRefresh), STUB(RecursiveCreateDirectory), STUB(SLIDER2DB), STUB(SetEditCurPos), STUB(SetExtState),
+    STUB(SetGlobalAutomationOverride), STUB(SetMixerScroll), STUB(SetOnlyTrackSelected), STUB(SetProjExtState),
+    STUB(SetTrackSendUIPan), STUB(SetTrackSendUIVol), STUB(ShowConsoleMsg), STUB(SoloAllTracks), STUB(TakeFX_GetCount),
+    STUB(TakeFX_Show), STUB(TimeMap2_timeToBeats), STUB(ToggleTrackSendUIMute), STUB(TrackFX_EndParamEdit),
+    STUB(TrackFX_GetCount), STUB(TrackFX_GetEnabled), STUB(TrackFX_GetFXName), STUB(TrackFX_GetFormattedParamValue),
+    STUB(TrackFX_GetNamedConfigParm), STUB(TrackFX_GetNumParams), STUB(TrackFX_GetOffline), STUB(TrackFX_GetParam),
+    STUB(TrackFX_GetParamEx), STUB(TrackFX_GetParamName), STUB(TrackFX_GetParamNormalized),
+    STUB(TrackFX_GetParameterStepSizes), STUB(TrackFX_SetEnabled), STUB(TrackFX_SetOffline), STUB(TrackFX_SetOpen),
+    STUB(TrackFX_SetParam), STUB(TrackFX_Show), STUB(Track_GetPeakInfo), STUB(Undo_CanRedo2), STUB(Undo_CanUndo2),
+    STUB(Undo_DoRedo2), STUB(Undo_DoUndo2), STUB(ValidatePtr), STUB(file_exists), STUB(format_timestr_pos),
+    STUB(get_config_var), STUB(get_ini_file), STUB(plugin_getapi), STUB(projectconfig_var_addr),
+    STUB(projectconfig_var_getoffs), STUB(time_precise),
+    { "__localizeFunc", (void *)LocalizeFunc },
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SWELL stubs -- the plug-in is built with SWELL_PROVIDED_BY_APP, so the host supplies these too
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static DWORD Swell_GetTickCount() { return (DWORD)(Host()->GetTime() * 1000.0); }
+static void Swell_Sleep(int ms) { if (ms > 0) usleep(ms * 1000); }
+
+static int Swell_MessageBox(HWND hwndParent, const char *text, const char *caption, int type)
+{
+    char buffer[1024];
+    snprintf(buffer, sizeof(buffer), "MessageBox: %s: %s\n", caption ? caption : "", text ? text : "");
+    Host()->AppendConsole(buffer);
+    return 1; // IDOK
+}
+
+static LRESULT Swell_SendMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    if (msg == WM_COMMAND)
+        Host()->RunCommand((int)(wParam & 0xffff));
+
+    return 0;
+}
+
+static DWORD Swell_GetPrivateProfileString(const char *appname, const char *keyname, const char *def, char *ret, int retsize, const char *fn)
+{
+    CopyString(ret, retsize, def ? def : "");
+    return ret ? (DWORD)strlen(ret) : 0;
+}
+
+static BOOL Swell_WritePrivateProfileString(const char *appname, const char *keyname, const char *val, const char *fn) { return TRUE; }
+
+static const struct { const char *name; void *func; } s_swellFunctions[] =
+{
+    { "GetTickCount", (void *)Swell_GetTickCount },
+    { "Sleep", (void *)Swell_Sleep },
+    { "MessageBox", (void *)Swell_MessageBox },
+    { "SendMessage", (void *)Swell_SendMessage },
+    { "GetPrivateProfileString", (void *)Swell_GetPrivateProfileString },
+    { "WritePrivateProfileString", (void *)Swell_WritePrivateProfileString },
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CSIHost
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static double MonotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+CSIHost::CSIHost()
+{
+    s_host = this;
+
+    pluginModule_ = NULL;
+    memset(&pluginInfo_, 0, sizeof(pluginInfo_));
+    csurfReg_ = NULL;
+    surface_ = NULL;
+
+    isRealTime_ = false;
+    simulatedTime_ = 100.0;
+    realTimeBase_ = MonotonicTime() - simulatedTime_;
+    tickInterval_ = 1.0 / 30.0; // REAPER runs control surfaces at roughly 30Hz
+
+    master_ = new StubTrack("MASTER");
+
+    playState_ = 0;
+    playPosition_ = 0.0;
+    cursorPosition_ = 0.0;
+    projectLength_ = 600.0;
+    repeat_ = 0;
+    automationOverride_ = -1;
+
+    lastTouchedTrack_ = -1;
+    lastTouchedFX_ = 0;
+    lastTouchedParam_ = 0;
+    focusedTrack_ = -1;
+    focusedFX_ = 0;
+
+    isConsoleEchoed_ = false;
+}
+
+CSIHost::~CSIHost()
+{
+    Unload();
+    ClearTracks();
+    delete master_;
+
+    if (s_host == this)
+        s_host = NULL;
+}
+
+int CSIHost::Register(const char *name, void *infostruct)
+{
+    if (name == NULL)
+        return 0;
+
+    if (name[0] == '-')
+    {
+        s_host->registered_.erase(name + 1);
+
+        if ( ! strcmp(name + 1, "csurf"))
+            s_host->csurfReg_ = NULL;
+
+        return 1;
+    }
+
+    s_host->registered_[name] = infostruct;
+
+    if ( ! strcmp(name, "csurf"))
+        s_host->csurfReg_ = (reaper_csurf_reg_t *)infostruct;
+
+    return 1;
+}
+
+void *CSIHost::GetFunc(const char *name)
+{
+    if (name == NULL)
+        return NULL;
+
+    for (int i = 0; i < (int)(sizeof(s_reaperFunctions) / sizeof(s_reaperFunctions[0])); ++i)
+        if ( ! strcmp(name, s_reaperFunctions[i].name))
+            return s_reaperFunctions[i].func;
+
+    if ( ! strncmp(name, "__localize", 10))
+        return NULL; // the localization importer copes with the rest being absent
+
+    return (void *)UnstubbedFunction;
+}
+
+void *CSIHost::GetSwellFunc(const char *name)
+{
+    if (name == NULL)
+        return NULL;
+
+    for (int i = 0; i < (int)(sizeof(s_swellFunctions) / sizeof(s_swellFunctions[0])); ++i)
+        if ( ! strcmp(name, s_swellFunctions[i].name))
+            return s_swellFunctions[i].func;
+
+    return (void *)UnstubbedFunction;
+}
+
+bool CSIHost::Load(const char *pluginPath, const char *resourcePath)
+{
+    s_host = this;
+
+    resourcePath_ = resourcePath;
+    iniPath_ = resourcePath_ + "/reaper.ini";
+    MakeDirectories((resourcePath_ + "/CSI").c_str());
+
+    pluginModule_ = dlopen(pluginPath, RTLD_NOW | RTLD_LOCAL);
+
+    if (pluginModule_ == NULL)
+    {
+        fprintf(stderr, "Cannot load %s: %s\n", pluginPath, dlerror());
+        return false;
+    }
+
+    typedef int (*SwellDllMain)(HINSTANCE, DWORD, LPVOID);
+    SwellDllMain swellDllMain = (SwellDllMain)dlsym(pluginModule_, "SWELL_dllMain");
+
+    if (swellDllMain)
+        swellDllMain((HINSTANCE)pluginModule_, 1 /* DLL_PROCESS_ATTACH */, (LPVOID)GetSwellFunc);
+
+    typedef int (*PluginEntry)(REAPER_PLUGIN_HINSTANCE, reaper_plugin_info_t *);
+    PluginEntry entry = (PluginEntry)dlsym(pluginModule_, "ReaperPluginEntry");
+
+    if (entry == NULL)
+    {
+        fprintf(stderr, "%s has no ReaperPluginEntry\n", pluginPath);
+        return false;
+    }
+
+    pluginInfo_.caller_version = REAPER_PLUGIN_VERSION;
+    pluginInfo_.hwnd_main = NULL;
+    pluginInfo_.Register = Register;
+    pluginInfo_.GetFunc = GetFunc;
+
+    return entry((REAPER_PLUGIN_HINSTANCE)pluginModule_, &pluginInfo_) == 1 && csurfReg_ != NULL;
+}
+
+void CSIHost::Unload()
+{
+    DestroySurface();
+
+    if (pluginModule_ == NULL)
+        return;
+
+    typedef int (*PluginEntry)(REAPER_PLUGIN_HINSTANCE, reaper_plugin_info_t *);
+    PluginEntry entry = (PluginEntry)dlsym(pluginModule_, "ReaperPluginEntry");
+
+    if (entry)
+        entry((REAPER_PLUGIN_HINSTANCE)pluginModule_, NULL);
+
+    dlclose(pluginModule_);
+    pluginModule_ = NULL;
+    csurfReg_ = NULL;
+    registered_.clear();
+}
+
+bool CSIHost::CreateSurface()
+{
+    if (csurfReg_ == NULL || surface_ != NULL)
+        return false;
+
+    int errStats = 0;
+    surface_ = csurfReg_->create("CSI", "", &errStats);
+
+    return surface_ != NULL;
+}
+
+void CSIHost::DestroySurface()
+{
+    delete surface_;
+    surface_ = NULL;
+}
+
+void CSIHost::Reset()
+{
+    if (surface_)
+        surface_->Extended(CSURF_EXT_RESET, NULL, NULL, NULL);
+}
+
+void CSIHost::Tick(int count)
+{
+    for (int i = 0; i < count && surface_ != NULL; ++i)
+    {
+        if ( ! isRealTime_)
+            simulatedTime_ += tickInterval_;
+
+        surface_->Run();
+    }
+}
+
+void *CSIHost::GetRegistered(const char *name)
+{
+    map<string, void *>::iterator it = registered_.find(name);
+    return it == registered_.end() ? NULL : it->second;
+}
+
+bool CSIHost::SetTimingDisplay(bool isTimingDisplayed)
+{
+    typedef void (*SetTimingDisplayFunc)(bool);
+    SetTimingDisplayFunc setTimingDisplay = (SetTimingDisplayFunc)GetRegistered("API_CSI_SetTimingDisplay");
+
+    if (setTimingDisplay == NULL)
+        return false;
+
+    setTimingDisplay(isTimingDisplayed);
+    return true;
+}
+
+bool CSIHost::SetThinTouchedFXWrites(bool isThinned)
+{
+    typedef void (*SetThinTouchedFXWritesFunc)(bool);
+    SetThinTouchedFXWritesFunc setThinTouchedFXWrites = (SetThinTouchedFXWritesFunc)GetRegistered("API_CSI_SetThinTouchedFXWrites");
+
+    if (setThinTouchedFXWrites == NULL)
+        return false;
+
+    setThinTouchedFXWrites(isThinned);
+    return true;
+}
+
+double CSIHost::GetTime()
+{
+    return isRealTime_ ? MonotonicTime() - realTimeBase_ : simulatedTime_;
+}
+
+bool CSIHost::WriteFile(const char *relativePath, const string &contents)
+{
+    string path = resourcePath_ + "/" + relativePath;
+
+    size_t slash = path.rfind('/');
+    if (slash != string::npos)
+        MakeDirectories(path.substr(0, slash).c_str());
+
+    FILE *file = fopen(path.c_str(), "wb");
+
+    if (file == NULL)
+        return false;
+
+    bool isWritten = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    fclose(file);
+    return isWritten;
+}
+
+StubTrack *CSIHost::AddTrack(const char *name)
+{
+    tracks_.push_back(new StubTrack(name ? name : ""));
+    trackIds_[tracks_.back()] = (int)tracks_.size();
+    return tracks_.back();
+}
+
+void CSIHost::RemoveTrack(int index)
+{
+    if (index < 0 || index >= (int)tracks_.size())
+        return;
+
+    StubTrack *track = tracks_[index];
+    tracks_.erase(tracks_.begin() + index);
+
+    for (int i = 0; i < (int)tracks_.size(); ++i)
+        for (int j = (int)tracks_[i]->sends.size() - 1; j >= 0; --j)
+            if (tracks_[i]->sends[j].destination == track)
+                tracks_[i]->sends.erase(tracks_[i]->sends.begin() + j);
+
+    delete track;
+    IndexTracks();
+}
+
+void CSIHost::ClearTracks()
+{
+    for (int i = 0; i < (int)tracks_.size(); ++i)
+        delete tracks_[i];
+
+    tracks_.clear();
+    trackIds_.clear();
+}
+
+void CSIHost::IndexTracks()
+{
+    trackIds_.clear();
+
+    for (int i = 0; i < (int)tracks_.size(); ++i)
+        trackIds_[tracks_[i]] = i + 1;
+}
+
+StubTrack *CSIHost::GetTrackFromId(int id)
+{
+    if (id == 0)
+        return master_;
+
+    return GetTrack(id - 1);
+}
+
+int CSIHost::GetIdFromTrack(StubTrack *track)
+{
+    if (track == NULL)
+        return -1;
+
+    if (track == master_)
+        return 0;
+
+    map<const void *, int>::iterator it = trackIds_.find(track);
+    return it == trackIds_.end() ? -1 : it->second;
+}
+
+bool CSIHost::IsValidTrack(const void *track)
+{
+    if (track == NULL)
+        return false;
+
+    return track == master_ || trackIds_.find(track) != trackIds_.end();
+}
+
+void CSIHost::SelectOnly(StubTrack *track)
+{
+    master_->selected = track == master_;
+
+    for (int i = 0; i < (int)tracks_.size(); ++i)
+        tracks_[i]->selected = tracks_[i] == track;
+}
+
+int CSIHost::CountSelectedTracks()
+{
+    int count = 0;
+
+    for (int i = 0; i < (int)tracks_.size(); ++i)
+        if (tracks_[i]->selected)
+            count++;
+
+    return count;
+}
+
+StubTrack *CSIHost::GetSelectedTrack(int index)
+{
+    for (int i = 0; i < (int)tracks_.size(); ++i)
+        if (tracks_[i]->selected && index-- == 0)
+            return tracks_[i];
+
+    return NULL;
+}
+
+void CSIHost::NotifyTrackListChange()
+{
+    if (surface_)
+        surface_->SetTrackListChange();
+}
+
+void CSIHost::NotifyTrackSelection(StubTrack *track)
+{
+    if (surface_)
+        surface_->OnTrackSelection((MediaTrack *)track);
+}
+
+void CSIHost::NotifyFXChange(StubTrack *track)
+{
+    if (surface_)
+        surface_->Extended(CSURF_EXT_SETFXCHANGE, track, NULL, NULL);
+}
+
+bool CSIHost::GetLastTouchedFX(int *trackId, int *fxIndex, int *paramIndex)
+{
+    if (lastTouchedTrack_ < 0)
+        return false;
+
+    if (trackId) *trackId = lastTouchedTrack_;
+    if (fxIndex) *fxIndex = lastTouchedFX_;
+    if (paramIndex) *paramIndex = lastTouchedParam_;
+    return true;
+}
+
+bool CSIHost::GetFocusedFX(int *trackId, int *fxIndex)
+{
+    if (focusedTrack_ < 0)
+        return false;
+
+    if (trackId) *trackId = focusedTrack_;
+    if (fxIndex) *fxIndex = focusedFX_;
+    return true;
+}
+
+int CSIHost::GetToggleState(int commandId)
+{
+    map<int, int>::iterator it = toggleStates_.find(commandId);
+    return it == toggleStates_.end() ? -1 : it->second;
+}
+
+void CSIHost::RunCommand(int commandId)
+{
+    commandsRun_.push_back(commandId);
+
+    typedef void (*PostCommandHook)(int command, int flag);
+    if (PostCommandHook hook = (PostCommandHook)GetRegistered("hookpostcommand"))
+        hook(commandId, 0);
+}
+
+int CSIHost::LookupNamedCommand(const char *name)
+{
+    if (name == NULL)
+        return 0;
+
+    map<string, int>::iterator it = namedCommands_.find(name);
+
+    if (it != namedCommands_.end())
+        return it->second;
+
+    if (name[0] == '_')
+    {
+        int commandId = 50000 + (int)namedCommands_.size();
+        namedCommands_[name] = commandId;
+        return commandId;
+    }
+
+    return atoi(name);
+}
+
+const char *CSIHost::GetExtState(const char *section, const char *key)
+{
+    map<string, string>::iterator it = extState_.find(string(section ? section : "") + "/" + (key ? key : ""));
+    return it == extState_.end() ? "" : it->second.c_str();
+}
+
+void CSIHost::SetExtState(const char *section, const char *key, const char *value)
+{
+    extState_[string(section ? section : "") + "/" + (key ? key : "")] = value ? value : "";
+}
+
+int CSIHost::AddMidiPort(const char *name)
+{
+    midiPortNames_.push_back(name ? name : "");
+    return (int)midiPortNames_.size() - 1;
+}
+
+midi_Input *CSIHost::CreateMidiInput(int port)
+{
+    if (port < 0 || port >= (int)midiPortNames_.size())
+        return NULL;
+
+    VirtualMidiInput *input = new VirtualMidiInput(port);
+    midiInputs_.push_back(input);
+    return input;
+}
+
+midi_Output *CSIHost::CreateMidiOutput(int port)
+{
+    if (port < 0 || port >= (int)midiPortNames_.size())
+        return NULL;
+
+    VirtualMidiOutput *output = new VirtualMidiOutput(port);
+    midiOutputs_.push_back(output);
+    return output;
+}
+
+void CSIHost::ForgetMidiDevice(void *device)
+{
+    for (int i = (int)midiInputs_.size() - 1; i >= 0; --i)
+        if ((void *)midiInputs_[i] == device)
+            midiInputs_.erase(midiInputs_.begin() + i);
+
+    for (int i = (int)midiOutputs_.size() - 1; i >= 0; --i)
+        if ((void *)midiOutputs_[i] == device)
+            midiOutputs_.erase(midiOutputs_.begin() + i);
+}
+
+bool CSIHost::SendMidi(int port, const unsigned char *bytes, int size)
+{
+    bool isDelivered = false;
+
+    for (int i = 0; i < (int)midiInputs_.size(); ++i)
+        if (midiInputs_[i]->GetPort() == port)
+        {
+            midiInputs_[i]->Queue(bytes, size);
+            isDelivered = true;
+        }
+
+    return isDelivered;
+}
+
+bool CSIHost::SendMidi(int port, unsigned char status, unsigned char d1, unsigned char d2)
+{
+    unsigned char bytes[3] = { status, d1, d2 };
+    return SendMidi(port, bytes, 3);
+}
+
+void CSIHost::ReceiveMidi(int port, const unsigned char *bytes, int size)
+{
+    HostMidiMessage message;
+    message.time = GetTime();
+    message.bytes.assign(bytes, bytes + size);
+    midiReceived_[port].push_back(message);
+}
+
+void CSIHost::AppendConsole(const char *text)
+{
+    if (text == NULL)
+        return;
+
+    console_ += text;
+
+    if (isConsoleEchoed_)
+        fputs(text, stdout);
+}
+
+int CSIHost::RegisterCall(const char *name)
+{
+    s_callNames.push_back(name);
+    s_callCounts.push_back(0);
+    return (int)s_callNames.size() - 1;
+}
+
+void CSIHost::CountCall(int index)
+{
+    s_callCounts[index]++;
+}
+
+void CSIHost::ResetCallCounts()
+{
+    for (int i = 0; i < (int)s_callCounts.size(); ++i)
+        s_callCounts[i] = 0;
+}
+
+static bool IsMoreFrequent(const pair<string, long long> &a, const pair<string, long long> &b)
+{
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+}
+
+void CSIHost::GetCallCounts(vector<pair<string, long long> > &counts)
+{
+    counts.clear();
+
+    for (int i = 0; i < (int)s_callNames.size(); ++i)
+        if (s_callCounts[i] > 0)
+            counts.push_back(make_pair(s_callNames[i], s_callCounts[i]));
+
+    sort(counts.begin(), counts.end(), IsMoreFrequent);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OSCLoopback
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+OSCLoopback::OSCLoopback(int surfaceReceivePort, int surfaceTransmitPort)
+{
+    oscpkt::UdpSocket *inSocket = new oscpkt::UdpSocket();
+    inSocket->bindTo(surfaceTransmitPort);
+    inSocket_ = inSocket;
+
+    oscpkt::UdpSocket *outSocket = new oscpkt::UdpSocket();
+    outSocket->connectTo("127.0.0.1", surfaceReceivePort);
+    outSocket_ = outSocket;
+}
+
+OSCLoopback::~OSCLoopback()
+{
+    delete (oscpkt::UdpSocket *)inSocket_;
+    delete (oscpkt::UdpSocket *)outSocket_;
+}
+
+bool OSCLoopback::IsOk()
+{
+    return ((oscpkt::UdpSocket *)inSocket_)->isOk() && ((oscpkt::UdpSocket *)outSocket_)->isOk();
+}
+
+bool OSCLoopback::Send(const char *address, float value)
+{
+    oscpkt::Message message(address);
+    message.pushFloat(value);
+
+    oscpkt::PacketWriter writer;
+    writer.addMessage(message);
+
+    return SendPacket(writer.packetData(), writer.packetSize());
+}
+
+bool OSCLoopback::SendPacket(const void *data, int size)
+{
+    return ((oscpkt::UdpSocket *)outSocket_)->sendPacket(data, size);
+}
+
+bool OSCLoopback::Receive(string &address, float &value, int timeoutMs)
+{
+    oscpkt::UdpSocket *socket = (oscpkt::UdpSocket *)inSocket_;
+
+    if ( ! socket->receiveNextPacket(timeoutMs))
+        return false;
+
+    oscpkt::PacketReader reader(socket->packetData(), socket->packetSize());
+    oscpkt::Message *message = reader.popMessage();
+
+    if (message == NULL)
+        return false;
+
+    address = message->addressPattern();
+    value = 0.0f;
+
+    oscpkt::Message::ArgReader args = message->arg();
+
+    if (args.isFloat())
+        args.popFloat(value);
+    else if (args.isInt32())
+    {
+        int intValue = 0;
+        args.popInt32(intValue);
+        value = (float)intValue;
+    }
+
+    return true;
+}
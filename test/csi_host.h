@@ -0,0 +1,319 @@
+//
+//  csi_host.h
+//  reaper_csurf_integrator test harness
+//
+//  A headless stand-in for REAPER.  It loads the built plug-in the same way REAPER does (SWELL_dllMain, then the
+//  plug-in entry point), answers every REAPER API call the integrator makes from an in-memory session model, provides
+//  virtual MIDI ports, and drives the control surface's Run() on a simulated clock.
+//
+
+#ifndef csi_host_h
+#define csi_host_h
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "../reaper_csurf_integrator/reaper_plugin.h"
+
+using namespace std;
+
+class StubTrack;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct StubFXParam
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string name;
+    double value;
+    double minValue;
+    double maxValue;
+
+    StubFXParam(const string &paramName) : name(paramName), value(0.0), minValue(0.0), maxValue(1.0) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct StubFX
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string name;
+    bool isEnabled;
+    bool isOffline;
+    bool isOpen;
+    vector<StubFXParam> params;
+
+    StubFX(const string &fxName) : name(fxName), isEnabled(true), isOffline(false), isOpen(false) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct StubSend
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    StubTrack *source;
+    StubTrack *destination;
+    double volume;
+    double pan;
+    bool isMuted;
+
+    StubSend(StubTrack *src, StubTrack *dest) : source(src), destination(dest), volume(1.0), pan(0.0), isMuted(false) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class StubTrack
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    string name;
+    int color;              // native color, 0 = default
+    double volume;          // linear gain, 1.0 = 0dB
+    double pan;
+    double width;
+    double dualPanL;
+    double dualPanR;
+    int panMode;
+    bool isMuted;
+    int solo;
+    int recArm;
+    int recInput;
+    int recMonitor;
+    int recMonitorItems;
+    int autoMode;
+    bool isPhaseInverted;
+    bool isMono;
+    int selected;
+    int fxEnabled;
+    bool isVisibleInTCP;
+    bool isVisibleInMCP;
+    int folderDepth;        // I_FOLDERDEPTH: 1 opens a folder, -n closes n levels
+    unsigned int vcaLeadMask;
+    unsigned int vcaFollowMask;
+    double peaks[2];
+    vector<StubFX> fx;
+    vector<StubSend> sends;
+
+    StubTrack(const string &trackName) : name(trackName)
+    {
+        color = 0;
+        volume = 1.0;
+        pan = 0.0;
+        width = 1.0;
+        dualPanL = -1.0;
+        dualPanR = 1.0;
+        panMode = 3;
+        isMuted = false;
+        solo = 0;
+        recArm = 0;
+        recInput = 0;
+        recMonitor = 0;
+        recMonitorItems = 0;
+        autoMode = 0;
+        isPhaseInverted = false;
+        isMono = false;
+        selected = 0;
+        fxEnabled = 1;
+        isVisibleInTCP = true;
+        isVisibleInMCP = true;
+        folderDepth = 0;
+        vcaLeadMask = 0;
+        vcaFollowMask = 0;
+        peaks[0] = 0.0;
+        peaks[1] = 0.0;
+    }
+
+    StubFX &AddFX(const char *fxName, int numParams);
+    StubSend &AddSend(StubTrack *destination);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct HostMidiMessage
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double time;
+    vector<unsigned char> bytes;
+};
+
+class VirtualMidiInput;
+class VirtualMidiOutput;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct AllocationStats
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    long long allocations;
+    long long frees;
+    long long liveBytes;
+};
+
+// Counts every malloc/calloc/realloc/free in the process, including those made inside the plug-in (see csi_alloc.cpp)
+AllocationStats GetAllocationStats();
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class CSIHost
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    static CSIHost *s_host;
+
+    void *pluginModule_;
+    reaper_plugin_info_t pluginInfo_;
+    reaper_csurf_reg_t *csurfReg_;
+    IReaperControlSurface *surface_;
+    map<string, void *> registered_;
+
+    string resourcePath_;
+    string iniPath_;
+
+    bool isRealTime_;
+    double simulatedTime_;
+    double realTimeBase_;
+    double tickInterval_;
+
+    StubTrack *master_;
+    vector<StubTrack *> tracks_;
+    map<const void *, int> trackIds_; // id by pointer, so validating a track does not scan thousands of them
+
+    int playState_;
+    double playPosition_;
+    double cursorPosition_;
+    double projectLength_;
+    int repeat_;
+    int automationOverride_;
+
+    int lastTouchedTrack_;  // 0 = master, 1..N tracks, -1 = none
+    int lastTouchedFX_;
+    int lastTouchedParam_;
+    int focusedTrack_;      // 0 = master, 1..N tracks, -1 = none
+    int focusedFX_;
+
+    map<int, int> toggleStates_;
+    map<string, int> namedCommands_;
+    vector<int> commandsRun_;
+    map<string, string> extState_;
+
+    vector<string> midiPortNames_;
+    vector<VirtualMidiInput *> midiInputs_;
+    vector<VirtualMidiOutput *> midiOutputs_;
+    map<int, vector<HostMidiMessage> > midiReceived_;
+
+    string console_;
+    bool isConsoleEchoed_;
+
+    void IndexTracks();
+
+    static int Register(const char *name, void *infostruct);
+    static void *GetFunc(const char *name);
+    static void *GetSwellFunc(const char *name);
+
+public:
+    CSIHost();
+    ~CSIHost();
+
+    static CSIHost *Get() { return s_host; }
+
+    // Plug-in lifetime
+    bool Load(const char *pluginPath, const char *resourcePath);
+    void Unload();
+    bool CreateSurface();
+    void DestroySurface();
+    void Reset();                           // CSURF_EXT_RESET, which is what runs CSurfIntegrator::Init
+    void Tick(int count = 1);               // advance the clock by one tick and call Run()
+    IReaperControlSurface *GetSurface() { return surface_; }
+    void *GetRegistered(const char *name);  // API_xxx functions and other things the plug-in registered
+    bool SetTimingDisplay(bool isTimingDisplayed); // "Show timing", through the plug-in's API_CSI_SetTimingDisplay
+    bool SetThinTouchedFXWrites(bool isThinned);   // "Thin FX param writes while touched", through API_CSI_SetThinTouchedFXWrites
+
+    // Clock
+    void SetRealTime(bool isRealTime) { isRealTime_ = isRealTime; }
+    void SetTickInterval(double seconds) { tickInterval_ = seconds; }
+    double GetTime();
+    void AdvanceTime(double seconds) { simulatedTime_ += seconds; }
+
+    // Files -- everything lives under the resource path handed to Load()
+    const string &GetResourcePath() { return resourcePath_; }
+    const char *GetIniPath() { return iniPath_.c_str(); }
+    bool WriteFile(const char *relativePath, const string &contents);
+
+    // Session model
+    StubTrack *GetMasterTrack() { return master_; }
+    StubTrack *AddTrack(const char *name);
+    void RemoveTrack(int index);
+    void ClearTracks();
+    int GetNumTracks() { return (int)tracks_.size(); }
+    StubTrack *GetTrack(int index) { return index >= 0 && index < (int)tracks_.size() ? tracks_[index] : NULL; }
+    StubTrack *GetTrackFromId(int id); // 0 = master, 1..N tracks
+    int GetIdFromTrack(StubTrack *track);
+    bool IsValidTrack(const void *track);
+    void SelectOnly(StubTrack *track);
+    int CountSelectedTracks();
+    StubTrack *GetSelectedTrack(int index);
+    void NotifyTrackListChange();           // what REAPER calls after tracks are added, removed or reordered
+    void NotifyTrackSelection(StubTrack *track);
+    void NotifyFXChange(StubTrack *track);
+
+    void SetPlayState(int playState) { playState_ = playState; }
+    int GetPlayState() { return playState_; }
+    double &PlayPosition() { return playPosition_; }
+    double &CursorPosition() { return cursorPosition_; }
+    double GetProjectLength() { return projectLength_; }
+    int &Repeat() { return repeat_; }
+    int &AutomationOverride() { return automationOverride_; }
+
+    void SetLastTouchedFX(int trackId, int fxIndex, int paramIndex) { lastTouchedTrack_ = trackId; lastTouchedFX_ = fxIndex; lastTouchedParam_ = paramIndex; }
+    bool GetLastTouchedFX(int *trackId, int *fxIndex, int *paramIndex);
+    void SetFocusedFX(int trackId, int fxIndex) { focusedTrack_ = trackId; focusedFX_ = fxIndex; }
+    bool GetFocusedFX(int *trackId, int *fxIndex);
+
+    void SetToggleState(int commandId, int state) { toggleStates_[commandId] = state; }
+    int GetToggleState(int commandId);
+    int LookupNamedCommand(const char *name);
+    void RunCommand(int commandId);         // a main-section action, followed by hookpostcommand as REAPER does
+    const vector<int> &GetCommandsRun() { return commandsRun_; }
+
+    const char *GetExtState(const char *section, const char *key);
+    void SetExtState(const char *section, const char *key, const char *value);
+
+    // Virtual MIDI ports -- port n is both input n and output n
+    int AddMidiPort(const char *name);
+    int GetNumMidiPorts() { return (int)midiPortNames_.size(); }
+    const char *GetMidiPortName(int port) { return port >= 0 && port < (int)midiPortNames_.size() ? midiPortNames_[port].c_str() : NULL; }
+    midi_Input *CreateMidiInput(int port);
+    midi_Output *CreateMidiOutput(int port);
+    void ForgetMidiDevice(void *device);
+    bool SendMidi(int port, const unsigned char *bytes, int size);          // device -> CSI, delivered on the next Run()
+    bool SendMidi(int port, unsigned char status, unsigned char d1, unsigned char d2);
+    void ReceiveMidi(int port, const unsigned char *bytes, int size);
+    const vector<HostMidiMessage> &GetMidiReceived(int port) { return midiReceived_[port]; } // CSI -> device
+    void ClearMidiReceived() { midiReceived_.clear(); }
+
+    // Console and API accounting
+    void AppendConsole(const char *text);
+    void SetConsoleEchoed(bool isEchoed) { isConsoleEchoed_ = isEchoed; }
+    const string &GetConsole() { return console_; }
+    void ClearConsole() { console_.clear(); }
+
+    static int RegisterCall(const char *name);
+    static void CountCall(int index);
+    static void ResetCallCounts();
+    static void GetCallCounts(vector<pair<string, long long> > &counts); // non-zero only, most frequent first
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class OSCLoopback
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    void *inSocket_;
+    void *outSocket_;
+
+public:
+    // listens where the surface transmits, and sends to where the surface listens
+    OSCLoopback(int surfaceReceivePort, int surfaceTransmitPort);
+    ~OSCLoopback();
+
+    bool IsOk();
+    bool Send(const char *address, float value);
+    bool SendPacket(const void *data, int size);
+    bool Receive(string &address, float &value, int timeoutMs);
+};
+
+#endif /* csi_host_h */
@@ -0,0 +1,937 @@
+//
+//  csi_test.cpp
+//  reaper_csurf_integrator test harness
+//
+//  Regression tests that drive the built plug-in through CSIHost: surface input in, REAPER state and surface feedback
+//  out.  Run with "make test", or "./csi_test [path to plug-in] [test name]".
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "csi_host.h"
+
+static int s_failures = 0;
+
+#define CHECK(condition) do { if ( ! (condition)) { printf("    FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); s_failures++; } } while (0)
+#define CHECK_NEAR(a, b, tolerance) do { double a_ = (a), b_ = (b); if (fabs(a_ - b_) > (tolerance)) { printf("    FAILED %s:%d: %s == %g, expected %g\n", __FILE__, __LINE__, #a, a_, b_); s_failures++; } } while (0)
+
+static const int s_midiPort = 0;
+static const int s_oscReceivePort = 9820;
+static const int s_oscTransmitPort = 9821;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixtures
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const char *s_midiSurface =
+    "Widget Fader1\n"
+    "    Fader14Bit e0 7f 7f\n"
+    "    FB_Fader14Bit e0 7f 7f\n"
+    "WidgetEnd\n"
+    "Widget Fader2\n"
+    "    Fader14Bit e1 7f 7f\n"
+    "    FB_Fader14Bit e1 7f 7f\n"
+    "WidgetEnd\n"
+    "Widget Mute1\n"
+    "    Press 90 10 7f\n"
+    "    FB_TwoState 90 10 7f 90 10 00\n"
+    "WidgetEnd\n"
+    "Widget Mute2\n"
+    "    Press 90 11 7f\n"
+    "    FB_TwoState 90 11 7f 90 11 00\n"
+    "WidgetEnd\n"
+    "Widget Rotary1\n"
+    "    Encoder b0 10 7f\n"
+    "    Touch 90 20 7f 90 20 00\n"
+    "WidgetEnd\n"
+    "Widget Play\n"
+    "    Press 90 5e 7f\n"
+    "WidgetEnd\n"
+    "Widget SysExButton\n"
+    "    AnyPress f0 00 66\n"
+    "WidgetEnd\n";
+
+static const char *s_oscSurface =
+    "Widget Fader1\n"
+    "    Control /track/1/volume\n"
+    "    FB_Processor /track/1/volume\n"
+    "WidgetEnd\n"
+    "Widget Fader2\n"
+    "    Control /track/2/volume\n"
+    "    FB_Processor /track/2/volume\n"
+    "WidgetEnd\n";
+
+static const char *s_homeZone =
+    "Zone Home\n"
+    "    IncludedZones\n"
+    "        Track\n"
+    "    IncludedZonesEnd\n"
+    "    Rotary1 FocusedFXParam\n"
+    "    Play Reaper 40044\n"
+    "    SysExButton Reaper 40045\n"
+    "ZoneEnd\n";
+
+static const char *s_trackZone =
+    "Zone Track\n"
+    "    Fader| TrackVolume\n"
+    "    Mute| TrackMute\n"
+    "ZoneEnd\n";
+
+static void WriteSurface(CSIHost &host, const char *folder, const char *surface)
+{
+    host.WriteFile((string("CSI/Surfaces/") + folder + "/Surface.txt").c_str(), surface);
+    host.WriteFile((string("CSI/Surfaces/") + folder + "/Zones/Home.zon").c_str(), s_homeZone);
+    host.WriteFile((string("CSI/Surfaces/") + folder + "/Zones/Track.zon").c_str(), s_trackZone);
+    host.WriteFile((string("CSI/Surfaces/") + folder + "/FXZones/README.txt").c_str(), "");
+}
+
+static void StartSession(CSIHost &host, const string &ini)
+{
+    host.ClearTracks();
+
+    StubTrack *track = host.AddTrack("Vox");
+    track->AddFX("VST: ReaEQ (Cockos)", 4).params[0].value = 0.5;
+    host.AddTrack("Gtr");
+    host.SelectOnly(host.GetTrack(0));
+
+    host.SetLastTouchedFX(0, 0, 0);
+    host.ClearMidiReceived();
+    host.ClearConsole();
+
+    host.WriteFile("CSI/CSI.ini", "Version=7.0\n\n" + ini);
+    host.Reset();
+    host.NotifyTrackListChange();
+    host.Tick(3);
+    host.ClearMidiReceived();
+}
+
+static void StartMidiSession(CSIHost &host)
+{
+    WriteSurface(host, "Test", s_midiSurface);
+
+    StartSession(host,
+        "SurfaceType=MIDI SurfaceName=Test SurfaceChannelCount=2 MidiInput=0 MidiOutput=0 MIDISurfaceRefreshRate=15 MaxMIDIMesssagesPerRun=32\n"
+        "\n"
+        "PageName=Home PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n"
+        "    Surface=Test Zones=Test StartChannel=0\n");
+}
+
+// Latest message CSI sent to the virtual device that starts with status and data1
+static const HostMidiMessage *LastSent(CSIHost &host, unsigned char status, int data1 = -1)
+{
+    const vector<HostMidiMessage> &sent = host.GetMidiReceived(s_midiPort);
+
+    for (int i = (int)sent.size() - 1; i >= 0; --i)
+        if (sent[i].bytes.size() >= 3 && sent[i].bytes[0] == status && (data1 < 0 || sent[i].bytes[1] == data1))
+            return &sent[i];
+
+    return NULL;
+}
+
+// Value byte of that message, -1 if none was sent
+static int LastValue(CSIHost &host, unsigned char status, int data1)
+{
+    const HostMidiMessage *message = LastSent(host, status, data1);
+    return message ? message->bytes[2] : -1;
+}
+
+static int Value14Bit(const HostMidiMessage *message)
+{
+    return message ? (message->bytes[2] << 7) | message->bytes[1] : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void TestFaderSetsTrackVolume(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    host.SendMidi(s_midiPort, 0xe0, 0x00, 0x40);
+    host.Tick();
+
+    double halfVolume = host.GetTrack(0)->volume;
+    CHECK(halfVolume != 1.0);
+    CHECK(host.GetTrack(1)->volume == 1.0);
+
+    host.SendMidi(s_midiPort, 0xe0, 0x7f, 0x7f);
+    host.Tick();
+
+    CHECK(host.GetTrack(0)->volume > halfVolume);
+    CHECK(host.GetTrack(1)->volume == 1.0);
+
+    host.SendMidi(s_midiPort, 0xe1, 0x00, 0x00);
+    host.Tick();
+
+    CHECK(host.GetTrack(1)->volume < 0.001);
+}
+
+static void TestVolumeFeedback(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    host.GetTrack(0)->volume = 0.25;
+    host.Tick(3);
+
+    int lowValue = Value14Bit(LastSent(host, 0xe0));
+    CHECK(lowValue > 0);
+
+    host.GetTrack(0)->volume = 1.0;
+    host.Tick(3);
+
+    int unityValue = Value14Bit(LastSent(host, 0xe0));
+    CHECK(unityValue > lowValue);
+    CHECK(LastSent(host, 0xe1) == NULL); // track 2 did not change
+}
+
+static void TestMutePressAndFeedback(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    host.SendMidi(s_midiPort, 0x90, 0x10, 0x7f);
+    host.Tick(3);
+
+    CHECK(host.GetTrack(0)->isMuted);
+    CHECK( ! host.GetTrack(1)->isMuted);
+
+    const HostMidiMessage *feedback = LastSent(host, 0x90, 0x10);
+    CHECK(feedback != NULL && feedback->bytes[2] == 0x7f);
+
+    host.SendMidi(s_midiPort, 0x90, 0x10, 0x7f);
+    host.Tick(3);
+
+    CHECK( ! host.GetTrack(0)->isMuted);
+
+    feedback = LastSent(host, 0x90, 0x10);
+    CHECK(feedback != NULL && feedback->bytes[2] == 0x00);
+}
+
+// Several relative messages inside one Run() must each move the parameter, not all start from the same stale value
+static void TestEncoderIncrementsAccumulate(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    StubFXParam &param = host.GetTrack(0)->fx[0].params[0];
+    param.value = 0.5;
+    host.SetLastTouchedFX(1, 0, 0);
+
+    host.SendMidi(s_midiPort, 0xb0, 0x10, 0x01);
+    host.Tick();
+
+    double singleStep = param.value - 0.5;
+    CHECK(singleStep > 0.0);
+
+    param.value = 0.5;
+    host.Tick();
+
+    for (int i = 0; i < 5; ++i)
+        host.SendMidi(s_midiPort, 0xb0, 0x10, 0x01);
+    host.Tick();
+
+    CHECK_NEAR(param.value - 0.5, 5 * singleStep, 1e-9);
+
+    for (int i = 0; i < 5; ++i)
+        host.SendMidi(s_midiPort, 0xb0, 0x10, 0x41);
+    host.Tick();
+
+    CHECK_NEAR(param.value, 0.5, 1e-9);
+}
+
+// With "Thin FX param writes while touched" on, a touched parameter gets the first move at once, then at most one write
+// per 100 ms, and whatever is still queued on release
+static void TestTouchedFXParamWritesThinned(CSIHost &host)
+{
+    CHECK(host.SetThinTouchedFXWrites(true));
+    StartMidiSession(host);
+
+    StubFXParam &param = host.GetTrack(0)->fx[0].params[0];
+    param.value = 0.5;
+    host.SetLastTouchedFX(1, 0, 0);
+
+    host.SendMidi(s_midiPort, 0x90, 0x20, 0x7f);
+    host.Tick();
+
+    host.SendMidi(s_midiPort, 0xb0, 0x10, 0x01);
+    host.Tick();
+
+    double singleStep = param.value - 0.5;
+    CHECK(singleStep > 0.0);
+
+    host.SendMidi(s_midiPort, 0xb0, 0x10, 0x01);
+    host.Tick();
+
+    CHECK_NEAR(param.value, 0.5 + singleStep, 1e-9);
+
+    host.AdvanceTime(0.1);
+    host.Tick();
+
+    CHECK_NEAR(param.value, 0.5 + 2 * singleStep, 1e-9);
+
+    host.SendMidi(s_midiPort, 0xb0, 0x10, 0x01);
+    host.Tick();
+
+    CHECK_NEAR(param.value, 0.5 + 2 * singleStep, 1e-9);
+
+    host.SendMidi(s_midiPort, 0x90, 0x20, 0x00);
+    host.Tick();
+
+    CHECK_NEAR(param.value, 0.5 + 3 * singleStep, 1e-9);
+
+    host.SetThinTouchedFXWrites(false);
+}
+
+static void TestReaperAction(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    size_t commandCount = host.GetCommandsRun().size();
+
+    host.SendMidi(s_midiPort, 0x90, 0x5e, 0x7f);
+    host.Tick();
+
+    CHECK(host.GetCommandsRun().size() == commandCount + 1);
+    CHECK( ! host.GetCommandsRun().empty() && host.GetCommandsRun().back() == 40044);
+}
+
+static void TestInjectMidiMessage(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    typedef bool (*InjectMidiMessage)(const char *, int, int, int);
+    InjectMidiMessage inject = (InjectMidiMessage)host.GetRegistered("API_CSI_InjectMidiMessage");
+    CHECK(inject != NULL);
+
+    if (inject == NULL)
+        return;
+
+    CHECK( ! inject("NoSuchSurface", 0x90, 0x11, 0x7f));
+    CHECK(inject("Test", 0x90, 0x11, 0x7f));
+    host.Tick();
+
+    CHECK( ! host.GetTrack(0)->isMuted);
+    CHECK(host.GetTrack(1)->isMuted);
+}
+
+static void TestOSCLoopback(CSIHost &host)
+{
+    WriteSurface(host, "OSCTest", s_oscSurface);
+
+    char ini[512];
+    snprintf(ini, sizeof(ini),
+        "SurfaceType=OSC SurfaceName=OSCTest SurfaceChannelCount=2 ReceiveOnPort=%d TransmitToPort=%d TransmitToIPAddress=127.0.0.1 MaxPacketsPerRun=0\n"
+        "\n"
+        "PageName=Home PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n"
+        "    Surface=OSCTest Zones=OSCTest StartChannel=0\n", s_oscReceivePort, s_oscTransmitPort);
+
+    OSCLoopback loopback(s_oscReceivePort, s_oscTransmitPort);
+    CHECK(loopback.IsOk());
+
+    StartSession(host, ini);
+
+    string address;
+    float value = 0.0f;
+
+    while (loopback.Receive(address, value, 0))
+        ; // initial feedback
+
+    CHECK(loopback.Send("/track/2/volume", 0.0f));
+    usleep(20000);
+    host.Tick();
+
+    CHECK(host.GetTrack(1)->volume < 0.001);
+    CHECK(host.GetTrack(0)->volume == 1.0);
+
+    host.GetTrack(0)->volume = 0.5;
+    host.Tick(3);
+
+    bool isFedBack = false;
+
+    while (loopback.Receive(address, value, 100))
+        if (address == "/track/1/volume")
+        {
+            isFedBack = true;
+            CHECK(value > 0.0f && value < 1.0f);
+        }
+
+    CHECK(isFedBack);
+
+    host.WriteFile("CSI/CSI.ini", "Version=7.0\n");
+    host.Reset(); // release the ports before the loopback closes
+}
+
+static void WriteTrafficRecord(string &file, double time, char direction, const unsigned char *bytes, int size)
+{
+    file.append((const char *)&time, sizeof(double));
+    file.append(&direction, 1);
+    file.append((const char *)&size, sizeof(int));
+    file.append((const char *)bytes, size);
+}
+
+static void TestReplayTrafficFile(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    static const unsigned char mute[] = { 0x90, 0x10, 0x7f };
+    static const unsigned char ignoredOutput[] = { 0x90, 0x11, 0x7f };
+    static const unsigned char fader[] = { 0xe1, 0x00, 0x00 };
+
+    string file("CSIT");
+    int version = 1;
+    file.append((const char *)&version, sizeof(int));
+    WriteTrafficRecord(file, 0.0, 0, mute, sizeof(mute));
+    WriteTrafficRecord(file, 0.01, 1, ignoredOutput, sizeof(ignoredOutput));
+    WriteTrafficRecord(file, 0.02, 0, fader, sizeof(fader));
+    host.WriteFile("CSI/Traffic/Recorded.csitraffic", file);
+
+    typedef bool (*ReplaySurfaceTraffic)(const char *, const char *, bool);
+    ReplaySurfaceTraffic replay = (ReplaySurfaceTraffic)host.GetRegistered("API_CSI_ReplaySurfaceTraffic");
+    CHECK(replay != NULL);
+
+    if (replay == NULL)
+        return;
+
+    string path = host.GetResourcePath() + "/CSI/Traffic/Recorded.csitraffic";
+    CHECK( ! replay("Test", (path + ".missing").c_str(), false));
+    CHECK(replay("Test", path.c_str(), false));
+    host.Tick();
+
+    CHECK(host.GetTrack(0)->isMuted);
+    CHECK( ! host.GetTrack(1)->isMuted);
+    CHECK(host.GetTrack(1)->volume < 0.001);
+}
+
+// Latency runs from when the message reached the MIDI input, not from when the tick got round to it
+static void TestFeedbackLatencyFromArrival(CSIHost &host)
+{
+    CHECK(host.SetTimingDisplay(true));
+    StartMidiSession(host);
+
+    host.SendMidi(s_midiPort, 0x90, 0x10, 0x7f); // arrives a whole tick before the Run() that handles it
+    host.Tick((int)(6.0 / (1.0 / 30.0))); // past the 5 second report window
+
+    host.SetTimingDisplay(false);
+    host.Reset();
+
+    const string &console = host.GetConsole();
+    size_t report = console.find("CSI feedback latency Test Mute via ");
+    CHECK(report != string::npos);
+
+    int count = 0;
+    double minLatency = 0.0;
+
+    if (report != string::npos)
+        CHECK(sscanf(console.c_str() + console.find(':', report), ": %d inputs -- min %lf ms", &count, &minLatency) == 2);
+
+    // one tick waiting in the input buffer, then one until the feedback goes out -- stamping at processing would say 33.333
+    CHECK(count == 1);
+    CHECK_NEAR(minLatency, 66.667, 0.001);
+}
+
+// SysEx longer than the old one byte length prefix allowed must still reach the surface
+static void TestReplayLongSysEx(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    unsigned char sysEx[300];
+    memset(sysEx, 0x01, sizeof(sysEx));
+    sysEx[0] = 0xf0;
+    sysEx[1] = 0x00;
+    sysEx[2] = 0x66;
+    sysEx[sizeof(sysEx) - 1] = 0xf7;
+
+    string file("CSIT");
+    int version = 1;
+    file.append((const char *)&version, sizeof(int));
+    WriteTrafficRecord(file, 0.0, 0, sysEx, sizeof(sysEx));
+    host.WriteFile("CSI/Traffic/SysEx.csitraffic", file);
+
+    typedef bool (*ReplaySurfaceTraffic)(const char *, const char *, bool);
+    ReplaySurfaceTraffic replay = (ReplaySurfaceTraffic)host.GetRegistered("API_CSI_ReplaySurfaceTraffic");
+    CHECK(replay != NULL);
+
+    if (replay == NULL)
+        return;
+
+    size_t commandCount = host.GetCommandsRun().size();
+
+    CHECK(replay("Test", (host.GetResourcePath() + "/CSI/Traffic/SysEx.csitraffic").c_str(), false));
+    host.Tick();
+
+    CHECK(host.GetCommandsRun().size() == commandCount + 1);
+    CHECK( ! host.GetCommandsRun().empty() && host.GetCommandsRun().back() == 40045);
+}
+
+static void TestTrackListChange(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    host.RemoveTrack(0);
+    host.NotifyTrackListChange();
+    host.Tick();
+
+    host.SendMidi(s_midiPort, 0x90, 0x10, 0x7f);
+    host.Tick();
+
+    CHECK(host.GetTrack(0)->isMuted); // channel 1 now shows what used to be track 2
+}
+
+static const char *s_meterSurface =
+    "Widget MeterL1\n"
+    "    FB_Fader7Bit b0 30 7f\n"
+    "WidgetEnd\n"
+    "Widget MeterL2\n"
+    "    FB_Fader7Bit b0 31 7f\n"
+    "WidgetEnd\n"
+    "Widget MeterR1\n"
+    "    FB_Fader7Bit b0 32 7f\n"
+    "WidgetEnd\n"
+    "Widget MeterR2\n"
+    "    FB_Fader7Bit b0 33 7f\n"
+    "WidgetEnd\n"
+    "Widget MeterAverage1\n"
+    "    FB_Fader7Bit b0 34 7f\n"
+    "WidgetEnd\n"
+    "Widget MeterAverage2\n"
+    "    FB_Fader7Bit b0 35 7f\n"
+    "WidgetEnd\n";
+
+// One surface of its own, named after its folder, on the first port
+static void StartSurfaceSession(CSIHost &host, const char *name, const char *surface, const char *homeZone, const char *trackZone)
+{
+    string folder = string("CSI/Surfaces/") + name;
+
+    host.WriteFile((folder + "/Surface.txt").c_str(), surface);
+    host.WriteFile((folder + "/Zones/Home.zon").c_str(), homeZone);
+    host.WriteFile((folder + "/Zones/Track.zon").c_str(), trackZone);
+    host.WriteFile((folder + "/FXZones/README.txt").c_str(), "");
+
+    char ini[512];
+    snprintf(ini, sizeof(ini),
+        "SurfaceType=MIDI SurfaceName=%s SurfaceChannelCount=2 MidiInput=0 MidiOutput=0 MIDISurfaceRefreshRate=15 MaxMIDIMesssagesPerRun=32\n"
+        "\n"
+        "PageName=Home PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n"
+        "    Surface=%s Zones=%s StartChannel=0\n", name, name, name);
+
+    StartSession(host, ini);
+}
+
+static void StartMeterSession(CSIHost &host)
+{
+    StartSurfaceSession(host, "Meter", s_meterSurface,
+        "Zone Home\n    IncludedZones\n        Track\n    IncludedZonesEnd\nZoneEnd\n",
+        "Zone Track\n"
+        "    MeterL| TrackOutputMeter 0\n"
+        "    MeterR| TrackOutputMeter 1\n"
+        "    MeterAverage| TrackOutputMeterAverageLR\n"
+        "ZoneEnd\n");
+}
+
+static long long CallCount(const char *name)
+{
+    vector<pair<string, long long> > counts;
+    CSIHost::GetCallCounts(counts);
+
+    for (int i = 0; i < (int)counts.size(); ++i)
+        if (counts[i].first == name)
+            return counts[i].second;
+
+    return 0;
+}
+
+static void TestTrackMeterReadOncePerTick(CSIHost &host)
+{
+    StartMeterSession(host);
+
+    CSIHost::ResetCallCounts();
+    host.Tick(10);
+
+    // the surface refreshes meters every other tick -- three meters per channel, but on each of those ticks the solo
+    // state is read once and each track's peaks once
+    long long updateTicks = CallCount("AnyTrackSolo");
+
+    CHECK(updateTicks >= 4 && updateTicks <= 10);
+    CHECK(CallCount("Track_GetPeakInfo") == updateTicks * 2 * 2);
+}
+
+static void TestTrackMeterSoloGating(CSIHost &host)
+{
+    StartMeterSession(host);
+
+    for (int i = 0; i < 2; ++i)
+        host.GetTrack(i)->peaks[0] = host.GetTrack(i)->peaks[1] = 1.0;
+    host.Tick(2);
+
+    CHECK(LastSent(host, 0xb0, 0x30) != NULL && LastSent(host, 0xb0, 0x30)->bytes[2] > 0);
+    CHECK(LastSent(host, 0xb0, 0x31) != NULL && LastSent(host, 0xb0, 0x31)->bytes[2] > 0);
+
+    // soloing Gtr clears Vox's meters and leaves its own
+    host.GetTrack(1)->solo = 1;
+    host.Tick(2);
+
+    CHECK(LastSent(host, 0xb0, 0x30) != NULL && LastSent(host, 0xb0, 0x30)->bytes[2] == 0);
+    CHECK(LastSent(host, 0xb0, 0x34) != NULL && LastSent(host, 0xb0, 0x34)->bytes[2] == 0);
+    CHECK(LastSent(host, 0xb0, 0x31) != NULL && LastSent(host, 0xb0, 0x31)->bytes[2] > 0);
+
+    host.GetTrack(1)->solo = 0;
+    host.Tick(2);
+
+    CHECK(LastSent(host, 0xb0, 0x30) != NULL && LastSent(host, 0xb0, 0x30)->bytes[2] > 0);
+}
+
+static void TestFXParamValueFormattedOnChange(CSIHost &host)
+{
+    StartSurfaceSession(host, "Display",
+        "Widget ParamValue\n"
+        "    FB_MCUDisplayUpper 0\n"
+        "WidgetEnd\n",
+        "Zone Home\n    ParamValue FocusedFXParamValueDisplay\nZoneEnd\n",
+        "Zone Track\nZoneEnd\n");
+
+    StubFXParam &param = host.GetTrack(0)->fx[0].params[0];
+
+    // the display is refreshed every other tick -- an unchanged value is not formatted again
+    CSIHost::ResetCallCounts();
+    host.Tick(10);
+
+    CHECK(CallCount("TrackFX_GetFormattedParamValue") == 0);
+
+    // once it moves, it is
+    param.value = 0.7;
+    CSIHost::ResetCallCounts();
+    host.Tick(2);
+
+    CHECK(CallCount("TrackFX_GetFormattedParamValue") == 1);
+
+    CSIHost::ResetCallCounts();
+    host.Tick(10);
+
+    CHECK(CallCount("TrackFX_GetFormattedParamValue") == 0);
+
+    // and an unchanged one is refreshed each second, for plugins whose text changes by itself
+    host.AdvanceTime(1.0);
+    CSIHost::ResetCallCounts();
+    host.Tick(2);
+
+    CHECK(CallCount("TrackFX_GetFormattedParamValue") == 1);
+}
+
+static void TestToggleStateRefresh(CSIHost &host)
+{
+    host.SetToggleState(41000, 0);
+
+    StartSurfaceSession(host, "Toggle",
+        "Widget Toggle\n"
+        "    Press 90 40 7f\n"
+        "    FB_TwoState 90 40 7f 90 40 00\n"
+        "WidgetEnd\n"
+        "Widget Other\n"
+        "    Press 90 41 7f\n"
+        "WidgetEnd\n",
+        "Zone Home\n    Toggle Reaper 41000\n    Other Reaper 41001\nZoneEnd\n",
+        "Zone Track\nZoneEnd\n");
+
+    // between refreshes the state is not asked for again, so a change made outside an action is not seen yet
+    host.SetToggleState(41000, 1);
+    CSIHost::ResetCallCounts();
+    host.Tick(2);
+
+    CHECK(CallCount("GetToggleCommandState") == 0);
+    CHECK(LastValue(host, 0x90, 0x40) <= 0);
+
+    // any main-section action refreshes it
+    host.SendMidi(s_midiPort, 0x90, 0x41, 0x7f);
+    host.Tick(3);
+
+    CHECK( ! host.GetCommandsRun().empty() && host.GetCommandsRun().back() == 41001);
+    CHECK(LastValue(host, 0x90, 0x40) == 0x7f);
+
+    // and so does the 250 ms poll
+    host.SetToggleState(41000, 0);
+    host.Tick(2);
+
+    CHECK(LastValue(host, 0x90, 0x40) == 0x7f);
+
+    host.AdvanceTime(0.25);
+    host.Tick(2);
+
+    CHECK(LastValue(host, 0x90, 0x40) == 0);
+}
+
+// Broadcaster A with Listeners B and C, and B relaying to its own Listener D -- each surface on its own port
+static const char *s_broadcastSurface =
+    "Widget Play\n"
+    "    Press 90 5e 7f\n"
+    "WidgetEnd\n"
+    "Widget GoSend\n"
+    "    Press 90 30 7f\n"
+    "WidgetEnd\n"
+    "Widget GoButtons\n"
+    "    Press 90 31 7f\n"
+    "WidgetEnd\n"
+    "Widget ClearParam\n"
+    "    Press 90 32 7f\n"
+    "WidgetEnd\n"
+    "Widget Home\n"
+    "    Press 90 33 7f\n"
+    "WidgetEnd\n"
+    "Widget ToggleParam\n"
+    "    Press 90 34 7f\n"
+    "WidgetEnd\n";
+
+static void StartBroadcastSession(CSIHost &host)
+{
+    const char *names[] = { "A", "B", "C", "D" };
+    string ini;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        string folder = string("CSI/Surfaces/") + names[i];
+
+        // a surface is named after its Zones folder
+        host.WriteFile((folder + "/Surface.txt").c_str(), s_broadcastSurface);
+        host.WriteFile((folder + "/Zones/Home.zon").c_str(),
+            "Zone Home\n"
+            "    Play Reaper 40044\n"
+            "    GoSend GoZone SelectedTrackSend\n"
+            "    GoButtons GoZone Buttons\n"
+            "    ClearParam ClearFocusedFXParam\n"
+            "    Home GoHome\n"
+            "    ToggleParam ToggleEnableFocusedFXParamMapping\n"
+            "ZoneEnd\n");
+        host.WriteFile((folder + "/Zones/GoZones.zon").c_str(), "Zone GoZones\n    SelectedTrackSend\n    Buttons\nZoneEnd\n");
+        host.WriteFile((folder + "/Zones/SelectedTrackSend.zon").c_str(), "Zone SelectedTrackSend\n    Play Reaper 41001\nZoneEnd\n");
+        host.WriteFile((folder + "/Zones/Buttons.zon").c_str(), "Zone Buttons\n    Play Reaper 41002\nZoneEnd\n");
+        host.WriteFile((folder + "/Zones/FocusedFXParam.zon").c_str(), "Zone FocusedFXParam\n    Play Reaper 41003\nZoneEnd\n");
+        host.WriteFile((folder + "/FXZones/README.txt").c_str(), "");
+
+        char line[256];
+        snprintf(line, sizeof(line), "SurfaceType=MIDI SurfaceName=%s SurfaceChannelCount=2 MidiInput=%d MidiOutput=%d MIDISurfaceRefreshRate=15 MaxMIDIMesssagesPerRun=32\n", names[i], i, i);
+        ini += line;
+    }
+
+    ini += "\nPageName=Home PageFollowsMCP=No SynchPages=No ScrollLink=No ScrollSynch=No\n";
+
+    for (int i = 0; i < 4; ++i)
+        ini += string("    Surface=") + names[i] + " Zones=" + names[i] + " StartChannel=0\n";
+
+    ini +=
+        "Broadcaster=A\n"
+        "    Listener=B SelectedTrackSends=Yes FocusedFXParam=Yes\n"
+        "    Listener=C GoHome=Yes FocusedFX=Yes\n"
+        "Broadcaster=B\n"
+        "    Listener=D GoHome=Yes FocusedFXParam=Yes\n";
+
+    StartSession(host, ini);
+}
+
+// Command the Play button on port runs, -1 if none
+static int PlayCommand(CSIHost &host, int port)
+{
+    size_t commandCount = host.GetCommandsRun().size();
+
+    host.SendMidi(port, 0x90, 0x5e, 0x7f);
+    host.Tick();
+
+    return host.GetCommandsRun().size() == commandCount + 1 ? host.GetCommandsRun().back() : -1;
+}
+
+static void Press(CSIHost &host, int port, unsigned char note)
+{
+    host.SendMidi(port, 0x90, note, 0x7f);
+    host.Tick();
+}
+
+static void TestBroadcastGoZone(CSIHost &host)
+{
+    StartBroadcastSession(host);
+
+    for (int port = 0; port < 4; ++port)
+        CHECK(PlayCommand(host, port) == 40044);
+
+    // a categorised GoZone: C is outside Sends and switches itself, B is in it and relays to D instead
+    Press(host, 0, 0x30);
+
+    CHECK(PlayCommand(host, 0) == 40044);
+    CHECK(PlayCommand(host, 1) == 40044);
+    CHECK(PlayCommand(host, 2) == 41001);
+    CHECK(PlayCommand(host, 3) == 41001);
+
+    // an uncategorised GoZone reaches every Listener of A, and nothing further
+    Press(host, 0, 0x31);
+
+    CHECK(PlayCommand(host, 0) == 40044);
+    CHECK(PlayCommand(host, 1) == 41002);
+    CHECK(PlayCommand(host, 2) == 41002);
+    CHECK(PlayCommand(host, 3) == 41001);
+}
+
+static void TestBroadcastGoHome(CSIHost &host)
+{
+    StartBroadcastSession(host);
+
+    Press(host, 0, 0x31);
+    CHECK(PlayCommand(host, 1) == 41002);
+    CHECK(PlayCommand(host, 2) == 41002);
+
+    // only C listens to GoHome from A
+    Press(host, 0, 0x33);
+
+    CHECK(PlayCommand(host, 1) == 41002);
+    CHECK(PlayCommand(host, 2) == 40044);
+}
+
+static void TestBroadcastClearFXZone(CSIHost &host)
+{
+    StartBroadcastSession(host);
+
+    // A enables FocusedFXParam on B, B enables it on D
+    Press(host, 0, 0x34);
+    Press(host, 1, 0x34);
+
+    CHECK(PlayCommand(host, 1) == 41003);
+    CHECK(PlayCommand(host, 2) == 40044);
+    CHECK(PlayCommand(host, 3) == 41003);
+
+    // B is in the FocusedFXParam category, so it relays the clear to D and keeps its own Zone
+    Press(host, 0, 0x32);
+
+    CHECK(PlayCommand(host, 1) == 41003);
+    CHECK(PlayCommand(host, 3) == 40044);
+}
+
+#ifdef __linux__
+static void TestZoneEditAfterReset(CSIHost &host)
+{
+    StartMidiSession(host);
+    host.Reset(); // zone files stay watched across resets
+
+    host.WriteFile("CSI/Surfaces/Test/Zones/Track.zon", "Zone Track\n    Fader| TrackPan\n    Mute| TrackMute\nZoneEnd\n");
+    host.Tick();
+
+    host.SendMidi(s_midiPort, 0xe0, 0x00, 0x00);
+    host.Tick();
+
+    CHECK(host.GetTrack(0)->pan < -0.99);
+    CHECK(host.GetTrack(0)->volume == 1.0);
+}
+
+static void TestUnreferencedZoneEdit(CSIHost &host)
+{
+    StartMidiSession(host);
+
+    // nothing loads Spare, so Home and its Included Zones are not rebuilt for it, as they are for Track
+    host.WriteFile("CSI/Surfaces/Test/Zones/Spare.zon", "Zone Spare\n    Play Reaper 40046\nZoneEnd\n");
+    long long allocations = GetAllocationStats().allocations;
+    host.Tick();
+    long long spareAllocations = GetAllocationStats().allocations - allocations;
+
+    host.WriteFile("CSI/Surfaces/Test/Zones/Track.zon", s_trackZone);
+    allocations = GetAllocationStats().allocations;
+    host.Tick();
+    long long trackAllocations = GetAllocationStats().allocations - allocations;
+
+    CHECK(spareAllocations * 4 < trackAllocations);
+
+    // a zone Home names but could not find until now is picked up
+    host.WriteFile("CSI/Surfaces/Test/Zones/Home.zon", "Zone Home\n    IncludedZones\n        Track\n        Extra\n    IncludedZonesEnd\nZoneEnd\n");
+    host.Tick();
+    host.WriteFile("CSI/Surfaces/Test/Zones/Extra.zon", "Zone Extra\n    Play Reaper 40046\nZoneEnd\n");
+    host.Tick();
+
+    size_t commandsRun = host.GetCommandsRun().size();
+    host.SendMidi(s_midiPort, 0x90, 0x5e, 0x7f);
+    host.Tick();
+
+    CHECK(host.GetCommandsRun().size() == commandsRun + 1 && host.GetCommandsRun().back() == 40046);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Runner
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const struct { const char *name; void (*test)(CSIHost &); } s_tests[] =
+{
+    { "FaderSetsTrackVolume", TestFaderSetsTrackVolume },
+    { "VolumeFeedback", TestVolumeFeedback },
+    { "MutePressAndFeedback", TestMutePressAndFeedback },
+    { "EncoderIncrementsAccumulate", TestEncoderIncrementsAccumulate },
+    { "TouchedFXParamWritesThinned", TestTouchedFXParamWritesThinned },
+    { "ReaperAction", TestReaperAction },
+    { "InjectMidiMessage", TestInjectMidiMessage },
+    { "OSCLoopback", TestOSCLoopback },
+    { "ReplayTrafficFile", TestReplayTrafficFile },
+    { "FeedbackLatencyFromArrival", TestFeedbackLatencyFromArrival },
+    { "ReplayLongSysEx", TestReplayLongSysEx },
+    { "TrackListChange", TestTrackListChange },
+    { "TrackMeterReadOncePerTick", TestTrackMeterReadOncePerTick },
+    { "TrackMeterSoloGating", TestTrackMeterSoloGating },
+    { "FXParamValueFormattedOnChange", TestFXParamValueFormattedOnChange },
+    { "ToggleStateRefresh", TestToggleStateRefresh },
+    { "BroadcastGoZone", TestBroadcastGoZone },
+    { "BroadcastGoHome", TestBroadcastGoHome },
+    { "BroadcastClearFXZone", TestBroadcastClearFXZone },
+#ifdef __linux__
+    { "ZoneEditAfterReset", TestZoneEditAfterReset },
+    { "UnreferencedZoneEdit", TestUnreferencedZoneEdit },
+#endif
+};
+
+int main(int argc, char *argv[])
+{
+    const char *pluginPath = argc > 1 ? argv[1] : "./reaper_csurf_integrator.so";
+    const char *onlyTest = argc > 2 ? argv[2] : NULL;
+
+    char resourcePath[] = "/tmp/csi_test_XXXXXX";
+
+    if (mkdtemp(resourcePath) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    int result = 0;
+
+    {
+        CSIHost host;
+        host.AddMidiPort("Virtual Port");
+        host.AddMidiPort("Virtual Port 2");
+        host.AddMidiPort("Virtual Port 3");
+        host.AddMidiPort("Virtual Port 4");
+
+        if ( ! host.Load(pluginPath, resourcePath) || ! host.WriteFile("CSI/CSI.ini", "Version=7.0\n") || ! host.CreateSurface())
+        {
+            printf("%s", host.GetConsole().c_str());
+            return 1;
+        }
+
+        int testCount = 0;
+
+        for (int i = 0; i < (int)(sizeof(s_tests) / sizeof(s_tests[0])); ++i)
+        {
+            if (onlyTest && strcmp(onlyTest, s_tests[i].name))
+                continue;
+
+            int failures = s_failures;
+
+            s_tests[i].test(host);
+            testCount++;
+
+            printf("%-32s %s\n", s_tests[i].name, s_failures == failures ? "ok" : "FAILED");
+
+            if (s_failures != failures && ! host.GetConsole().empty())
+                printf("    console:\n%s\n", host.GetConsole().c_str());
+        }
+
+        printf("%d tests, %d failed checks\n", testCount, s_failures);
+        result = s_failures == 0 ? 0 : 1;
+    }
+
+    string cleanup = string("rm -rf ") + resourcePath;
+    if (system(cleanup.c_str()) != 0)
+        result = 1;
+
+    return result;
+}